@@ -0,0 +1,250 @@
+#pragma once
+
+#if !defined(__cpp_impl_coroutine)
+#error "async_io.h needs C++20 coroutines; configure with -DTCP_STACK_COROUTINES=ON and link tcp_stack_async"
+#endif
+
+#include "event_notifier.h"
+#include "event_poller.h"
+#include "local_tcp_socket.h"
+#include "tcp_socket.h"
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tcp_stack {
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr exception;
+    
+    // Lazy: the body runs when the task is awaited or spawned
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    
+    // Hand control straight back to whoever awaited us
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            auto continuation = handle.promise().continuation;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+    };
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    
+    void unhandled_exception() { exception = std::current_exception(); }
+    
+    void rethrow_if_failed() {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;
+    
+    Task<T> get_return_object();
+    
+    template <typename U>
+    void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+    
+    T take() {
+        rethrow_if_failed();
+        return std::move(*value);
+    }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object();
+    void return_void() {}
+    void take() { rethrow_if_failed(); }
+};
+
+} // namespace detail
+
+// A lazily started coroutine producing a T. co_await runs it and resumes
+// the awaiting coroutine with its result once it finishes.
+template <typename T>
+class Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+    
+    Task() = default;
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+    
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    
+    bool done() const { return !handle_ || handle_.done(); }
+    
+    bool await_ready() const noexcept { return done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+    T await_resume() { return handle_.promise().take(); }
+
+private:
+    friend class IoContext;
+    
+    std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+} // namespace detail
+
+// Single-threaded event loop for coroutines. Stack sockets are watched
+// through an EventPoller and kernel sockets (LocalTCPSocket) through
+// epoll; the poller's eventfd sits in the same epoll set, so one thread
+// sleeps on both. A coroutine waiting for readiness is parked with the
+// socket and resumed by run() once the stack or the kernel reports it,
+// so any number of connections share the thread that calls run().
+class IoContext {
+public:
+    IoContext();
+    ~IoContext();
+    
+    IoContext(const IoContext&) = delete;
+    IoContext& operator=(const IoContext&) = delete;
+    
+    // Take ownership of a task and start it on the next run()
+    void spawn(Task<void> task);
+    
+    // Resume coroutines until every spawned task has finished or stop()
+    // is called. An exception escaping a spawned task leaves through here.
+    void run();
+    
+    // One round: wait up to timeout (negative waits forever) for
+    // readiness, then resume whatever it unblocked. Returns true if any
+    // coroutine ran.
+    bool run_once(std::chrono::milliseconds timeout);
+    
+    // Make run() return; safe from any thread
+    void stop();
+    
+    size_t pending_tasks() const { return tasks_.size(); }
+    
+    // The context whose run() is on this thread's stack, if any
+    static IoContext* current();
+    
+    // Suspend until one of events (EventPoller flags) is ready on the
+    // socket; resumes with the events that fired. ERROR always wakes.
+    class SocketWait {
+    public:
+        SocketWait(IoContext& context, TCPSocket& socket, uint32_t events)
+            : context_(context), socket_(socket), events_(events) {}
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle);
+        uint32_t await_resume() const noexcept { return fired_; }
+    private:
+        IoContext& context_;
+        TCPSocket& socket_;
+        uint32_t events_;
+        uint32_t fired_ = 0;
+    };
+    
+    // The same for a kernel descriptor, with READABLE/WRITABLE/ERROR
+    // mapped onto epoll
+    class FdWait {
+    public:
+        FdWait(IoContext& context, int fd, uint32_t events)
+            : context_(context), fd_(fd), events_(events) {}
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle);
+        uint32_t await_resume() const noexcept { return fired_; }
+    private:
+        IoContext& context_;
+        int fd_;
+        uint32_t events_;
+        uint32_t fired_ = 0;
+    };
+    
+    SocketWait wait(TCPSocket& socket, uint32_t events) { return SocketWait(*this, socket, events); }
+    FdWait wait(int fd, uint32_t events) { return FdWait(*this, fd, events); }
+
+private:
+    struct Waiter {
+        std::coroutine_handle<> handle;
+        uint32_t events;
+        uint32_t* fired;
+    };
+    
+    static constexpr int MAX_EVENTS = 64;
+    
+    int epoll_fd_;
+    EventPoller poller_;
+    EventNotifier wakeup_;
+    std::atomic<bool> stopped_{false};
+    
+    std::deque<std::coroutine_handle<>> runnable_;
+    std::unordered_map<TCPSocket*, std::vector<Waiter>> socket_waiters_;
+    std::unordered_map<int, std::vector<Waiter>> fd_waiters_;
+    
+    // Last, so coroutine frames go before the tables that point into them
+    std::vector<Task<void>> tasks_;
+    
+    void park(TCPSocket& socket, const Waiter& waiter);
+    void park(int fd, const Waiter& waiter);
+    void dispatch(TCPSocket* socket, uint32_t events);
+    void dispatch(int fd, uint32_t events);
+    bool update_fd_interest(int fd, uint32_t events, bool registered);
+    void reap_finished();
+};
+
+// Socket operations as coroutines. They run on IoContext::current() and
+// put the socket into non-blocking mode; the socket must outlive the
+// await. Results follow the blocking calls they mirror, with 0 from
+// async_recv meaning the peer closed.
+Task<ssize_t> async_recv(TCPSocket& socket, void* buffer, size_t length);
+Task<ssize_t> async_send(TCPSocket& socket, const void* data, size_t length);
+Task<std::unique_ptr<TCPSocket>> async_accept(TCPSocket& listener);
+Task<bool> async_connect(TCPSocket& socket, const std::string& ip_address, uint16_t port);
+
+Task<ssize_t> async_recv(LocalTCPSocket& socket, void* buffer, size_t length);
+Task<ssize_t> async_send(LocalTCPSocket& socket, const void* data, size_t length);
+Task<std::unique_ptr<LocalTCPSocket>> async_accept(LocalTCPSocket& listener);
+Task<bool> async_connect(LocalTCPSocket& socket, const std::string& ip_address, uint16_t port);
+
+} // namespace tcp_stack
\ No newline at end of file
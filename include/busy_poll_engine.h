@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace tcp_stack {
+
+struct BusyPollConfig {
+    // Spin this long with nothing found before blocking; 0 never spins
+    std::chrono::microseconds spin_budget{50};
+    // Longest single block, so timers and TX queued by other threads are
+    // not left waiting
+    std::chrono::microseconds max_block{1000};
+    int cpu = -1;                   // Pin the engine thread; -1 leaves it to the scheduler
+    std::vector<int> cpus;          // Or confine it to these CPUs when cpu is -1
+    int numa_node = -1;             // Node the engine's own allocations come from
+};
+
+struct BusyPollStats {
+    uint64_t polls = 0;
+    uint64_t empty_polls = 0;       // Passes that found nothing to do
+    uint64_t blocks = 0;            // Times the spin budget ran out
+    std::chrono::microseconds spin_window{0}; // Current adaptive spin window
+    int cpu = -1;                   // Where the engine last ran (sampled when it blocks)
+    int numa_node = -1;
+};
+
+// A dedicated thread that busy-polls the stack (like SO_BUSY_POLL with
+// a NAPI thread): it calls poll back to back, trading a core for wakeup
+// latency. Hybrid polling keeps an idle engine from burning the core
+// forever: once the spin window passes without work it blocks, and the
+// window halves each time that happens (down to 1/16 of the budget).
+// Finding work restores the full budget.
+class BusyPollEngine {
+public:
+    // One pass over the stack's work; true if it found any
+    using PollFunction = std::function<bool()>;
+    // Sleep until there may be work, at most for the given time
+    using BlockFunction = std::function<void(std::chrono::microseconds)>;
+    
+    static constexpr unsigned MIN_SPIN_SHIFT = 4;
+    
+    BusyPollEngine(PollFunction poll, BlockFunction block);
+    ~BusyPollEngine();
+    
+    BusyPollEngine(const BusyPollEngine&) = delete;
+    BusyPollEngine& operator=(const BusyPollEngine&) = delete;
+    
+    // Start the engine thread; false if it is already running
+    bool start(const BusyPollConfig& config);
+    void stop();
+    bool is_running() const { return running_.load(std::memory_order_acquire); }
+    
+    BusyPollStats get_stats() const;
+    
+private:
+    PollFunction poll_;
+    BlockFunction block_;
+    BusyPollConfig config_;
+    std::thread thread_;
+    std::atomic<bool> running_;
+    
+    std::atomic<uint64_t> polls_;
+    std::atomic<uint64_t> empty_polls_;
+    std::atomic<uint64_t> blocks_;
+    std::atomic<int64_t> spin_window_us_;
+    std::atomic<int> cpu_;
+    std::atomic<int> numa_node_;
+    
+    void run();
+    void place();
+    void sample_location();
+};
+
+} // namespace tcp_stack
\ No newline at end of file
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "epoch_reclaimer.h"
+#include "numa_utils.h"
+#include "siphash.h"
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+namespace tcp_stack {
+
+struct TCPConnection;
+
+// Connections by 4-tuple for the packet path. Lookups take no lock: a
+// reader pins an epoch and walks the bucket's chain, whose links are
+// only ever published with release stores. Writers lock just their
+// bucket; a removed node stays intact for readers already on it and is
+// freed through the EpochReclaimer once none can be (RCU-style).
+class ConnectionTable {
+public:
+    static constexpr size_t DEFAULT_BUCKETS = 1024;
+    
+    // The bucket array can be placed on a NUMA node and on huge pages
+    explicit ConnectionTable(size_t buckets = DEFAULT_BUCKETS, int numa_node = -1,
+                             bool huge_pages = false);
+    ~ConnectionTable();
+    
+    ConnectionTable(const ConnectionTable&) = delete;
+    ConnectionTable& operator=(const ConnectionTable&) = delete;
+    
+    std::shared_ptr<TCPConnection> find(uint32_t local_ip, uint16_t local_port,
+                                        uint32_t remote_ip, uint16_t remote_port) const;
+    
+    // Add under the connection's 4-tuple; false if the tuple is taken
+    bool insert(const std::shared_ptr<TCPConnection>& conn);
+    bool remove(const std::shared_ptr<TCPConnection>& conn);
+    
+    // Call visit(conn) for every connection until it returns false.
+    // Lock-free like find(), so concurrent inserts and removals may or
+    // may not be seen.
+    template <typename Visitor>
+    void for_each(Visitor&& visit) const;
+    
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+    bool is_node_bound() const { return memory_.is_bound(); }
+    bool uses_huge_pages() const { return memory_.is_huge(); }
+    
+private:
+    struct Node {
+        uint32_t local_ip;
+        uint16_t local_port;
+        uint32_t remote_ip;
+        uint16_t remote_port;
+        std::shared_ptr<TCPConnection> conn;
+        std::atomic<Node*> next{nullptr};
+    };
+    
+    struct alignas(64) Bucket {
+        std::atomic<Node*> head{nullptr};
+        std::mutex mutex;       // Writers only
+    };
+    
+    size_t mask_;
+    NodeMemory memory_;
+    Bucket* buckets_;
+    SipHashKey key_;
+    std::atomic<size_t> size_;
+    
+    Bucket& bucket_for(uint32_t local_ip, uint16_t local_port,
+                       uint32_t remote_ip, uint16_t remote_port) const;
+};
+
+template <typename Visitor>
+void ConnectionTable::for_each(Visitor&& visit) const {
+    EpochGuard guard;
+    for (size_t i = 0; i <= mask_; ++i) {
+        for (Node* node = buckets_[i].head.load(std::memory_order_acquire); node;
+             node = node->next.load(std::memory_order_acquire)) {
+            if (!visit(node->conn)) {
+                return;
+            }
+        }
+    }
+}
+
+} // namespace tcp_stack
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+namespace tcp_stack {
+
+// DCTCP congestion estimate (RFC 8257). alpha is a moving average of the
+// fraction of bytes acknowledged with ECE, updated once per window of
+// data with gain g = 1/16. A congestion signal then shrinks cwnd by
+// alpha / 2 instead of halving it, so a lightly marked path backs off
+// only slightly.
+class DCTCP {
+public:
+    static constexpr uint32_t ALPHA_ONE = 1024;     // alpha fixed-point scale (1.0)
+    static constexpr uint32_t GAIN_SHIFT = 4;       // g = 1/16
+    
+    DCTCP();
+    
+    // Start a fresh observation window ending at snd_nxt; alpha starts at 1
+    void reset(uint32_t snd_nxt);
+    
+    // An ACK newly acknowledged acked_bytes, carrying ECE or not. When
+    // snd_una passes the window end, alpha absorbs the marked fraction.
+    void on_ack(uint32_t snd_una, uint32_t snd_nxt, uint32_t acked_bytes, bool ece);
+    
+    // cwnd * (1 - alpha / 2), at least two segments
+    uint32_t reduced_window(uint32_t cwnd, uint32_t mss) const;
+    
+    uint32_t get_alpha() const { return alpha_; }
+    
+private:
+    uint32_t alpha_;
+    uint32_t window_end_;
+    uint64_t acked_bytes_;
+    uint64_t marked_bytes_;
+};
+
+} // namespace tcp_stack
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace tcp_stack {
+
+// Epoch-based reclamation (Fraser) for the stack's lock-free lookup
+// structures. A reader pins the current epoch with an EpochGuard for as
+// long as it holds raw pointers into a structure; a writer that unlinks
+// a node hands it to retire() instead of deleting it. The global epoch
+// only advances once every pinned thread has seen it, so a node retired
+// in epoch e can no longer be reached by anyone once the epoch is e + 2,
+// and is freed then. Process-wide, like RCU: guards are cheap (a store
+// and a fence on a per-thread record) and nest.
+class EpochReclaimer {
+public:
+    static constexpr size_t RECLAIM_INTERVAL = 64;  // Retirements between reclaim attempts
+    
+    static EpochReclaimer& instance();
+    
+    // Free a node once no reader can still see it
+    void retire(std::function<void()> deleter);
+    
+    // Try to advance the epoch and run whatever deleters it made safe.
+    // Returns the number run.
+    size_t reclaim();
+    
+    uint64_t get_epoch() const { return global_epoch_.load(std::memory_order_acquire); }
+    size_t pending() const;
+    
+private:
+    friend class EpochGuard;
+    
+    // One per thread that has ever pinned, reused after the thread exits
+    struct ThreadRecord {
+        std::atomic<uint64_t> state{0};     // (epoch << 1) | 1 while pinned, else 0
+        std::atomic<bool> in_use{false};
+        uint32_t nesting = 0;               // Owner thread only
+        ThreadRecord* next = nullptr;       // Immutable once published
+    };
+    
+    struct Retired {
+        uint64_t epoch;
+        std::function<void()> deleter;
+    };
+    
+    std::atomic<uint64_t> global_epoch_{2};
+    std::atomic<ThreadRecord*> records_{nullptr};
+    
+    mutable std::mutex retired_mutex_;
+    std::vector<Retired> retired_;
+    size_t since_reclaim_ = 0;
+    
+    EpochReclaimer() = default;
+    
+    ThreadRecord* acquire_record();
+    static void release_record(ThreadRecord* record);
+    ThreadRecord* thread_record();
+    
+    void pin();
+    void unpin();
+};
+
+// Pins the current epoch for the guard's lifetime
+class EpochGuard {
+public:
+    EpochGuard() { EpochReclaimer::instance().pin(); }
+    ~EpochGuard() { EpochReclaimer::instance().unpin(); }
+    
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+};
+
+} // namespace tcp_stack
\ No newline at end of file
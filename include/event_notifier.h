@@ -0,0 +1,34 @@
+#pragma once
+
+#include <chrono>
+
+namespace tcp_stack {
+
+// A wakeup channel on an eventfd: notify() from any thread makes the fd
+// readable until a waiter consumes it. The fd can be watched by poll()
+// or epoll alongside other descriptors.
+class EventNotifier {
+public:
+    EventNotifier();
+    ~EventNotifier();
+    
+    EventNotifier(const EventNotifier&) = delete;
+    EventNotifier& operator=(const EventNotifier&) = delete;
+    
+    bool is_valid() const { return fd_ >= 0; }
+    int get_fd() const { return fd_; }
+    
+    void notify();
+    
+    // Block until notified or the timeout passes (negative waits forever).
+    // Returns true if a notification was consumed.
+    bool wait(std::chrono::milliseconds timeout);
+    
+    // Consume a pending notification without blocking
+    bool consume();
+    
+private:
+    int fd_;
+};
+
+} // namespace tcp_stack
\ No newline at end of file
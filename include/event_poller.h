@@ -0,0 +1,85 @@
+#pragma once
+
+#include "event_notifier.h"
+#include <cstdint>
+#include <memory>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <chrono>
+
+namespace tcp_stack {
+
+class TCPSocket;
+class EventPoller;
+
+// One socket's membership in one poller
+struct PollRegistration {
+    EventPoller* poller = nullptr;
+    TCPSocket* socket = nullptr;    // Null once removed
+    uint32_t interest = 0;
+    uint64_t data = 0;
+    bool queued = false;            // On the poller's ready list
+};
+
+// What wait() reports for a ready socket
+struct PollEvent {
+    uint32_t events;
+    uint64_t data;                  // As registered
+};
+
+// Readiness multiplexing over stack sockets, in the manner of epoll. The
+// stack pushes a registration onto the poller's ready list when one of
+// its events fires, so wait() only looks at sockets that became ready.
+// Level-triggered by default: a socket that is still ready stays on the
+// list; with EDGE_TRIGGERED it is reported once per event. The eventfd
+// from get_fd() is readable while the ready list is not empty, so a
+// poller can sit inside an application's own epoll loop.
+class EventPoller {
+public:
+    static constexpr uint32_t READABLE = 0x01;       // Data, or the peer closed
+    static constexpr uint32_t WRITABLE = 0x02;
+    static constexpr uint32_t ACCEPT = 0x04;         // Listener has a connection
+    static constexpr uint32_t ERROR = 0x08;          // Reset; always reported
+    static constexpr uint32_t EDGE_TRIGGERED = 0x80000000;
+    
+    EventPoller();
+    ~EventPoller();
+    
+    EventPoller(const EventPoller&) = delete;
+    EventPoller& operator=(const EventPoller&) = delete;
+    
+    // Register, change or drop a socket's interest. A socket is in a
+    // poller at most once.
+    bool add(TCPSocket& socket, uint32_t events, uint64_t data = 0);
+    bool modify(TCPSocket& socket, uint32_t events, uint64_t data = 0);
+    bool remove(TCPSocket& socket);
+    
+    // Fill up to max_events ready sockets, waiting up to timeout for the
+    // first (negative waits forever). Returns the number filled.
+    int wait(PollEvent* events, int max_events, std::chrono::milliseconds timeout);
+    
+    int get_fd() const { return notifier_.get_fd(); }
+    size_t size() const;
+    
+private:
+    friend class TCPSocket;
+    
+    mutable std::mutex mutex_;
+    std::unordered_map<TCPSocket*, std::shared_ptr<PollRegistration>> registrations_;
+    std::deque<std::shared_ptr<PollRegistration>> ready_;
+    EventNotifier notifier_;
+    
+    // Called by the socket (from the stack) when events fired
+    void on_events(const std::shared_ptr<PollRegistration>& registration, uint32_t events);
+    
+    // The socket is going away
+    void forget(const std::shared_ptr<PollRegistration>& registration);
+    
+    // The socket was moved to a new object
+    void rebind(const std::shared_ptr<PollRegistration>& registration, TCPSocket& socket);
+    
+    void enqueue(const std::shared_ptr<PollRegistration>& registration);
+};
+
+} // namespace tcp_stack
\ No newline at end of file
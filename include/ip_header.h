@@ -6,8 +6,16 @@
 namespace tcp_stack {
 
 // IP Protocol numbers
+constexpr uint8_t IPPROTO_ICMP = 1;
 constexpr uint8_t IPPROTO_TCP = 6;
 
+// ECN codepoints in the low two bits of the TOS byte (RFC 3168 section 5)
+constexpr uint8_t ECN_NOT_ECT = 0;
+constexpr uint8_t ECN_ECT1 = 1;
+constexpr uint8_t ECN_ECT0 = 2;
+constexpr uint8_t ECN_CE = 3;
+constexpr uint8_t ECN_MASK = 3;
+
 // IP Header structure (RFC 791)
 struct __attribute__((packed)) IPHeader {
     uint8_t version_ihl;      // Version (4 bits) + IHL (4 bits)
@@ -25,6 +33,11 @@ struct __attribute__((packed)) IPHeader {
     uint8_t get_version() const { return (version_ihl >> 4) & 0xF; }
     uint8_t get_ihl() const { return version_ihl & 0xF; }
     uint8_t get_header_length() const { return get_ihl() * 4; }
+    uint8_t get_ecn() const { return tos & ECN_MASK; }
+    
+    void set_ecn(uint8_t codepoint) {
+        tos = (tos & ~ECN_MASK) | (codepoint & ECN_MASK);
+    }
     
     void set_version(uint8_t version) {
         version_ihl = (version_ihl & 0x0F) | ((version & 0x0F) << 4);
@@ -44,4 +57,19 @@ struct __attribute__((packed)) IPHeader {
 
 static_assert(sizeof(IPHeader) == 20, "IP header must be 20 bytes");
 
+// ICMP Destination Unreachable header (RFC 792, next-hop MTU per RFC 1191).
+// Followed by the offending IP header and the first 8 bytes of its payload.
+struct __attribute__((packed)) ICMPHeader {
+    uint8_t type;
+    uint8_t code;
+    uint16_t checksum;
+    uint16_t unused;
+    uint16_t next_hop_mtu;
+    
+    static constexpr uint8_t TYPE_DEST_UNREACHABLE = 3;
+    static constexpr uint8_t CODE_FRAG_NEEDED = 4;
+};
+
+static_assert(sizeof(ICMPHeader) == 8, "ICMP header must be 8 bytes");
+
 } // namespace tcp_stack
\ No newline at end of file
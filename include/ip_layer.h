@@ -5,6 +5,8 @@
 #include <vector>
 #include <cstdint>
 #include <memory>
+#include <atomic>
+#include <chrono>
 
 namespace tcp_stack {
 
@@ -18,7 +20,8 @@ public:
     
     // Create an IP packet with the given payload
     std::vector<uint8_t> create_packet(uint32_t src_ip, uint32_t dst_ip, 
-                                      uint8_t protocol, const std::vector<uint8_t>& payload);
+                                      uint8_t protocol, const std::vector<uint8_t>& payload,
+                                      uint8_t tos = 0);
     
     // Parse an IP packet and extract payload
     bool parse_packet(const std::vector<uint8_t>& packet, IPHeader& ip_header, 
@@ -26,11 +29,29 @@ public:
     
     // Send an IP packet
     bool send_packet(uint32_t src_ip, uint32_t dst_ip, uint8_t protocol, 
-                    const std::vector<uint8_t>& payload);
+                    const std::vector<uint8_t>& payload, uint8_t tos = 0);
+    
+    // Send a burst of packets to one destination with batched syscalls.
+    // Each buffer starts with sizeof(IPHeader) bytes of headroom followed
+    // by the payload. Returns the number of packets sent.
+    size_t send_batch(uint32_t src_ip, uint32_t dst_ip, uint8_t protocol,
+                      std::vector<std::vector<uint8_t>>& packets, uint8_t tos = 0);
+    
+    // Fill in the IP headers of a burst from one template; the checksum of
+    // the invariant fields is computed once
+    void prepare_batch(uint32_t src_ip, uint32_t dst_ip, uint8_t protocol,
+                       std::vector<std::vector<uint8_t>>& packets, uint8_t tos = 0);
     
     // Receive an IP packet (non-blocking)
     bool receive_packet(IPHeader& ip_header, std::vector<uint8_t>& payload);
     
+    // Receive an ICMP message (non-blocking), e.g. fragmentation needed
+    bool receive_icmp(IPHeader& ip_header, std::vector<uint8_t>& payload);
+    
+    // Block until a TCP or ICMP packet can be received or the timeout
+    // passes; returns true if one can
+    bool wait_for_packets(std::chrono::microseconds timeout);
+    
     // Validate IP header checksum
     bool validate_checksum(const IPHeader& header);
     
@@ -39,11 +60,12 @@ public:
     
 private:
     std::unique_ptr<RawSocket> raw_socket_;
-    uint16_t packet_id_;
+    std::unique_ptr<RawSocket> icmp_socket_;
+    std::atomic<uint16_t> packet_id_;
     
     // Create IP header
     IPHeader create_ip_header(uint32_t src_ip, uint32_t dst_ip, 
-                             uint8_t protocol, uint16_t payload_length);
+                             uint8_t protocol, uint16_t payload_length, uint8_t tos = 0);
 };
 
 } // namespace tcp_stack
\ No newline at end of file
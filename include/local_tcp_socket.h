@@ -27,6 +27,12 @@ public:
     std::unique_ptr<LocalTCPSocket> accept();
     bool connect(const std::string& ip_address, uint16_t port);
     
+    // Non-blocking connect: true once the connection is made or under
+    // way; when the socket turns writable, finish_connect() reports how
+    // it went
+    bool start_connect(const std::string& ip_address, uint16_t port);
+    bool finish_connect();
+    
     // Data transfer
     ssize_t send(const void* data, size_t length);
     ssize_t recv(void* buffer, size_t length);
@@ -34,6 +40,7 @@ public:
     // Socket management
     bool close();
     bool is_connected() const;
+    int get_fd() const { return socket_fd_; }
     
     // Socket options
     bool set_blocking(bool blocking);
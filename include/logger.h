@@ -0,0 +1,220 @@
+#pragma once
+
+#include "spsc_byte_ring.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Records below this level are compiled out: 0 TRACE, 1 DEBUG, 2 INFO,
+// 3 WARN, 4 ERROR, 5 OFF. CMake sets it from TCP_STACK_LOG_LEVEL.
+#ifndef TCP_STACK_LOG_LEVEL
+#define TCP_STACK_LOG_LEVEL 2
+#endif
+
+namespace tcp_stack {
+
+// Prefixed: DEBUG and ERROR are commonly defined as macros (Debug builds
+// here pass -DDEBUG)
+enum class LogLevel : uint8_t {
+    LEVEL_TRACE,    // Per segment: ACKs, RTT samples
+    LEVEL_DEBUG,    // Per connection: state transitions, path MTU, bad checksums
+    LEVEL_INFO,     // Per socket: bind, listen, accept, connect
+    LEVEL_WARN,     // A call failed because of how it was made
+    LEVEL_ERROR,    // A system call failed
+    LEVEL_OFF
+};
+
+inline constexpr LogLevel COMPILED_LOG_LEVEL = static_cast<LogLevel>(TCP_STACK_LOG_LEVEL);
+
+struct LoggerStats {
+    uint64_t records_written = 0;
+    uint64_t records_dropped = 0;   // Thread's ring was full
+    size_t thread_buffers = 0;
+};
+
+namespace detail {
+
+// Encodes one record into the binary form the rings carry: a fixed
+// header, then (name, tag, value) for each field. The message and field
+// names are kept as pointers, so they must be string literals; string
+// values are copied, up to MAX_STRING bytes.
+class LogRecordWriter {
+public:
+    static constexpr size_t MAX_SIZE = 512;
+    static constexpr size_t MAX_STRING = 256;
+    
+    enum Tag : uint8_t { BOOL, INT, UINT, DOUBLE, STRING };
+    
+    struct Header {
+        uint16_t size;          // Whole record, header included
+        LogLevel level;
+        uint8_t field_count;
+        uint64_t timestamp_ns;  // system_clock
+        const char* message;
+    };
+    
+    LogRecordWriter(LogLevel level, const char* message);
+    
+    template <typename T>
+    void add(const char* name, const T& value) {
+        if constexpr (std::is_same_v<T, bool>) {
+            put_number(name, BOOL, static_cast<uint64_t>(value));
+        } else if constexpr (std::is_enum_v<T>) {
+            add(name, static_cast<std::underlying_type_t<T>>(value));
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            put_number(name, INT, static_cast<uint64_t>(static_cast<int64_t>(value)));
+        } else if constexpr (std::is_integral_v<T>) {
+            put_number(name, UINT, static_cast<uint64_t>(value));
+        } else if constexpr (std::is_floating_point_v<T>) {
+            put_double(name, static_cast<double>(value));
+        } else if constexpr (std::is_pointer_v<T>) {
+            put_string(name, value ? std::string_view(value) : std::string_view("(null)"));
+        } else {
+            put_string(name, std::string_view(value));
+        }
+    }
+    
+    // Finishes the header; the record is data()[0, size())
+    const uint8_t* data();
+    size_t size() const { return size_; }
+    
+private:
+    alignas(8) uint8_t data_[MAX_SIZE];
+    size_t size_;
+    uint8_t field_count_ = 0;
+    
+    bool begin_field(const char* name, Tag tag, size_t payload);
+    void put_number(const char* name, Tag tag, uint64_t value);
+    void put_double(const char* name, double value);
+    void put_string(const char* name, std::string_view value);
+};
+
+} // namespace detail
+
+// Asynchronous structured logging. A logging thread encodes its record
+// into a binary form and appends it to its own lock-free ring (one
+// SPSCByteRing per thread, created on the thread's first record); it
+// never formats, locks or writes. A background thread drains the rings
+// every FLUSH_INTERVAL, merges the records by timestamp, formats them as
+//
+//     2026-10-18T12:46:13.123456Z WARN  [2] Bind failed error="..."
+//
+// and hands the text to the sink (stderr by default) in one write. If a
+// ring is full the record is dropped and counted, so a burst of logging
+// slows nobody down.
+//
+// Two gates keep disabled records free: levels below TCP_STACK_LOG_LEVEL
+// are compiled out, and the rest are checked against the runtime level
+// (WARN by default) before any argument is evaluated.
+class Logger {
+public:
+    using Sink = std::function<void(std::string_view text)>;
+    
+    static constexpr size_t RING_BYTES = 64 * 1024;
+    static constexpr std::chrono::milliseconds FLUSH_INTERVAL{10};
+    
+    static Logger& instance();
+    
+    static bool enabled(LogLevel level) {
+        return level >= level_.load(std::memory_order_relaxed) && level != LogLevel::LEVEL_OFF;
+    }
+    static void set_level(LogLevel level) { level_.store(level, std::memory_order_relaxed); }
+    static LogLevel get_level() { return level_.load(std::memory_order_relaxed); }
+    
+    // Fields are name, value pairs; names must be string literals
+    template <typename... Fields>
+    static void log(LogLevel level, const char* message, const Fields&... fields) {
+        static_assert(sizeof...(Fields) % 2 == 0, "log fields come in name, value pairs");
+        detail::LogRecordWriter record(level, message);
+        add_fields(record, fields...);
+        instance().commit(record);
+    }
+    
+    // Where formatted text goes; nullptr restores stderr. Called on the
+    // background thread (or the one calling flush()).
+    void set_sink(Sink sink);
+    
+    // Write out everything logged so far, on the calling thread
+    void flush();
+    
+    // Stop the background thread after a final flush; records logged
+    // later stay in their rings. Runs at exit.
+    void shutdown();
+    
+    LoggerStats get_stats() const;
+    
+    static std::string_view level_name(LogLevel level);
+    
+private:
+    struct ThreadBuffer {
+        explicit ThreadBuffer(uint32_t thread_id) : ring(RING_BYTES), id(thread_id) {}
+        
+        SPSCByteRing ring;
+        uint32_t id;
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<bool> retired{false};     // Owner thread has exited
+    };
+    
+    inline static std::atomic<LogLevel> level_{LogLevel::LEVEL_WARN};
+    
+    // Registration only; the rings themselves are lock-free
+    mutable std::mutex buffers_mutex_;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+    uint32_t next_thread_id_ = 1;
+    
+    // One drainer at a time: the background thread or flush()
+    mutable std::mutex drain_mutex_;
+    Sink sink_;
+    std::vector<uint8_t> scratch_;
+    std::string text_;
+    uint64_t records_written_ = 0;
+    uint64_t records_dropped_ = 0;
+    
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    std::thread thread_;
+    
+    Logger();
+    
+    template <typename T, typename... Rest>
+    static void add_fields(detail::LogRecordWriter& record, const char* name, const T& value,
+                           const Rest&... rest) {
+        record.add(name, value);
+        add_fields(record, rest...);
+    }
+    static void add_fields(detail::LogRecordWriter&) {}
+    
+    void commit(detail::LogRecordWriter& record);
+    ThreadBuffer* thread_buffer();
+    void run();
+    void drain();
+    void format(const uint8_t* record, uint32_t thread_id);
+};
+
+} // namespace tcp_stack
+
+#define TCP_LOG(level, ...)                                                             \
+    do {                                                                                \
+        if constexpr ((level) >= ::tcp_stack::COMPILED_LOG_LEVEL) {                     \
+            if (::tcp_stack::Logger::enabled(level)) {                                  \
+                ::tcp_stack::Logger::log(level, __VA_ARGS__);                           \
+            }                                                                           \
+        }                                                                               \
+    } while (0)
+
+#define TCP_LOG_TRACE(...) TCP_LOG(::tcp_stack::LogLevel::LEVEL_TRACE, __VA_ARGS__)
+#define TCP_LOG_DEBUG(...) TCP_LOG(::tcp_stack::LogLevel::LEVEL_DEBUG, __VA_ARGS__)
+#define TCP_LOG_INFO(...) TCP_LOG(::tcp_stack::LogLevel::LEVEL_INFO, __VA_ARGS__)
+#define TCP_LOG_WARN(...) TCP_LOG(::tcp_stack::LogLevel::LEVEL_WARN, __VA_ARGS__)
+#define TCP_LOG_ERROR(...) TCP_LOG(::tcp_stack::LogLevel::LEVEL_ERROR, __VA_ARGS__)
\ No newline at end of file
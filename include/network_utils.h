@@ -16,17 +16,27 @@ public:
     // Calculate checksum with multiple data segments
     static uint16_t calculate_checksum(const std::vector<std::pair<const void*, size_t>>& segments);
     
+    // Unfolded partial sums, so a fixed header's sum can be computed once
+    // and extended per packet. Only the last piece may have odd length.
+    static uint32_t checksum_accumulate(const void* data, size_t length, uint32_t sum = 0);
+    static uint16_t checksum_finish(uint32_t sum);
+    
     // Convert IP address from string to network byte order
     static uint32_t ip_string_to_network(const std::string& ip_str);
     
     // Convert IP address from network byte order to string
     static std::string ip_network_to_string(uint32_t ip_addr);
     
-    // Generate random sequence number
-    static uint32_t generate_sequence_number();
+    // Initial sequence number for a connection (RFC 6528): a 4us clock
+    // plus a keyed hash of the 4-tuple, so each connection's numbers are
+    // unpredictable yet keep increasing across incarnations. Lock-free
+    // and reentrant.
+    static uint32_t generate_sequence_number(uint32_t local_ip, uint16_t local_port,
+                                             uint32_t remote_ip, uint16_t remote_port);
     
-private:
-    static uint32_t checksum_accumulate(const void* data, size_t length, uint32_t sum = 0);
+    // MTU of the interface that owns a local address (network byte order),
+    // or 0 if it cannot be determined
+    static uint32_t get_interface_mtu(uint32_t local_ip);
 };
 
 } // namespace tcp_stack
\ No newline at end of file
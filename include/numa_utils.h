@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <pthread.h>
+
+namespace tcp_stack {
+
+// Where a stack's threads run and its memory lives
+struct PlacementConfig {
+    int numa_node = -1;             // Memory (and by default threads) on this node; -1 leaves both to the OS
+    std::vector<int> cpus;          // Pin stack threads here; empty means the node's CPUs
+    bool huge_pages = false;        // Back the connection table with 2 MB pages when the host has them
+};
+
+struct PlacementStats {
+    int numa_node = -1;
+    std::vector<int> cpus;          // CPU set stack threads are pinned to
+    bool table_on_node = false;     // Connection table memory bound to numa_node
+    bool table_huge_pages = false;
+    size_t pool_buffers = 0;        // Packet buffers pre-faulted on numa_node
+    uint64_t threads_placed = 0;    // Stack threads that took the placement
+    uint64_t placement_failures = 0;
+};
+
+// NUMA topology and placement straight from sysfs and the kernel's
+// memory policy calls, so the stack does not depend on libnuma. On a
+// host without NUMA every call fails softly (false, -1 or empty).
+class NumaUtils {
+public:
+    // Online nodes, 0 if the kernel does not report any
+    static int node_count();
+    
+    // CPUs belonging to a node
+    static std::vector<int> node_cpus(int node);
+    
+    // Node a CPU belongs to, or -1
+    static int cpu_node(int cpu);
+    
+    // Where the calling thread runs right now
+    static bool current_location(int& cpu, int& node);
+    
+    // Restrict a thread to a set of CPUs
+    static bool pin_thread(pthread_t thread, const std::vector<int>& cpus);
+    
+    // Take the calling thread's new pages from node (MPOL_PREFERRED);
+    // -1 goes back to the default local policy
+    static bool prefer_node(int node);
+    
+    // The calling thread's memory policy, as get_mempolicy() reports it
+    struct MemoryPolicy {
+        int mode = 0;
+        unsigned long nodes[16] = {};
+    };
+    static bool save_policy(MemoryPolicy& policy);
+    static bool restore_policy(const MemoryPolicy& policy);
+    
+    // Bind an existing mapping's pages to node (MPOL_BIND)
+    static bool bind_memory(void* address, size_t length, int node);
+};
+
+// Anonymous memory placed on one NUMA node, optionally on explicit 2 MB
+// pages (falling back to normal pages with a transparent huge page hint
+// when none are reserved). Zero-filled; the pages are faulted in on the
+// node up front rather than wherever the first writer happens to run.
+class NodeMemory {
+public:
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+    
+    NodeMemory(size_t bytes, int node, bool huge_pages);
+    ~NodeMemory();
+    
+    NodeMemory(const NodeMemory&) = delete;
+    NodeMemory& operator=(const NodeMemory&) = delete;
+    
+    void* data() const { return data_; }
+    size_t size() const { return length_; }
+    bool is_bound() const { return bound_; }
+    bool is_huge() const { return huge_; }
+    
+private:
+    void* data_;
+    size_t length_;
+    bool bound_;
+    bool huge_;
+};
+
+// Prefer a node for the calling thread's allocations within a scope
+class ScopedNodePreference {
+public:
+    explicit ScopedNodePreference(int node)
+        : active_(node >= 0 && NumaUtils::save_policy(saved_) && NumaUtils::prefer_node(node)) {}
+    ~ScopedNodePreference() {
+        // Put back whatever the caller had (numactl --membind and the like),
+        // not the default policy
+        if (active_) {
+            NumaUtils::restore_policy(saved_);
+        }
+    }
+    
+    ScopedNodePreference(const ScopedNodePreference&) = delete;
+    ScopedNodePreference& operator=(const ScopedNodePreference&) = delete;
+    
+private:
+    NumaUtils::MemoryPolicy saved_;
+    bool active_;
+};
+
+} // namespace tcp_stack
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <memory>
+#include <chrono>
+
+namespace tcp_stack {
+
+struct TCPConnection;
+
+// Stack-wide timing wheel for paced transmission (like Carousel's
+// timing wheel). Connections that have data but must wait for their next
+// send time are parked in the slot for that time and handed back once it
+// has passed. Times past the horizon land in the last slot and fire early;
+// the owner just checks and reschedules.
+class PacingScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+    
+    static constexpr std::chrono::microseconds SLOT_WIDTH{10};
+    static constexpr size_t NUM_SLOTS = 4096;   // ~41ms horizon
+    
+    explicit PacingScheduler(Clock::time_point origin = Clock::now());
+    
+    // Park a connection until when; a time already past fires on the next advance
+    void schedule(const std::shared_ptr<TCPConnection>& conn, Clock::time_point when);
+    
+    // Connections whose time has come, in time order
+    std::vector<std::shared_ptr<TCPConnection>> advance(Clock::time_point now);
+    
+    // Earliest parked time (rounded up to a slot), or time_point::max()
+    Clock::time_point next_deadline() const;
+    
+    size_t size() const { return scheduled_; }
+    bool empty() const { return scheduled_ == 0; }
+    
+private:
+    std::vector<std::vector<std::weak_ptr<TCPConnection>>> slots_;
+    Clock::time_point origin_;
+    uint64_t current_tick_;     // Next slot to fire, as an absolute tick
+    size_t scheduled_;
+    
+    uint64_t tick_of(Clock::time_point time, bool round_up) const;
+};
+
+} // namespace tcp_stack
\ No newline at end of file
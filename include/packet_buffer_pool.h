@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace tcp_stack {
+
+// Free list of packet buffers. Buffers keep their capacity when recycled,
+// so once warmed up the send path stops allocating per packet.
+class PacketBufferPool {
+public:
+    static constexpr size_t DEFAULT_MAX_CACHED = 64;
+    
+    explicit PacketBufferPool(size_t max_cached = DEFAULT_MAX_CACHED);
+    
+    // A buffer of exactly size bytes (contents unspecified)
+    std::vector<uint8_t> acquire(size_t size);
+    
+    // Cache up to count buffers of size bytes now, touching them so their
+    // pages are placed by the calling thread's memory policy
+    void reserve(size_t count, size_t size);
+    
+    // Return buffers for reuse; the vector of buffers is left empty
+    void release(std::vector<uint8_t>&& buffer);
+    void release(std::vector<std::vector<uint8_t>>& buffers);
+    
+    size_t cached() const { return free_.size(); }
+    
+private:
+    std::vector<std::vector<uint8_t>> free_;
+    size_t max_cached_;
+};
+
+} // namespace tcp_stack
\ No newline at end of file
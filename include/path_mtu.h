@@ -0,0 +1,67 @@
+#pragma once
+
+#include "tcp_sequence.h"
+#include <cstdint>
+#include <chrono>
+
+namespace tcp_stack {
+
+// Path MTU state for one connection. ICMP "fragmentation needed" lowers
+// it directly (RFC 1191). When a path silently drops large packets (a
+// black hole), the MTU falls back to a safe base and packetization-layer
+// probes (RFC 4821) binary-search back up to the largest size that works.
+class PathMTU {
+public:
+    static constexpr uint32_t IP_TCP_HEADER_SIZE = 40;  // IPv4 + TCP, no options
+    static constexpr uint32_t MIN_MTU = 552;            // Floor for ICMP-reported MTUs
+    static constexpr uint32_t BASE_MTU = 1200;          // Black-hole fallback (RFC 8899)
+    static constexpr uint32_t DEFAULT_LINK_MTU = 1500;
+    static constexpr uint32_t PROBE_GRANULARITY = 32;   // Stop searching within this
+    static constexpr std::chrono::seconds REPROBE_INTERVAL{600};
+    static constexpr uint8_t BLACK_HOLE_RETRANSMITS = 2; // Before falling back
+    
+    PathMTU();
+    
+    // Start from the outgoing interface MTU
+    void reset(uint32_t link_mtu, bool probing_allowed);
+    
+    uint32_t get_mtu() const { return mtu_; }
+    uint32_t get_mss() const { return mtu_ - IP_TCP_HEADER_SIZE; }
+    uint32_t get_search_high() const { return search_high_; }
+    bool is_probing() const { return probing_; }
+    
+    // ICMP "fragmentation needed". A zero next-hop MTU (pre-RFC 1191
+    // router) is estimated from the size of the packet that bounced.
+    // Returns true if the path MTU went down.
+    bool on_packet_too_big(uint32_t next_hop_mtu, uint32_t packet_size);
+    
+    // Full-sized segments keep timing out: assume a black hole
+    bool on_black_hole();
+    
+    // PLPMTUD probing
+    bool should_probe(std::chrono::steady_clock::time_point now);
+    uint32_t next_probe_size() const;
+    void on_probe_sent(uint32_t seq, uint32_t end_seq, uint32_t probe_mtu);
+    bool is_probe(uint32_t seq) const { return probe_mtu_ != 0 && seq == probe_seq_; }
+    
+    // A cumulative ACK covering the probe confirms its size.
+    // Returns true if the path MTU went up.
+    bool on_ack(uint32_t ack_num);
+    void on_probe_lost();
+    
+private:
+    uint32_t link_mtu_;
+    uint32_t mtu_;              // Largest size known to get through
+    uint32_t search_high_;      // Largest size that may still get through
+    bool probing_allowed_;
+    bool probing_;
+    
+    uint32_t probe_mtu_;        // Size of the probe in flight, 0 if none
+    uint32_t probe_seq_;
+    uint32_t probe_end_seq_;
+    std::chrono::steady_clock::time_point next_probe_time_;
+    
+    void finish_search_if_converged();
+};
+
+} // namespace tcp_stack
\ No newline at end of file
@@ -4,12 +4,13 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <netinet/in.h>
 
 namespace tcp_stack {
 
 class RawSocket {
 public:
-    RawSocket();
+    explicit RawSocket(int protocol = ::IPPROTO_TCP);
     ~RawSocket();
     
     // Non-copyable but movable
@@ -27,6 +28,10 @@ public:
     // Send raw IP packet
     bool send_packet(const std::vector<uint8_t>& packet, uint32_t dst_ip);
     
+    // Send several packets to one destination in as few syscalls as
+    // possible (sendmmsg); returns how many were sent
+    size_t send_packets(const std::vector<std::vector<uint8_t>>& packets, uint32_t dst_ip);
+    
     // Receive raw IP packet
     bool receive_packet(std::vector<uint8_t>& packet, uint32_t& src_ip);
     
@@ -41,6 +46,7 @@ public:
     
 private:
     int socket_fd_;
+    int protocol_;
     bool initialized_;
     
     // Platform-specific initialization
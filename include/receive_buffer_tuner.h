@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+
+namespace tcp_stack {
+
+// Receive buffer autotuning in the style of Linux dynamic right-sizing
+// (tcp_rcv_space_adjust). Once per receiver-side RTT it compares how much
+// the application read with the previous round; when reads grow, the
+// buffer is raised to about twice that drain rate (plus headroom) so the
+// sender is never held back by our window. Connections that read little
+// keep their initial buffer.
+class ReceiveBufferTuner {
+public:
+    using Clock = std::chrono::steady_clock;
+    
+    static constexpr uint32_t INITIAL_BUFFER = 65535;
+    static constexpr uint32_t MIN_BUFFER = 4096;
+    static constexpr uint32_t INITIAL_SPACE_SEGMENTS = 10;  // First round's expectation, as initial cwnd
+    static constexpr uint32_t HEADROOM_SEGMENTS = 16;
+    
+    ReceiveBufferTuner();
+    
+    void reset(uint32_t initial_buffer, uint32_t max_buffer, uint16_t mss, Clock::time_point now);
+    
+    // Lower or raise the cap; a buffer above it is clamped
+    void set_max_buffer(uint32_t max_buffer);
+    
+    // In-order data moved rcv_nxt while rcv_wnd bytes were offered. Times
+    // how long a window of data takes to arrive (receiver RTT estimate).
+    void on_data_received(uint32_t rcv_nxt, uint32_t rcv_wnd, Clock::time_point now);
+    
+    // The application read bytes. Returns true if the buffer grew; growth
+    // is suppressed when allow_growth is false (memory pressure).
+    bool on_data_consumed(size_t bytes, Clock::time_point now, bool allow_growth = true);
+    
+    // Memory pressure: give back whatever lies above keep bytes
+    void shrink(uint32_t keep);
+    
+    uint32_t get_buffer() const { return buffer_; }
+    uint32_t get_max_buffer() const { return max_buffer_; }
+    uint32_t get_space() const { return space_; }
+    std::chrono::microseconds get_rtt() const { return rtt_; }
+    
+private:
+    uint32_t buffer_;
+    uint32_t max_buffer_;
+    uint16_t mss_;
+    
+    // Drain measurement: bytes read in the last measured round, and the
+    // read total and time at the start of the current one
+    uint32_t space_;
+    uint64_t copied_;
+    uint64_t space_copied_;
+    Clock::time_point space_time_;
+    
+    // Receiver RTT: the time for rcv_nxt to reach rtt_seq_
+    std::chrono::microseconds rtt_;
+    uint32_t rtt_seq_;
+    Clock::time_point rtt_time_;
+    bool rtt_started_;
+};
+
+} // namespace tcp_stack
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "tcp_options.h"
+#include "tcp_sequence.h"
+#include <cstdint>
+#include <map>
+
+namespace tcp_stack {
+
+// Sender-side record of SACKed sequence ranges (RFC 6675 section 3).
+// Ranges are kept merged and sorted in a balanced tree keyed by start, so
+// lookups and updates cost O(log n) in the number of distinct SACKed
+// ranges rather than O(segments) in the window.
+class SackScoreboard {
+public:
+    SackScoreboard();
+    
+    // Record [start, end) as received by the peer
+    void add(uint32_t start, uint32_t end);
+    
+    // Forget everything below the cumulative ACK point
+    void remove_below(uint32_t ack_num);
+    
+    void clear();
+    
+    // True if every byte of [start, end) has been SACKed
+    bool is_sacked(uint32_t start, uint32_t end) const;
+    
+    // Bytes and distinct ranges SACKed strictly above seq
+    uint32_t sacked_bytes_above(uint32_t seq) const;
+    size_t ranges_above(uint32_t seq) const;
+    
+    // Highest SACKed sequence number (exclusive end); only valid if !empty()
+    uint32_t highest_sacked() const;
+    
+    bool empty() const { return ranges_.empty(); }
+    size_t range_count() const { return ranges_.size(); }
+    uint32_t sacked_bytes() const { return sacked_bytes_; }
+    
+private:
+    std::map<uint32_t, uint32_t, SeqLess> ranges_;  // start -> end (exclusive)
+    uint32_t sacked_bytes_;
+};
+
+} // namespace tcp_stack
\ No newline at end of file
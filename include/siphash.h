@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace tcp_stack {
+
+// 128-bit SipHash key
+struct SipHashKey {
+    uint64_t k0 = 0;
+    uint64_t k1 = 0;
+    
+    // A key drawn from std::random_device
+    static SipHashKey random();
+};
+
+// SipHash-2-4 (Aumasson and Bernstein): a keyed 64-bit hash that is a
+// secure MAC for short inputs such as addresses and ports
+uint64_t siphash24(const SipHashKey& key, const void* data, size_t length);
+
+// SipHash-2-4 of a connection's 4-tuple, as ISNs (RFC 6528) and the
+// connection table key it
+uint64_t siphash24_tuple(const SipHashKey& key, uint32_t local_ip, uint16_t local_port,
+                         uint32_t remote_ip, uint16_t remote_port);
+
+} // namespace tcp_stack
\ No newline at end of file
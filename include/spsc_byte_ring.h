@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+
+namespace tcp_stack {
+
+// Lock-free single-producer / single-consumer byte ring. The capacity is
+// a power of two so positions wrap with a mask; head and tail count bytes
+// forever and sit on separate cache lines. write() may only be called
+// from one thread and read() from one (other) thread.
+class SPSCByteRing {
+public:
+    static constexpr size_t CACHE_LINE = 64;
+    
+    // Capacity is rounded up to a power of two
+    explicit SPSCByteRing(size_t capacity);
+    
+    SPSCByteRing(const SPSCByteRing&) = delete;
+    SPSCByteRing& operator=(const SPSCByteRing&) = delete;
+    
+    // Producer: copy in up to length bytes; returns how many fit
+    size_t write(const uint8_t* data, size_t length);
+    
+    // Consumer: copy out up to length bytes; returns how many were read
+    size_t read(uint8_t* buffer, size_t length);
+    
+    // Approximate unless called by the producer (free_space) or the
+    // consumer (size)
+    size_t size() const;
+    size_t free_space() const { return capacity_ - size(); }
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return capacity_; }
+    
+private:
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<uint8_t[]> buffer_;
+    
+    alignas(CACHE_LINE) std::atomic<uint64_t> head_;   // Next byte to read
+    alignas(CACHE_LINE) std::atomic<uint64_t> tail_;   // Next byte to write
+};
+
+} // namespace tcp_stack
\ No newline at end of file
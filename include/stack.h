@@ -0,0 +1,58 @@
+#pragma once
+
+#include "tcp_connection_manager.h"
+#include "busy_poll_engine.h"
+#include "numa_utils.h"
+#include <memory>
+
+namespace tcp_stack {
+
+struct StackStats {
+    size_t connections = 0;
+    BusyPollStats busy_poll;
+    PlacementStats placement;
+};
+
+// One independent TCP/IP stack: the connection manager with its link
+// (IPLayer), schedulers, timers and busy-poll engine. Sockets are opened
+// on a Stack and share its connection table, so separate Stacks can run
+// side by side, e.g. one per NUMA node or per tenant, each listening on
+// the same ports without seeing the other's connections.
+//
+// A placement pins the stack's threads (socket timers and the busy-poll
+// engine) to a set of CPUs and takes its connection table, packet pool
+// and thread allocations from one NUMA node, so packets are not carried
+// across the interconnect between the core handling them and the memory
+// holding them.
+class Stack {
+public:
+    explicit Stack(const PlacementConfig& placement = PlacementConfig());
+    ~Stack();
+    
+    Stack(const Stack&) = delete;
+    Stack& operator=(const Stack&) = delete;
+    
+    // The stack TCPSocket() opens on, created on first use
+    static Stack& default_stack();
+    
+    // False if the link could not be opened (no raw socket access); the
+    // stack still works on segments handed to it directly
+    bool is_initialized() const { return initialized_; }
+    
+    // Sockets keep the manager alive past the Stack if they outlive it
+    std::shared_ptr<TCPConnectionManager> get_connection_manager() const { return manager_; }
+    
+    // Busy polling for this stack only (see BusyPollEngine)
+    bool enable_busy_poll(const BusyPollConfig& config = BusyPollConfig());
+    void disable_busy_poll();
+    bool is_busy_polling() const;
+    BusyPollStats get_busy_poll_stats() const;
+    
+    StackStats get_stats() const;
+    
+private:
+    std::shared_ptr<TCPConnectionManager> manager_;
+    bool initialized_;
+};
+
+} // namespace tcp_stack
\ No newline at end of file
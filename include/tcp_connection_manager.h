@@ -2,15 +2,64 @@
 
 #include "tcp_header.h"
 #include "tcp_state_machine.h"
+#include "tcp_reliability.h"
+#include "tcp_options.h"
+#include "tcp_reassembly.h"
+#include "path_mtu.h"
+#include "packet_buffer_pool.h"
+#include "tcp_receive_coalescer.h"
+#include "pacing_scheduler.h"
+#include "transmit_scheduler.h"
+#include "receive_buffer_tuner.h"
+#include "tcp_fastopen.h"
+#include "event_poller.h"
+#include "busy_poll_engine.h"
+#include "connection_table.h"
+#include "numa_utils.h"
 #include "ip_layer.h"
 #include "network_utils.h"
 #include <cstdint>
 #include <vector>
 #include <memory>
 #include <chrono>
+#include <functional>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
 
 namespace tcp_stack {
 
+// Per-connection settings applied or offered at SYN time
+struct TCPConnectionConfig {
+    bool sack_permitted = true;     // Offer / accept SACK (RFC 2018)
+    uint16_t mss = 0;               // MSS clamp; 0 derives it from the interface MTU
+    bool mtu_probing = true;        // PLPMTUD once a black hole is suspected (RFC 4821)
+    bool window_scaling = true;     // Offer window scaling (RFC 7323)
+    uint32_t max_receive_buffer = 0; // Autotuning cap; 0 uses the stack-wide cap
+    
+    // Delayed ACK (RFC 1122 section 4.2.3.2, RFC 5681 section 4.2)
+    bool delayed_ack = true;
+    std::chrono::microseconds delayed_ack_timeout{40000};
+    bool quick_ack = false;         // Always ACK immediately (interactive flows)
+    
+    bool nodelay = false;           // Disable Nagle (like TCP_NODELAY)
+    uint64_t max_pacing_rate = 0;   // Pacing cap in bytes/s; 0 is no cap (like SO_MAX_PACING_RATE)
+    
+    // Transmit scheduling: strict priority class (0 is served first) and
+    // DRR weight within it; picked up whenever the connection's queue is idle
+    uint8_t tx_priority = 0;
+    uint32_t tx_weight = 1;
+    
+    bool ecn = false;               // Negotiate ECN on the SYN (RFC 3168)
+    
+    // TCP Fast Open (RFC 7413): a client sends data in the SYN (or asks
+    // for a cookie); a listener accepts it, with at most
+    // fastopen_max_pending such connections still in SYN_RECEIVED
+    bool fastopen = false;
+    uint32_t fastopen_max_pending = 16;
+};
+
 struct TCPConnection {
     uint32_t local_ip;
     uint16_t local_port;
@@ -20,78 +69,420 @@ struct TCPConnection {
     uint32_t local_seq;     // Our sequence number
     uint32_t remote_seq;    // Remote sequence number
     uint32_t local_ack;     // Our acknowledgment number
-    uint16_t window_size;   // Our receive window size
+    uint32_t window_size;   // Receive window last advertised, in bytes
+    uint16_t peer_window = 0;   // Window in the peer's last acceptable ACK
     
     TCPStateMachine state_machine;
+    std::shared_ptr<TCPReliability> reliability; // Attached by the owning TCPSocket
     std::chrono::steady_clock::time_point last_activity;
     
+    TCPConnectionConfig config;
+    bool sack_enabled = false;      // Both ends sent SACK-permitted
+    
+    // Window scaling (RFC 7323): shifts applied to the windows we send and
+    // receive, fixed at SYN time and 0 unless both ends offered the option
+    bool wscale_enabled = false;
+    uint8_t rcv_wscale = 0;
+    uint8_t snd_wscale = 0;
+    uint32_t rcv_wnd_edge = 0;      // Right edge of the window last advertised
+    
+    // Receive buffer autotuning; rcv_queued is delivered data the
+    // application has not read yet, which the window leaves room for
+    ReceiveBufferTuner rcv_tuner;
+    uint32_t rcv_queued = 0;
+    
+    // Segment sizing: what we advertised, what the peer advertised (RFC 9293
+    // default if it sent no MSS option) and what the path carries
+    static constexpr uint16_t DEFAULT_PEER_MSS = 536;
+    uint16_t local_mss = DEFAULT_PEER_MSS;
+    uint16_t peer_mss = DEFAULT_PEER_MSS;
+    PathMTU path_mtu;
+    
+    uint16_t effective_mss() const {
+        return static_cast<uint16_t>(std::min<uint32_t>({peer_mss, local_mss, path_mtu.get_mss()}));
+    }
+    
+    // Receive path: out-of-order segments, and in-order data handed to the
+    // owning socket (or held until one attaches)
+    TCPReassemblyQueue reassembly;
+    std::function<void(const std::vector<uint8_t>&)> data_handler;
+    std::vector<uint8_t> pending_data;
+    
+    // Readiness changes (EventPoller flags) for the owning socket: the
+    // handshake completing, the peer's FIN or RST, and on a listener a
+    // connection ready to accept
+    std::function<void(uint32_t)> event_handler;
+    
+    // Delayed ACK state. Any outgoing segment carrying ACK clears it.
+    static constexpr uint8_t QUICK_ACK_SEGMENTS = 16;
+    uint32_t ack_pending_bytes = 0;     // Received since our last ACK
+    uint16_t rcv_mss = 536;             // Largest segment seen from the peer
+    uint8_t quick_acks_remaining = QUICK_ACK_SEGMENTS; // Peer is in slow start
+    std::chrono::steady_clock::time_point ack_deadline =
+        std::chrono::steady_clock::time_point::max();
+    
+    // Corked: partial segments wait for more data, at most CORK_TIMEOUT
+    static constexpr std::chrono::milliseconds CORK_TIMEOUT{200};
+    bool corked = false;
+    std::chrono::steady_clock::time_point cork_deadline =
+        std::chrono::steady_clock::time_point::max();
+    
+    // Pacing: bursts are spaced at pacing_rate bytes/s, taken from
+    // cc_pacing_rate when congestion control sets one and otherwise from
+    // cwnd/srtt; 0 until there is an RTT sample and no cap applies
+    uint64_t pacing_rate = 0;
+    uint64_t cc_pacing_rate = 0;
+    std::chrono::steady_clock::time_point next_send_time{};
+    bool pacing_scheduled = false;  // Parked in the pacing scheduler
+    bool pacing_push = false;       // Push the tail when the scheduler releases us
+    
+    // Data packets waiting in the stack's transmit scheduler
+    std::shared_ptr<TransmitFlow> tx_flow;
+    
+    // ECN (RFC 3168): negotiated on the SYN; ece_pending is the ECE we
+    // echo on outgoing ACKs until the peer's CWR (or, for DCTCP, the CE
+    // state of the last data segment received)
+    bool ecn_enabled = false;
+    bool ece_pending = false;
+    
+    // TCP Fast Open. Client: the cookie offered on the SYN (empty asks for
+    // one) and data held for the handshake, of which the first
+    // fastopen_syn_bytes went in the SYN. Server: a cookie to issue on the
+    // SYN-ACK, and whether the SYN's data was accepted.
+    std::vector<uint8_t> fastopen_cookie;
+    std::vector<uint8_t> fastopen_data;
+    size_t fastopen_syn_bytes = 0;
+    bool fastopen_accepted = false;
+    
+    // A passive child's listener; set before the child is published and
+    // never changed
+    std::weak_ptr<TCPConnection> listener;
+    
+    // A listener counts its accepted Fast Open children still in
+    // SYN_RECEIVED; each child holds a slot from its SYN until the
+    // handshake completes or it is removed
+    std::atomic<size_t> fastopen_pending{0};
+    std::atomic<bool> fastopen_slot{false};
+    
+    // A listener's children ready for accept(), oldest first, under the
+    // listener's mutex; accept_pending mirrors the size for pollers, which
+    // must not take that mutex
+    std::deque<std::shared_ptr<TCPConnection>> accept_queue;
+    std::atomic<size_t> accept_pending{0};
+    bool in_accept_queue = false;       // Child, under its listener's mutex
+    
+    std::atomic<bool> accepted{false};  // Handed out by accept_connection()
+    
+    // Serializes everything that touches this connection's state: segment
+    // processing, sends, timers and the owning socket. Recursive because
+    // processing a segment can send, and sending can process timers.
+    std::recursive_mutex mutex;
+    
+    // Segments handled by header prediction (statistics)
+    uint64_t fast_path_segments = 0;
+    
     bool operator==(const TCPConnection& other) const {
         return local_ip == other.local_ip && local_port == other.local_port &&
                remote_ip == other.remote_ip && remote_port == other.remote_port;
     }
 };
 
+// The stack's connection state, shared by every socket and thread.
+// Connection lookups are lock-free (ConnectionTable); each connection is
+// serialized by its own mutex; the stack-wide schedulers, the packet pool
+// and the receive path have their own locks, always taken after a
+// connection's and never held while taking one.
 class TCPConnectionManager {
 public:
-    TCPConnectionManager();
+    explicit TCPConnectionManager(const PlacementConfig& placement = PlacementConfig());
     ~TCPConnectionManager() = default;
     
+    // Largest burst segmented and sent in one pass (like GSO's 64KB limit)
+    static constexpr size_t GSO_MAX_BYTES = 65536;
+    
+    // Packets taken from the IP layer per receive burst (like a NAPI budget)
+    static constexpr size_t RX_BURST_SIZE = 64;
+    
+    // Pacing gain over cwnd/srtt in percent (as Linux: ahead of the window
+    // in slow start, just above it in congestion avoidance), and the burst
+    // time a paced connection may send at once (1ms, like TSO autosizing)
+    static constexpr uint32_t PACING_SS_RATIO = 200;
+    static constexpr uint32_t PACING_CA_RATIO = 120;
+    static constexpr std::chrono::microseconds PACING_BURST_TIME{1000};
+    
+    // Data packets handed to the link per transmit scheduler run
+    static constexpr size_t TX_BUDGET = 64;
+    
+    // Receive buffers: the stack-wide autotuning cap (like tcp_rmem[2]) and
+    // the total they may take before they stop growing and start shrinking
+    static constexpr uint32_t DEFAULT_MAX_RECEIVE_BUFFER = 6 * 1024 * 1024;
+    static constexpr size_t DEFAULT_RECEIVE_MEMORY_LIMIT = 256 * 1024 * 1024;
+    
+    // Packet buffers pre-faulted on a placed stack's node, each with room
+    // for a full-sized segment
+    static constexpr size_t POOL_PREFILL_SIZE = 2048;
+    
     // Initialize the connection manager
     bool initialize();
     
     // Server-side operations
-    bool listen(uint32_t local_ip, uint16_t local_port);
-    std::shared_ptr<TCPConnection> accept_connection();
+    bool listen(uint32_t local_ip, uint16_t local_port,
+               const TCPConnectionConfig& config = TCPConnectionConfig());
+    // A connection ready for accept() (established, or holding Fast Open
+    // data), on the given listener or any; each is handed out once
+    std::shared_ptr<TCPConnection> accept_connection(std::shared_ptr<TCPConnection> listener = nullptr);
+    bool has_pending_accept(std::shared_ptr<TCPConnection> listener) const;
+    std::shared_ptr<TCPConnection> find_listener(uint32_t local_ip, uint16_t local_port) const;
     
-    // Client-side operations
+    // Client-side operations. data is the first request: with Fast Open
+    // and a cached cookie as much of it as fits goes in the SYN, and the
+    // rest (or all of it) is sent once the handshake completes.
     std::shared_ptr<TCPConnection> connect(uint32_t local_ip, uint16_t local_port,
-                                          uint32_t remote_ip, uint16_t remote_port);
+                                          uint32_t remote_ip, uint16_t remote_port,
+                                          const TCPConnectionConfig& config = TCPConnectionConfig(),
+                                          const std::vector<uint8_t>& data = {});
+    
+    // Fast Open cookies: issue new ones under a fresh key (old ones stay
+    // valid for one rotation), and the client's cache of cookies by server
+    void rotate_fastopen_key() { fastopen_cookies_.rotate_key(); }
+    FastOpenCookieCache& get_fastopen_cache() { return fastopen_cache_; }
     
     // Send TCP segment
     bool send_segment(std::shared_ptr<TCPConnection> conn, const std::vector<uint8_t>& data,
                      uint8_t flags = 0);
     
+    // Send data queued in the connection's TCPReliability as full-sized
+    // segments. A trailing partial segment is held back while corked, when
+    // more is set, or by Nagle (RFC 896) while earlier data is unacked;
+    // push sends it regardless. Full segments go out in GSO-style bursts,
+    // spaced by the pacing rate; a paced connection that has to wait is
+    // parked in the pacing scheduler. Bursts are queued in the transmit
+    // scheduler, which is then run once. Returns the number of bytes
+    // taken off the queue (a packet the IP layer drops is left to
+    // retransmission, like a loss).
+    size_t flush_send_queue(std::shared_ptr<TCPConnection> conn, bool more = false,
+                            bool push = false);
+    
+    // Resend a tracked segment at its original sequence number
+    bool retransmit_segment(std::shared_ptr<TCPConnection> conn, const TCPSegment& segment);
+    
+    // Drain everything the IP layer has queued (TCP segments and ICMP);
+    // returns the number of packets taken
+    size_t poll();
+    
+    // Busy-poll mode: an engine thread takes over receiving, pacing and
+    // the transmit scheduler from the sockets' ticks, spinning on them
+    // for low latency and blocking on the link once its spin budget runs
+    // out. Per-connection timers stay with the sockets.
+    bool start_busy_poll(const BusyPollConfig& config);
+    void stop_busy_poll() { busy_poll_->stop(); }
+    bool is_busy_polling() const { return busy_poll_->is_running(); }
+    BusyPollStats get_busy_poll_stats() const { return busy_poll_->get_stats(); }
+    
+    // CPU and NUMA placement: threads working for the stack call this as
+    // they start, to be pinned to its CPUs and take memory from its node.
+    // False if the host refused either.
+    bool place_current_thread();
+    PlacementStats get_placement_stats() const;
+    
     // Process incoming TCP segment
     bool process_incoming_segment(const IPHeader& ip_header, const std::vector<uint8_t>& tcp_data);
     
+    // Process a receive burst, coalescing in-order segments of each flow
+    // first (GRO). Returns the number of segments after coalescing.
+    size_t process_incoming_batch(const std::vector<std::pair<IPHeader, std::vector<uint8_t>>>& packets);
+    
+    // Process an ICMP message; acts on "fragmentation needed" for our connections
+    bool process_icmp_message(const IPHeader& ip_header, const std::vector<uint8_t>& icmp_data);
+    
+    // Payload size for the next data segment: the current MSS, or a larger
+    // PLPMTUD probe when one is due and enough data is queued to fill it
+    size_t next_segment_size(std::shared_ptr<TCPConnection> conn, size_t queued_bytes);
+    
     // Close connection
     bool close_connection(std::shared_ptr<TCPConnection> conn);
     
+    // The application read bytes of delivered data. Frees window, feeds
+    // receive autotuning, and sends a window update once the window has
+    // opened up substantially.
+    void on_data_consumed(std::shared_ptr<TCPConnection> conn, size_t bytes);
+    
+    // Receive buffer caps, stack-wide and per connection (0 falls back to
+    // the stack-wide cap). The window scale is fixed at SYN time, so a
+    // larger cap later is limited to what it can express.
+    void set_max_receive_buffer(uint32_t bytes);
+    void set_max_receive_buffer(std::shared_ptr<TCPConnection> conn, uint32_t bytes);
+    void set_receive_memory_limit(size_t bytes) { receive_memory_limit_ = bytes; }
+    size_t get_receive_memory() const { return receive_memory_; }
+    bool under_memory_pressure() const { return receive_memory_ > receive_memory_limit_; }
+    
+    // Fire connection timers that are due (delayed ACK, cork)
+    void process_timers(std::shared_ptr<TCPConnection> conn);
+    
+    // Send for every connection whose pacing time has come, and the time
+    // the next one is due
+    void process_pacing();
+    std::chrono::steady_clock::time_point next_pacing_deadline() const;
+    
+    // Recompute a connection's pacing rate from its congestion state
+    void update_pacing_rate(std::shared_ptr<TCPConnection> conn);
+    
+    // Hand queued data packets to the link, by priority class and DRR
+    // within a class. Returns the number of packets handed over.
+    size_t run_transmit(size_t max_packets = TX_BUDGET);
+    size_t get_transmit_backlog() const;
+    
+    size_t get_connection_count() const { return connections_.size(); }
+    
     // Get connection by 4-tuple
     std::shared_ptr<TCPConnection> find_connection(uint32_t local_ip, uint16_t local_port,
                                                   uint32_t remote_ip, uint16_t remote_port);
     
 private:
+    PlacementConfig placement_;     // With the CPU set resolved from the node
     std::unique_ptr<IPLayer> ip_layer_;
-    std::vector<std::shared_ptr<TCPConnection>> connections_;
-    std::vector<std::shared_ptr<TCPConnection>> listening_sockets_;
+    ConnectionTable connections_;
+    ConnectionTable listeners_;     // Keyed by local address, remote 0:0
+    
+    std::mutex rx_mutex_;           // One thread drains the link at a time
+    std::mutex coalescer_mutex_;
+    TCPReceiveCoalescer rx_coalescer_;
+    mutable std::mutex pacing_mutex_;
+    PacingScheduler pacing_scheduler_;
+    mutable std::mutex tx_mutex_;   // Transmit scheduler, its flows and the packet pool
+    PacketBufferPool packet_pool_;
+    TransmitScheduler tx_scheduler_;
+    FastOpenCookieGenerator fastopen_cookies_;
+    FastOpenCookieCache fastopen_cache_;
+    
+    std::atomic<uint32_t> max_receive_buffer_{DEFAULT_MAX_RECEIVE_BUFFER};
+    size_t receive_memory_limit_ = DEFAULT_RECEIVE_MEMORY_LIMIT;
+    std::atomic<size_t> receive_memory_{0};  // Sum of all connections' receive buffers
+    
+    size_t pool_prefilled_ = 0;
+    std::atomic<uint64_t> threads_placed_{0};
+    std::atomic<uint64_t> placement_failures_{0};
+    
+    // Build and hand a segment to the IP layer without touching local_seq
+    // (ect marks new data ECN-capable; retransmits and control segments are not)
+    bool transmit_segment(std::shared_ptr<TCPConnection> conn, uint32_t seq,
+                         const std::vector<uint8_t>& data, uint8_t flags, bool ect = false);
+    
+    // Segment a burst from one header template into pooled buffers and
+    // queue it on the connection's transmit flow
+    void transmit_burst(std::shared_ptr<TCPConnection> conn,
+                        const std::vector<std::shared_ptr<TCPSegment>>& segments, bool push);
     
     // Create TCP header for a connection
-    TCPHeader create_tcp_header(std::shared_ptr<TCPConnection> conn, 
+    TCPHeader create_tcp_header(std::shared_ptr<TCPConnection> conn, uint32_t seq,
+                               const std::vector<uint8_t>& options,
                                const std::vector<uint8_t>& data, uint8_t flags);
     
+    // Options carried by an outgoing segment with the given flags
+    TCPOptions build_options(std::shared_ptr<TCPConnection> conn, uint8_t flags);
+    
+    // Effective MSS less the option bytes a data segment currently carries
+    size_t current_mss(std::shared_ptr<TCPConnection> conn);
+    
+    // Size the MSS we advertise from the outgoing interface
+    void init_path_mtu(std::shared_ptr<TCPConnection> conn);
+    
+    // Push a changed effective MSS into congestion control
+    void update_mss(std::shared_ptr<TCPConnection> conn);
+    
+    // Size the initial receive buffer and pick the window scale we offer
+    void init_receive_window(std::shared_ptr<TCPConnection> conn);
+    
+    // Window field for an outgoing segment: free buffer space, scaled,
+    // never retracting the edge already offered (RFC 7323 section 2.4)
+    uint16_t select_window(std::shared_ptr<TCPConnection> conn, bool syn);
+    
+    // Shrink the receive buffer while memory is short
+    void apply_memory_pressure(std::shared_ptr<TCPConnection> conn);
+    
+    // Parse and checksum a wire segment
+    bool parse_segment(const IPHeader& ip_header, const std::vector<uint8_t>& tcp_data,
+                       ReceivedSegment& segment);
+    
+    // TCP processing of a validated (possibly coalesced) segment
+    void process_segment(const ReceivedSegment& segment);
+    
     // Calculate TCP checksum
     uint16_t calculate_tcp_checksum(uint32_t src_ip, uint32_t dst_ip,
-                                   const TCPHeader& header, const std::vector<uint8_t>& data);
+                                   const TCPHeader& header, const std::vector<uint8_t>& options,
+                                   const std::vector<uint8_t>& data);
     
     // Handle different TCP segments
-    void handle_syn_segment(const IPHeader& ip_header, const TCPHeader& tcp_header);
-    void handle_syn_ack_segment(const IPHeader& ip_header, const TCPHeader& tcp_header);
-    void handle_ack_segment(const IPHeader& ip_header, const TCPHeader& tcp_header);
-    void handle_fin_segment(const IPHeader& ip_header, const TCPHeader& tcp_header);
-    void handle_rst_segment(const IPHeader& ip_header, const TCPHeader& tcp_header);
-    void handle_data_segment(const IPHeader& ip_header, const TCPHeader& tcp_header,
-                           const std::vector<uint8_t>& data);
+    void handle_syn_segment(const IPHeader& ip_header, const TCPHeader& tcp_header,
+                          const TCPOptions& options, const std::vector<uint8_t>& data);
+    void handle_syn_ack_segment(std::shared_ptr<TCPConnection> conn, const TCPHeader& tcp_header,
+                              const TCPOptions& options);
+    void handle_ack_segment(std::shared_ptr<TCPConnection> conn, const TCPHeader& tcp_header,
+                          size_t payload_length, const TCPOptions& options);
+    void handle_fin_segment(std::shared_ptr<TCPConnection> conn, const TCPHeader& tcp_header,
+                          size_t payload_length);
+    void handle_rst_segment(std::shared_ptr<TCPConnection> conn);
+    void handle_data_segment(std::shared_ptr<TCPConnection> conn, const ReceivedSegment& segment);
+    
+    // Track the CE marks of an incoming segment for the ECE echo
+    void process_ecn(std::shared_ptr<TCPConnection> conn, const ReceivedSegment& segment);
+    
+    // Header prediction (Van Jacobson): an ESTABLISHED segment that is a
+    // plain ACK or in-order data with nothing unusual about it skips the
+    // generic handling. Returns false if the segment needs the slow path.
+    bool try_fast_path(std::shared_ptr<TCPConnection> conn, const ReceivedSegment& segment);
+    
+    // Settle the Fast Open exchange on our SYN's SYN-ACK: cache a new
+    // cookie and queue whatever SYN data the server did not take
+    void complete_fastopen(std::shared_ptr<TCPConnection> conn, const TCPHeader& tcp_header,
+                           const TCPOptions& options);
+    
+    // Feed an ACK to reliability and send whatever it releases
+    void process_ack(std::shared_ptr<TCPConnection> conn, const TCPHeader& tcp_header,
+                     size_t payload_length, const std::vector<SackBlock>& sack_blocks);
+    
+    // Accept in-order data at local_ack and schedule its ACK
+    void receive_in_order(std::shared_ptr<TCPConnection> conn, const ReceivedSegment& segment,
+                          size_t offset);
+    
+    // Acknowledge received data now or arm the delayed-ACK timer
+    void schedule_ack(std::shared_ptr<TCPConnection> conn, size_t segment_length, bool immediate,
+                      uint16_t segment_count = 1);
+    
+    // Hand in-order bytes to the owning socket
+    void deliver_data(std::shared_ptr<TCPConnection> conn, std::vector<uint8_t> data);
     
     // Send specific TCP segments
     bool send_syn(std::shared_ptr<TCPConnection> conn);
-    bool send_syn_ack(std::shared_ptr<TCPConnection> conn);
+    bool send_syn_ack(std::shared_ptr<TCPConnection> conn, bool retransmit = false);
     bool send_ack(std::shared_ptr<TCPConnection> conn);
     bool send_fin(std::shared_ptr<TCPConnection> conn);
     bool send_rst(std::shared_ptr<TCPConnection> conn);
     
+    // Tell the owning socket (and for a new connection, its listener) of
+    // a readiness change
+    void notify_event(std::shared_ptr<TCPConnection> conn, uint32_t events);
+    void notify_acceptable(std::shared_ptr<TCPConnection> conn);
+    
     // Remove connection from list
     void remove_connection(std::shared_ptr<TCPConnection> conn);
+    
+    // Give back the child's pending Fast Open slot on its listener, once
+    void release_fastopen_slot(std::shared_ptr<TCPConnection> conn);
+    
+    // A child joins its listener's accept queue once ready, and leaves it
+    // when accepted or removed
+    void queue_acceptable(std::shared_ptr<TCPConnection> conn);
+    std::shared_ptr<TCPConnection> dequeue_acceptable(std::shared_ptr<TCPConnection> listener);
+    void drop_acceptable(std::shared_ptr<TCPConnection> conn);
+    
+    // The busy-poll engine's pass over the stack, and its block on the
+    // link (cut short by the next pacing deadline)
+    bool busy_poll_pass();
+    void busy_poll_block(std::chrono::microseconds timeout);
+    
+    // Last, so the engine thread stops before anything it uses goes
+    std::unique_ptr<BusyPollEngine> busy_poll_;
 };
 
 } // namespace tcp_stack
\ No newline at end of file
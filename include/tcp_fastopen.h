@@ -0,0 +1,70 @@
+#pragma once
+
+#include "siphash.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace tcp_stack {
+
+// TCP Fast Open (RFC 7413), server side. A cookie is a MAC of the client
+// address under a secret key, so a client can only present one it was
+// issued from that address. Cookies made under the previous key stay
+// valid after a rotation.
+class FastOpenCookieGenerator {
+public:
+    static constexpr size_t COOKIE_LENGTH = 8;
+    static constexpr size_t MIN_COOKIE_LENGTH = 4;  // RFC 7413 section 4.1.1
+    static constexpr size_t MAX_COOKIE_LENGTH = 16;
+    
+    FastOpenCookieGenerator();
+    
+    std::vector<uint8_t> generate(uint32_t client_ip) const;
+    bool validate(uint32_t client_ip, const std::vector<uint8_t>& cookie) const;
+    
+    // Start issuing cookies under a fresh key
+    void rotate_key();
+    
+private:
+    mutable std::mutex mutex_;      // Keys; rotation races with the packet path
+    SipHashKey key_;
+    SipHashKey previous_key_;
+    bool has_previous_key_;
+    
+    static std::vector<uint8_t> make_cookie(const SipHashKey& key, uint32_t client_ip);
+};
+
+// Client-side cookie cache keyed by server address, least recently used
+// entries evicted first. The server's MSS is kept with the cookie to size
+// the data sent in the next SYN.
+class FastOpenCookieCache {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+    
+    struct Entry {
+        std::vector<uint8_t> cookie;
+        uint16_t mss = 0;
+    };
+    
+    explicit FastOpenCookieCache(size_t capacity = DEFAULT_CAPACITY);
+    
+    // Returns false if there is no cookie for the server
+    bool lookup(uint32_t server_ip, Entry& entry);
+    void store(uint32_t server_ip, const std::vector<uint8_t>& cookie, uint16_t mss);
+    void remove(uint32_t server_ip);
+    
+    size_t size() const;
+    
+private:
+    using LRUList = std::list<uint32_t>;
+    
+    mutable std::mutex mutex_;
+    size_t capacity_;
+    LRUList lru_;   // Most recently used first
+    std::unordered_map<uint32_t, std::pair<Entry, LRUList::iterator>> entries_;
+};
+
+} // namespace tcp_stack
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace tcp_stack {
+
+// One SACK block: [start, end) in sequence space (RFC 2018)
+struct SackBlock {
+    uint32_t start;
+    uint32_t end;
+    
+    bool operator==(const SackBlock& other) const {
+        return start == other.start && end == other.end;
+    }
+};
+
+// Parsed / to-be-emitted TCP options
+struct TCPOptions {
+    // Option kinds (IANA "TCP Option Kind Numbers")
+    static constexpr uint8_t KIND_EOL = 0;
+    static constexpr uint8_t KIND_NOP = 1;
+    static constexpr uint8_t KIND_MSS = 2;
+    static constexpr uint8_t KIND_WINDOW_SCALE = 3;
+    static constexpr uint8_t KIND_SACK_PERMITTED = 4;
+    static constexpr uint8_t KIND_SACK = 5;
+    static constexpr uint8_t KIND_FASTOPEN = 34;  // RFC 7413
+    
+    static constexpr size_t MAX_LENGTH = 40;      // 60-byte header minus fixed part
+    static constexpr size_t MAX_SACK_BLOCKS = 4;  // Fits in 40 bytes without timestamps
+    static constexpr uint8_t MAX_WINDOW_SCALE = 14; // RFC 7323 section 2.3
+    
+    uint16_t mss = 0;               // 0 if absent (SYN only)
+    bool sack_permitted = false;
+    bool has_window_scale = false;  // SYN only; the shift may legitimately be 0
+    uint8_t window_scale = 0;
+    std::vector<SackBlock> sack_blocks;
+    bool has_fastopen = false;      // SYN only; an empty cookie is a cookie request
+    std::vector<uint8_t> fastopen_cookie;
+    
+    bool empty() const {
+        return mss == 0 && !sack_permitted && !has_window_scale && sack_blocks.empty() &&
+               !has_fastopen;
+    }
+    
+    // Parse the options area that follows the fixed TCP header.
+    // Returns false if the options are malformed.
+    static bool parse(const uint8_t* data, size_t length, TCPOptions& options);
+    
+    // Serialize to wire format, NOP-padded to a multiple of 4 bytes
+    std::vector<uint8_t> serialize() const;
+};
+
+} // namespace tcp_stack
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "tcp_options.h"
+#include "tcp_sequence.h"
+#include <cstdint>
+#include <cstddef>
+#include <map>
+#include <vector>
+
+namespace tcp_stack {
+
+// Receive-side out-of-order queue. Holds segments that arrived beyond
+// rcv.nxt until the gap is filled, and describes what it holds as SACK
+// blocks for the peer.
+class TCPReassemblyQueue {
+public:
+    TCPReassemblyQueue();
+    
+    // Queue a segment that starts beyond rcv.nxt
+    void insert(uint32_t seq, const uint8_t* data, size_t length);
+    
+    // Append bytes now contiguous with rcv_nxt to out and advance rcv_nxt
+    void take_in_order(uint32_t& rcv_nxt, std::vector<uint8_t>& out);
+    
+    // Up to max_blocks SACK blocks, the block holding the most recently
+    // received segment first (RFC 2018 section 4)
+    std::vector<SackBlock> sack_blocks(size_t max_blocks) const;
+    
+    bool empty() const { return segments_.empty(); }
+    size_t buffered_bytes() const { return buffered_bytes_; }
+    void clear();
+    
+private:
+    std::map<uint32_t, std::vector<uint8_t>, SeqLess> segments_;
+    size_t buffered_bytes_;
+    uint32_t last_received_seq_;
+};
+
+} // namespace tcp_stack
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "ip_header.h"
+#include "tcp_header.h"
+#include "tcp_options.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace tcp_stack {
+
+// A parsed, checksum-verified inbound segment. After coalescing it may
+// stand for several wire segments of one flow.
+struct ReceivedSegment {
+    IPHeader ip_header;
+    TCPHeader tcp_header;           // Host byte order
+    TCPOptions options;
+    std::vector<uint8_t> payload;
+    uint16_t segment_count = 1;     // Wire segments merged into this one
+    uint16_t max_segment_size = 0;  // Largest wire payload among them
+};
+
+// Receive-side coalescing (GRO). Within one RX burst, consecutive in-order
+// data segments of a flow with identical ACK, window and flags are merged,
+// so demux, ACK processing and socket wakeup run once per run of segments
+// instead of once per packet. A PSH, control flag, option or sequence gap
+// ends the run.
+class TCPReceiveCoalescer {
+public:
+    static constexpr size_t MAX_COALESCED_BYTES = 65535;
+    
+    // Add the next segment of the burst
+    void add(ReceivedSegment&& segment);
+    
+    // The burst's (merged) segments in arrival order; resets for the next burst
+    std::vector<ReceivedSegment> flush();
+    
+    bool empty() const { return segments_.empty(); }
+    
+private:
+    std::vector<ReceivedSegment> segments_;
+    
+    static bool can_merge(const ReceivedSegment& run, const ReceivedSegment& next);
+    static bool same_flow(const ReceivedSegment& a, const ReceivedSegment& b);
+};
+
+} // namespace tcp_stack
\ No newline at end of file
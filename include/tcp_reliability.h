@@ -1,9 +1,13 @@
 #pragma once
 
+#include "sack_scoreboard.h"
+#include "tcp_options.h"
+#include "dctcp.h"
 #include <cstdint>
 #include <vector>
 #include <chrono>
 #include <queue>
+#include <deque>
 #include <memory>
 
 namespace tcp_stack {
@@ -20,41 +24,134 @@ struct TCPSegment {
           retransmit_count(0), acknowledged(false) {}
 };
 
+// How losses are inferred before the retransmission timer fires
+enum class LossDetection {
+    DUP_ACK,        // Duplicate-ACK threshold (RFC 5681 / RFC 6675)
+    RACK_TLP        // Time-based RACK plus Tail Loss Probes (RFC 8985)
+};
+
+// How the window responds to ECN congestion marks
+enum class CongestionControl {
+    NEW_RENO,       // Halve once per window, as for a loss (RFC 3168)
+    DCTCP           // In proportion to the marked fraction (RFC 8257)
+};
+
 class TCPReliability {
 public:
     TCPReliability();
     
+    // RTO defaults (RFC 6298 section 2; 200ms minimum as in Linux)
+    static constexpr std::chrono::microseconds DEFAULT_INITIAL_RTO{1000000};
+    static constexpr std::chrono::microseconds DEFAULT_MIN_RTO{200000};
+    static constexpr std::chrono::microseconds DEFAULT_CLOCK_GRANULARITY{1000};
+    static constexpr std::chrono::microseconds MAX_RTO{60000000};
+    
+    // Congestion control defaults (RFC 5681, RFC 6928)
+    static constexpr uint16_t DEFAULT_MSS = 1460;
+    static constexpr uint32_t INITIAL_CWND_SEGMENTS = 10;
+    static constexpr uint8_t DUP_ACK_THRESHOLD = 3;
+    
+    // Local cap on unacknowledged data, like Linux's default maximum
+    // send buffer; the peer's (scaled) window normally binds first
+    static constexpr uint32_t DEFAULT_SEND_WINDOW = 4 * 1024 * 1024;
+    
+    // RACK-TLP (RFC 8985 section 7.2): extra PTO allowance when only one
+    // segment is outstanding and the peer may be delaying its ACK
+    static constexpr std::chrono::microseconds TLP_WORST_CASE_ACK_DELAY{200000};
+    static constexpr std::chrono::microseconds TLP_DEFAULT_PTO{1000000};
+    
     // Configure parameters
-    void set_initial_rto(std::chrono::milliseconds rto) { rto_ = rto; }
+    void set_initial_rto(std::chrono::microseconds rto) { rto_ = rto; }
+    void set_min_rto(std::chrono::microseconds min_rto) { min_rto_ = min_rto; }
+    void set_clock_granularity(std::chrono::microseconds granularity) { clock_granularity_ = granularity; }
     void set_max_retransmits(uint8_t max_retx) { max_retransmits_ = max_retx; }
-    void set_window_size(uint16_t window) { send_window_size_ = window; }
+    void set_window_size(uint32_t window) { send_window_size_ = window; }
+    void set_mss(uint16_t mss);
+    void set_sack_enabled(bool enabled) { sack_enabled_ = enabled; }
+    void set_loss_detection(LossDetection mode) { loss_detection_ = mode; }
+    void set_ecn_enabled(bool enabled) { ecn_enabled_ = enabled; }
+    void set_congestion_control(CongestionControl algorithm);
+    LossDetection get_loss_detection() const { return loss_detection_; }
     
     // Sequence number management
     uint32_t get_next_seq() const { return next_seq_num_; }
     void advance_seq(uint32_t bytes) { next_seq_num_ += bytes; }
-    void set_initial_seq(uint32_t seq) { next_seq_num_ = seq; }
+    void set_initial_seq(uint32_t seq);
     
-    // Acknowledgment handling
+    // Acknowledgment handling. The window is in bytes, already scaled; ece
+    // is the ACK's ECN-Echo flag. The single-argument form treats the
+    // segment as a pure ACK that leaves the advertised window unchanged.
     void process_ack(uint32_t ack_num);
+    void process_ack(uint32_t ack_num, uint32_t window, size_t payload_length,
+                     const std::vector<SackBlock>& sack_blocks = {}, bool ece = false);
     bool is_seq_acknowledged(uint32_t seq_num) const;
     
     // Send buffer management
     bool can_send_data(size_t data_size) const;
     void buffer_data(const std::vector<uint8_t>& data);
+    size_t get_buffered_bytes() const { return send_buffer_.size(); }
     std::vector<uint8_t> get_data_to_send(size_t max_size);
     
+    // Carve up to max_bytes (limited by the window) into segment_size
+    // segments in one pass, for segmentation offload on the send path
+    std::vector<std::shared_ptr<TCPSegment>> get_burst_to_send(size_t max_bytes,
+                                                               size_t segment_size);
+    
     // Retransmission handling
     std::vector<std::shared_ptr<TCPSegment>> get_segments_to_retransmit();
     void mark_segment_sent(std::shared_ptr<TCPSegment> segment);
     
+    // Fast retransmit / NewReno fast recovery (RFC 5681, RFC 6582), or
+    // SACK-based recovery (RFC 6675) once SACK has been negotiated.
+    // Segments queued by process_ack() that must go out immediately.
+    std::vector<std::shared_ptr<TCPSegment>> take_fast_retransmits();
+    bool in_fast_recovery() const { return in_fast_recovery_; }
+    
+    // Path MTU dropped: resend in-flight segments larger than mss now
+    // (RFC 1191 section 6.5); this is not a congestion signal
+    void queue_oversized_retransmits(size_t mss);
+    uint8_t get_dup_ack_count() const { return dup_ack_count_; }
+    
+    // ECN: after a reduction the next new data segment carries CWR; this
+    // returns true once per reduction
+    bool is_ecn_enabled() const { return ecn_enabled_; }
+    CongestionControl get_congestion_control() const { return congestion_control_; }
+    bool take_cwr();
+    uint32_t get_ecn_reductions() const { return ecn_reductions_; }
+    uint32_t get_dctcp_alpha() const { return dctcp_.get_alpha(); }
+    
+    // SACK scoreboard
+    bool is_sack_enabled() const { return sack_enabled_; }
+    const SackScoreboard& get_scoreboard() const { return scoreboard_; }
+    bool is_segment_sacked(const TCPSegment& segment) const;
+    uint32_t get_pipe() const;
+    
+    // RACK reordering timer and TLP probe timer. Expired timers queue
+    // their retransmissions for take_fast_retransmits().
+    void process_timers();
+    std::chrono::steady_clock::time_point get_next_timer_deadline() const;
+    uint32_t get_tlp_probe_count() const { return tlp_probe_count_; }
+    
     // Timeout management
     bool has_timeout() const;
-    std::chrono::milliseconds get_rto() const { return rto_; }
-    void update_rtt(std::chrono::milliseconds rtt);
+    std::chrono::microseconds get_rto() const { return rto_; }
+    std::chrono::microseconds get_min_rto() const { return min_rto_; }
+    std::chrono::microseconds get_clock_granularity() const { return clock_granularity_; }
+    void update_rtt(std::chrono::microseconds rtt);
+    
+    // RTT estimator state (unscaled)
+    bool has_rtt_sample() const { return has_rtt_sample_; }
+    std::chrono::microseconds get_srtt() const { return std::chrono::microseconds(srtt_us_ >> SRTT_SHIFT); }
+    std::chrono::microseconds get_rttvar() const { return std::chrono::microseconds(rttvar_us_ >> RTTVAR_SHIFT); }
     
     // Flow control
-    void update_remote_window(uint16_t window) { remote_window_size_ = window; }
-    uint16_t get_effective_window() const;
+    void update_remote_window(uint32_t window) { remote_window_size_ = window; }
+    uint32_t get_effective_window() const;
+    
+    // Congestion control
+    uint32_t get_cwnd() const { return cwnd_; }
+    uint32_t get_ssthresh() const { return ssthresh_; }
+    uint16_t get_mss() const { return mss_; }
     
     // Statistics
     uint32_t get_bytes_in_flight() const { return bytes_in_flight_; }
@@ -66,29 +163,84 @@ private:
     uint32_t last_ack_received_;
     
     // Buffers
-    std::queue<uint8_t> send_buffer_;
+    std::deque<uint8_t> send_buffer_;
     std::vector<std::shared_ptr<TCPSegment>> unacked_segments_;
     
     // Timing and retransmission
-    std::chrono::milliseconds rto_;                    // Retransmission timeout
-    std::chrono::milliseconds srtt_;                   // Smoothed RTT
-    std::chrono::milliseconds rttvar_;                 // RTT variation
+    std::chrono::microseconds rto_;                    // Retransmission timeout
+    std::chrono::microseconds min_rto_;                // Lower bound for RTO
+    std::chrono::microseconds clock_granularity_;      // G in RFC 6298
+    uint32_t srtt_us_;                                 // Smoothed RTT in us, scaled by 8 (srtt << 3)
+    uint32_t rttvar_us_;                               // RTT variation in us, scaled by 4 (rttvar << 2)
+    bool has_rtt_sample_;
     uint8_t max_retransmits_;
     
     // Flow control
-    uint16_t send_window_size_;                        // Our send window
-    uint16_t remote_window_size_;                      // Remote's receive window
+    uint32_t send_window_size_;                        // Our send window
+    uint32_t remote_window_size_;                      // Remote's receive window
     uint32_t bytes_in_flight_;                         // Unacknowledged bytes
     
-    // Constants for RTT calculation (RFC 6298)
-    static constexpr double RTT_ALPHA = 0.125;
-    static constexpr double RTT_BETA = 0.25;
-    static constexpr int RTT_K = 4;
-    static constexpr int RTT_G = 100; // Clock granularity in ms
+    // Congestion control and loss recovery
+    uint16_t mss_;                                     // Sender maximum segment size
+    uint32_t cwnd_;                                    // Congestion window in bytes
+    uint32_t ssthresh_;                                // Slow start threshold in bytes
+    uint8_t dup_ack_count_;                            // Consecutive duplicate ACKs
+    bool in_fast_recovery_;
+    uint32_t recover_;                                 // NewReno "recover" (RFC 6582)
+    std::vector<std::shared_ptr<TCPSegment>> fast_retransmit_queue_;
+    
+    // ECN (RFC 3168) and its congestion response
+    bool ecn_enabled_;
+    CongestionControl congestion_control_;
+    DCTCP dctcp_;
+    uint32_t ecn_recover_;                             // No further reduction until acked past
+    bool cwr_pending_;
+    uint32_t ecn_reductions_;
+    
+    // SACK loss recovery (RFC 6675)
+    bool sack_enabled_;
+    SackScoreboard scoreboard_;
+    uint32_t high_rxt_;                                // HighRxt: highest retransmitted seq
+    
+    // RACK-TLP (RFC 8985)
+    LossDetection loss_detection_;
+    bool rack_has_sample_;
+    std::chrono::steady_clock::time_point rack_xmit_ts_; // Send time of newest delivered segment
+    uint32_t rack_end_seq_;                            // ... and its end sequence
+    std::chrono::microseconds rack_rtt_;               // RTT of that delivery
+    std::chrono::microseconds rack_min_rtt_;
+    std::chrono::steady_clock::time_point reorder_deadline_;
+    std::chrono::steady_clock::time_point tlp_deadline_;
+    bool tlp_in_progress_;
+    uint32_t tlp_end_seq_;
+    uint32_t tlp_probe_count_;
+    
+    // RTT calculation (RFC 6298). ALPHA = 1/8 and BETA = 1/4 are applied as
+    // shifts on the scaled state; K = 4 is folded into the rttvar scale.
+    static constexpr unsigned SRTT_SHIFT = 3;
+    static constexpr unsigned RTTVAR_SHIFT = 2;
     
     // Helper methods
     void remove_acknowledged_segments(uint32_t ack_num);
     void calculate_rto();
+    void on_new_ack(uint32_t acked_bytes);
+    void on_duplicate_ack();
+    void on_ecn_echo(uint32_t acked_bytes, bool ece);
+    void enter_fast_recovery();
+    void reduce_congestion_window();
+    void queue_first_unacked_for_retransmit();
+    void queue_sack_retransmits();
+    bool is_lost(uint32_t seq) const;
+    bool update_scoreboard(const std::vector<SackBlock>& sack_blocks);
+    uint32_t get_flight_size() const;
+    size_t get_available_window() const;
+    std::shared_ptr<TCPSegment> take_segment(size_t length);
+    void queue_retransmit(const std::shared_ptr<TCPSegment>& segment);
+    void rack_update(const TCPSegment& segment, std::chrono::steady_clock::time_point now);
+    void rack_detect_loss(std::chrono::steady_clock::time_point now);
+    std::chrono::microseconds rack_reorder_window() const;
+    void arm_tlp(std::chrono::steady_clock::time_point now);
+    void send_tail_loss_probe();
 };
 
 } // namespace tcp_stack
\ No newline at end of file
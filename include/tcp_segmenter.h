@@ -0,0 +1,34 @@
+#pragma once
+
+#include "tcp_header.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace tcp_stack {
+
+// Software segmentation offload: stamps out TCP segments that differ only
+// in sequence number, flags and payload from one header template. The
+// pseudo header, fixed header fields and options are summed once, so each
+// segment's checksum costs only its payload. The result is identical to
+// checksumming every segment from scratch.
+class TCPSegmenter {
+public:
+    // header is in host byte order; seq_num, flags and checksum are ignored
+    TCPSegmenter(uint32_t src_ip, uint32_t dst_ip, const TCPHeader& header,
+                 const std::vector<uint8_t>& options);
+    
+    size_t header_length() const { return sizeof(TCPHeader) + options_.size(); }
+    
+    // Write a complete segment (network order) into out starting at offset;
+    // out must already hold offset + header_length() + length bytes
+    void build(uint32_t seq, uint8_t flags, const uint8_t* payload, size_t length,
+               std::vector<uint8_t>& out, size_t offset) const;
+    
+private:
+    TCPHeader template_;
+    std::vector<uint8_t> options_;
+    uint32_t base_sum_;         // Everything except seq, offset/flags and length
+};
+
+} // namespace tcp_stack
\ No newline at end of file
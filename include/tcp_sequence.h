@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+namespace tcp_stack {
+
+// Modular sequence number comparisons (RFC 793 section 3.3, RFC 1982).
+// A plain `a < b` breaks once the sequence space wraps at 2^32; comparing
+// the signed distance instead is correct for any two numbers less than
+// 2^31 apart.
+inline constexpr bool seq_lt(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) < 0;
+}
+
+inline constexpr bool seq_leq(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) <= 0;
+}
+
+inline constexpr bool seq_gt(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) > 0;
+}
+
+inline constexpr bool seq_geq(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) >= 0;
+}
+
+// Ordering for sorted containers keyed by sequence number. Only a strict
+// weak ordering while every key lies within one 2^31 window, which holds
+// for anything bounded by the send or receive window.
+struct SeqLess {
+    constexpr bool operator()(uint32_t a, uint32_t b) const { return seq_lt(a, b); }
+};
+
+static_assert(seq_lt(0xFFFFFFF0u, 0x10u), "sequence comparison must handle wraparound");
+static_assert(seq_gt(0x10u, 0xFFFFFFF0u), "sequence comparison must handle wraparound");
+
+} // namespace tcp_stack
\ No newline at end of file
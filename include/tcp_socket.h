@@ -1,20 +1,24 @@
 #pragma once
 
 #include "tcp_connection_manager.h"
+#include "stack.h"
 #include "tcp_reliability.h"
+#include "spsc_byte_ring.h"
+#include "event_notifier.h"
+#include "event_poller.h"
 #include <memory>
 #include <vector>
 #include <string>
 #include <thread>
 #include <mutex>
-#include <condition_variable>
 #include <atomic>
 
 namespace tcp_stack {
 
 class TCPSocket {
 public:
-    TCPSocket();
+    TCPSocket();                        // On Stack::default_stack()
+    explicit TCPSocket(Stack& stack);
     ~TCPSocket();
     
     // Non-copyable but movable
@@ -29,38 +33,101 @@ public:
     std::unique_ptr<TCPSocket> accept();
     bool connect(const std::string& ip_address, uint16_t port);
     
-    // Data transfer
+    // Connect and send the first request, in the SYN when a Fast Open
+    // cookie for the server is cached (like sendto() with MSG_FASTOPEN).
+    // Returns without waiting for the handshake; the bytes count as sent.
+    ssize_t connect_with_data(const std::string& ip_address, uint16_t port,
+                              const void* data, size_t length);
+    
+    // Data transfer. SEND_MORE holds back a partial segment because the
+    // caller is about to write more (like MSG_MORE).
+    static constexpr int SEND_MORE = 0x1;
     ssize_t send(const void* data, size_t length);
+    ssize_t send(const void* data, size_t length, int flags);
     ssize_t recv(void* buffer, size_t length);
     
+    // Hold partial segments until uncork() (or 200ms), like TCP_CORK
+    bool cork();
+    bool uncork();
+    
     // Socket management
     bool close();
     bool is_connected() const;
+    bool is_listening() const { return is_listening_; }
+    
+    // Current readiness as EventPoller flags (READABLE, WRITABLE, ACCEPT,
+    // ERROR); see EventPoller for being told when it changes
+    uint32_t poll_events() const;
     
     // Socket options
     bool set_blocking(bool blocking);
     bool set_receive_timeout(std::chrono::milliseconds timeout);
     bool set_send_timeout(std::chrono::milliseconds timeout);
+    bool set_min_rto(std::chrono::microseconds min_rto);
+    bool set_clock_granularity(std::chrono::microseconds granularity);
+    bool set_sack_enabled(bool enabled);
+    bool set_loss_detection(LossDetection mode);
+    bool set_ecn(bool enabled);
+    bool set_fastopen(bool enabled, uint32_t max_pending = 16); // Like TCP_FASTOPEN
+    bool set_congestion_control(CongestionControl algorithm);
+    bool set_delayed_ack(bool enabled);
+    bool set_delayed_ack_timeout(std::chrono::microseconds timeout);
+    bool set_quick_ack(bool enabled);
+    bool set_mss(uint16_t mss);
+    bool set_mtu_probing(bool enabled);
+    bool set_nodelay(bool enabled);
+    bool set_max_pacing_rate(uint64_t bytes_per_second); // 0 removes the cap
+    bool set_priority(uint8_t priority);    // Transmit class, 0 (first) to 7
+    bool set_tx_weight(uint32_t weight);    // Transmit share within the class
+    bool set_max_receive_buffer(uint32_t bytes); // Autotuning cap; 0 is the stack default
     
     // Get socket information
     std::string get_local_address() const;
     uint16_t get_local_port() const;
     std::string get_remote_address() const;
     uint16_t get_remote_port() const;
+    uint16_t get_mss() const;
+    uint32_t get_receive_buffer() const;    // Current autotuned size
+    
+    // Busy polling for the default stack (like net.core.busy_poll): a
+    // dedicated, optionally pinned thread spins on receive and transmit
+    // instead of the sockets' 10ms tick. Trades a core for latency. Other
+    // stacks have their own (Stack::enable_busy_poll()).
+    static bool enable_busy_poll(const BusyPollConfig& config = BusyPollConfig());
+    static void disable_busy_poll();
+    static BusyPollStats get_busy_poll_stats();
     
 private:
+    friend class EventPoller;
+    
     // Internal constructor for accepted connections
     TCPSocket(std::shared_ptr<TCPConnection> conn, 
              std::shared_ptr<TCPConnectionManager> manager);
     
     std::shared_ptr<TCPConnection> connection_;
     std::shared_ptr<TCPConnectionManager> connection_manager_;
-    std::unique_ptr<TCPReliability> reliability_;
+    std::shared_ptr<TCPReliability> reliability_;
     
-    // Receive buffer
-    std::vector<uint8_t> receive_buffer_;
-    std::mutex receive_mutex_;
-    std::condition_variable receive_cv_;
+    // Receive path: a lock-free ring from the stack thread to the reading
+    // thread, sized when the connection attaches to cover the receive
+    // buffer cap. Bytes that find it full (a peer overrunning our window)
+    // wait in receive_overflow_, on the stack side. The reader sleeps on
+    // receive_notifier_, which is only signalled while it is parked.
+    static constexpr size_t MIN_RECEIVE_RING = 64 * 1024;
+    static constexpr std::chrono::milliseconds RECEIVE_WAIT_SLICE{100};
+    std::unique_ptr<SPSCByteRing> receive_ring_;
+    std::vector<uint8_t> receive_overflow_;
+    std::unique_ptr<EventNotifier> receive_notifier_;
+    std::atomic<bool> reader_parked_;
+    
+    // The manager's entry for our listen() and the pollers we are in;
+    // readiness events arrive on the stack thread
+    std::shared_ptr<TCPConnection> listener_;
+    std::vector<std::shared_ptr<PollRegistration>> poll_registrations_;
+    std::mutex poll_mutex_;
+    
+    // Options applied when the connection is opened
+    TCPConnectionConfig config_;
     
     // Socket state
     bool is_listening_;
@@ -79,8 +146,24 @@ private:
     // Background packet processing
     void packet_processing_loop();
     void process_received_data(const std::vector<uint8_t>& data);
+    void drain_receive_overflow();
+    void wake_reader();
+    void signal_pollers(uint32_t events);
+    void attach_poll_registration(const std::shared_ptr<PollRegistration>& registration);
+    void detach_poll_registration(const std::shared_ptr<PollRegistration>& registration);
     
     // Helper methods
+    void attach_connection();
+    
+    // Move support: take over other's state and re-point everything that
+    // refers to it at this object
+    void take_over(TCPSocket& other);
+    void leave_pollers();
+    bool open_connection(const std::string& ip_address, uint16_t port,
+                         const std::vector<uint8_t>& data);
+    
+    // Connected, or in a Fast Open handshake that can already carry data
+    bool is_open() const;
     uint32_t resolve_ip_address(const std::string& ip_str);
     bool start_packet_processor();
     void stop_packet_processor();
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <cstdint>
-#include <string>
+#include <cstddef>
+#include <string_view>
+#include <atomic>
 
 namespace tcp_stack {
 
@@ -35,6 +37,13 @@ enum class TCPEvent {
 
 class TCPStateMachine {
 public:
+    static constexpr size_t STATE_COUNT = static_cast<size_t>(TCPState::TIME_WAIT) + 1;
+    static constexpr size_t EVENT_COUNT = static_cast<size_t>(TCPEvent::RST_RECEIVED) + 1;
+    
+    // Called after every state change, on the thread that processed the
+    // event (under the connection's lock). For tracing; must not block.
+    using TransitionHook = void (*)(TCPState from, TCPState to, TCPEvent event);
+    
     TCPStateMachine();
     
     // Get current state
@@ -56,19 +65,174 @@ public:
     bool can_receive_data() const;
     
     // Get state name as string
-    std::string get_state_name() const;
+    std::string_view get_state_name() const { return get_state_name_for_state(current_state_); }
     
     // Get state name for any state
-    std::string get_state_name_for_state(TCPState state) const;
+    static constexpr std::string_view get_state_name_for_state(TCPState state);
+    static constexpr std::string_view get_event_name(TCPEvent event);
+    
+    // The state an event leads to, straight from the transition table
+    static constexpr TCPState next_state(TCPState current, TCPEvent event);
+    
+    // Process-wide; nullptr (the default) turns tracing off
+    static void set_transition_hook(TransitionHook hook) { transition_hook_.store(hook); }
+    
+    // A hook that logs each transition at DEBUG
+    static void log_transition(TCPState from, TCPState to, TCPEvent event);
     
     // Reset to initial state
     void reset() { current_state_ = TCPState::CLOSED; }
     
 private:
-    TCPState current_state_;
+    // Read lock-free by other threads (readiness, accept); written by
+    // whoever holds the connection's lock
+    std::atomic<TCPState> current_state_;
+    
+    static std::atomic<TransitionHook> transition_hook_;
+    
+    struct TransitionTable {
+        TCPState next[STATE_COUNT][EVENT_COUNT];
+    };
     
-    // State transition table
-    TCPState transition(TCPState current, TCPEvent event);
+    static constexpr TransitionTable make_transition_table();
+    static constexpr bool all_states_reach_closed(const TransitionTable& table);
+    static constexpr bool all_states_reachable(const TransitionTable& table);
+    
+    static const TransitionTable TRANSITIONS;
 };
 
+// RFC 793's state diagram. Events that do not apply in a state leave it
+// unchanged.
+constexpr TCPStateMachine::TransitionTable TCPStateMachine::make_transition_table() {
+    TransitionTable table{};
+    for (size_t state = 0; state < STATE_COUNT; ++state) {
+        for (size_t event = 0; event < EVENT_COUNT; ++event) {
+            table.next[state][event] = static_cast<TCPState>(state);
+        }
+    }
+    
+    auto set = [&table](TCPState from, TCPEvent event, TCPState to) {
+        table.next[static_cast<size_t>(from)][static_cast<size_t>(event)] = to;
+    };
+    
+    set(TCPState::CLOSED, TCPEvent::PASSIVE_OPEN, TCPState::LISTEN);
+    set(TCPState::CLOSED, TCPEvent::ACTIVE_OPEN, TCPState::SYN_SENT);
+    
+    set(TCPState::LISTEN, TCPEvent::SYN_RECEIVED, TCPState::SYN_RECEIVED);
+    set(TCPState::LISTEN, TCPEvent::CLOSE, TCPState::CLOSED);
+    
+    set(TCPState::SYN_SENT, TCPEvent::SYN_ACK_RECEIVED, TCPState::ESTABLISHED);
+    set(TCPState::SYN_SENT, TCPEvent::SYN_RECEIVED, TCPState::SYN_RECEIVED);
+    set(TCPState::SYN_SENT, TCPEvent::CLOSE, TCPState::CLOSED);
+    set(TCPState::SYN_SENT, TCPEvent::TIMEOUT, TCPState::CLOSED);
+    
+    set(TCPState::SYN_RECEIVED, TCPEvent::ACK_RECEIVED, TCPState::ESTABLISHED);
+    set(TCPState::SYN_RECEIVED, TCPEvent::CLOSE, TCPState::CLOSED);
+    
+    set(TCPState::ESTABLISHED, TCPEvent::CLOSE, TCPState::FIN_WAIT_1);
+    set(TCPState::ESTABLISHED, TCPEvent::FIN_RECEIVED, TCPState::CLOSE_WAIT);
+    
+    set(TCPState::FIN_WAIT_1, TCPEvent::ACK_RECEIVED, TCPState::FIN_WAIT_2);
+    set(TCPState::FIN_WAIT_1, TCPEvent::FIN_RECEIVED, TCPState::CLOSING);
+    
+    set(TCPState::FIN_WAIT_2, TCPEvent::FIN_RECEIVED, TCPState::TIME_WAIT);
+    
+    set(TCPState::CLOSE_WAIT, TCPEvent::CLOSE, TCPState::LAST_ACK);
+    
+    set(TCPState::CLOSING, TCPEvent::ACK_RECEIVED, TCPState::TIME_WAIT);
+    
+    set(TCPState::LAST_ACK, TCPEvent::ACK_RECEIVED, TCPState::CLOSED);
+    
+    set(TCPState::TIME_WAIT, TCPEvent::TIMEOUT, TCPState::CLOSED);
+    
+    // A reset ends any connection that has sent or received a SYN
+    for (size_t state = static_cast<size_t>(TCPState::SYN_SENT); state < STATE_COUNT; ++state) {
+        set(static_cast<TCPState>(state), TCPEvent::RST_RECEIVED, TCPState::CLOSED);
+    }
+    return table;
+}
+
+// Every state has some sequence of events back to CLOSED
+constexpr bool TCPStateMachine::all_states_reach_closed(const TransitionTable& table) {
+    bool reaches[STATE_COUNT] = {};
+    reaches[static_cast<size_t>(TCPState::CLOSED)] = true;
+    for (size_t round = 0; round < STATE_COUNT; ++round) {
+        for (size_t state = 0; state < STATE_COUNT; ++state) {
+            for (size_t event = 0; event < EVENT_COUNT; ++event) {
+                if (reaches[static_cast<size_t>(table.next[state][event])]) {
+                    reaches[state] = true;
+                }
+            }
+        }
+    }
+    for (bool reached : reaches) {
+        if (!reached) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// And every state can be entered from CLOSED
+constexpr bool TCPStateMachine::all_states_reachable(const TransitionTable& table) {
+    bool reached[STATE_COUNT] = {};
+    reached[static_cast<size_t>(TCPState::CLOSED)] = true;
+    for (size_t round = 0; round < STATE_COUNT; ++round) {
+        for (size_t state = 0; state < STATE_COUNT; ++state) {
+            for (size_t event = 0; event < EVENT_COUNT && reached[state]; ++event) {
+                reached[static_cast<size_t>(table.next[state][event])] = true;
+            }
+        }
+    }
+    for (bool state : reached) {
+        if (!state) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline constexpr TCPStateMachine::TransitionTable TCPStateMachine::TRANSITIONS =
+    TCPStateMachine::make_transition_table();
+
+constexpr TCPState TCPStateMachine::next_state(TCPState current, TCPEvent event) {
+    static_assert(all_states_reach_closed(TRANSITIONS),
+                  "TCP state table has a state with no way back to CLOSED");
+    static_assert(all_states_reachable(TRANSITIONS),
+                  "TCP state table has an unreachable state");
+    return TRANSITIONS.next[static_cast<size_t>(current)][static_cast<size_t>(event)];
+}
+
+constexpr std::string_view TCPStateMachine::get_state_name_for_state(TCPState state) {
+    switch (state) {
+        case TCPState::CLOSED:       return "CLOSED";
+        case TCPState::LISTEN:       return "LISTEN";
+        case TCPState::SYN_SENT:     return "SYN_SENT";
+        case TCPState::SYN_RECEIVED: return "SYN_RECEIVED";
+        case TCPState::ESTABLISHED:  return "ESTABLISHED";
+        case TCPState::FIN_WAIT_1:   return "FIN_WAIT_1";
+        case TCPState::FIN_WAIT_2:   return "FIN_WAIT_2";
+        case TCPState::CLOSE_WAIT:   return "CLOSE_WAIT";
+        case TCPState::CLOSING:      return "CLOSING";
+        case TCPState::LAST_ACK:     return "LAST_ACK";
+        case TCPState::TIME_WAIT:    return "TIME_WAIT";
+        default:                     return "UNKNOWN";
+    }
+}
+
+constexpr std::string_view TCPStateMachine::get_event_name(TCPEvent event) {
+    switch (event) {
+        case TCPEvent::PASSIVE_OPEN:     return "PASSIVE_OPEN";
+        case TCPEvent::ACTIVE_OPEN:      return "ACTIVE_OPEN";
+        case TCPEvent::SYN_RECEIVED:     return "SYN_RECEIVED";
+        case TCPEvent::SYN_ACK_RECEIVED: return "SYN_ACK_RECEIVED";
+        case TCPEvent::ACK_RECEIVED:     return "ACK_RECEIVED";
+        case TCPEvent::FIN_RECEIVED:     return "FIN_RECEIVED";
+        case TCPEvent::CLOSE:            return "CLOSE";
+        case TCPEvent::TIMEOUT:          return "TIMEOUT";
+        case TCPEvent::RST_RECEIVED:     return "RST_RECEIVED";
+        default:                         return "UNKNOWN";
+    }
+}
+
 } // namespace tcp_stack
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <deque>
+#include <array>
+#include <memory>
+#include <functional>
+
+namespace tcp_stack {
+
+// One connection's queue of built data packets awaiting the link
+struct TransmitFlow {
+    uint32_t src_ip = 0;
+    uint32_t dst_ip = 0;
+    uint8_t priority = 0;       // Strict priority class; 0 is served first
+    uint32_t weight = 1;        // DRR share within the class
+    uint8_t tos = 0;            // IP TOS byte, carrying the ECN codepoint
+    
+    // Scheduler state
+    std::deque<std::vector<uint8_t>> packets;
+    size_t queued_bytes = 0;
+    size_t deficit = 0;
+    bool active = false;
+};
+
+// Stack-level transmit arbitration: strict priority across classes and
+// deficit round robin (Shreedhar and Varghese) across the flows of a
+// class, each flow getting weight * QUANTUM bytes per round. Each visit
+// hands a flow's packets to the link as one batch. A packet the link
+// refuses is dropped; TCP recovers it like any loss.
+class TransmitScheduler {
+public:
+    static constexpr size_t NUM_PRIORITIES = 8;
+    static constexpr size_t QUANTUM = 1500;     // Bytes per round per unit of weight
+    
+    // Sends a batch for one flow and returns how many packets it took; it
+    // may consume the buffers
+    using LinkSend = std::function<size_t(const TransmitFlow&, std::vector<std::vector<uint8_t>>&)>;
+    
+    explicit TransmitScheduler(LinkSend link_send);
+    
+    // Queue a packet; an idle flow joins the back of its class
+    void enqueue(const std::shared_ptr<TransmitFlow>& flow, std::vector<uint8_t>&& packet);
+    
+    // Serve queued packets until none are left or max_packets have gone
+    // to the link. Returns the number of packets handed over.
+    size_t run(size_t max_packets);
+    
+    size_t backlog() const { return backlog_; }
+    uint64_t get_dropped() const { return dropped_; }
+    
+private:
+    LinkSend link_send_;
+    std::array<std::deque<std::shared_ptr<TransmitFlow>>, NUM_PRIORITIES> active_;
+    size_t backlog_;
+    uint64_t dropped_;
+};
+
+} // namespace tcp_stack
\ No newline at end of file
@@ -0,0 +1,383 @@
+#include "async_io.h"
+#include "logger.h"
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+namespace tcp_stack {
+
+namespace {
+
+// epoll tags for our own descriptors; kernel sockets use their fd
+constexpr uint64_t POLLER_TAG = UINT64_MAX;
+constexpr uint64_t WAKEUP_TAG = UINT64_MAX - 1;
+
+thread_local IoContext* current_context = nullptr;
+
+uint32_t to_epoll(uint32_t events) {
+    uint32_t mask = 0;
+    if (events & EventPoller::READABLE) {
+        mask |= EPOLLIN | EPOLLRDHUP;
+    }
+    if (events & EventPoller::WRITABLE) {
+        mask |= EPOLLOUT;
+    }
+    return mask;
+}
+
+uint32_t from_epoll(uint32_t mask) {
+    uint32_t events = 0;
+    if (mask & (EPOLLIN | EPOLLRDHUP)) {
+        events |= EventPoller::READABLE;
+    }
+    if (mask & EPOLLOUT) {
+        events |= EventPoller::WRITABLE;
+    }
+    if (mask & (EPOLLERR | EPOLLHUP)) {
+        events |= EventPoller::ERROR;
+    }
+    return events;
+}
+
+bool would_block() {
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+} // namespace
+
+IoContext::IoContext() : epoll_fd_(epoll_create1(EPOLL_CLOEXEC)) {
+    if (epoll_fd_ < 0) {
+        TCP_LOG_ERROR("Failed to create epoll instance", "error", strerror(errno));
+        return;
+    }
+    
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = POLLER_TAG;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, poller_.get_fd(), &event);
+    event.data.u64 = WAKEUP_TAG;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_.get_fd(), &event);
+}
+
+IoContext::~IoContext() {
+    // Frames first: a suspended coroutine may still own sockets
+    tasks_.clear();
+    if (epoll_fd_ >= 0) {
+        ::close(epoll_fd_);
+    }
+}
+
+IoContext* IoContext::current() {
+    return current_context;
+}
+
+void IoContext::spawn(Task<void> task) {
+    if (task.done()) {
+        return;
+    }
+    runnable_.push_back(task.handle_);
+    tasks_.push_back(std::move(task));
+}
+
+void IoContext::run() {
+    while (!stopped_.load() && !tasks_.empty()) {
+        run_once(std::chrono::milliseconds(-1));
+    }
+    stopped_.store(false);
+}
+
+void IoContext::stop() {
+    stopped_.store(true);
+    wakeup_.notify();
+}
+
+bool IoContext::run_once(std::chrono::milliseconds timeout) {
+    IoContext* previous = current_context;
+    current_context = this;
+    
+    // Don't sleep with coroutines already waiting to run
+    if (epoll_fd_ >= 0) {
+        epoll_event ready[MAX_EVENTS];
+        int wait_ms = runnable_.empty() ? static_cast<int>(timeout.count()) : 0;
+        int count = epoll_wait(epoll_fd_, ready, MAX_EVENTS, wait_ms);
+        for (int i = 0; i < count; ++i) {
+            uint64_t tag = ready[i].data.u64;
+            if (tag == POLLER_TAG) {
+                PollEvent events[MAX_EVENTS];
+                int fired = poller_.wait(events, MAX_EVENTS, std::chrono::milliseconds(0));
+                for (int j = 0; j < fired; ++j) {
+                    dispatch(reinterpret_cast<TCPSocket*>(events[j].data), events[j].events);
+                }
+            } else if (tag == WAKEUP_TAG) {
+                wakeup_.consume();
+            } else {
+                dispatch(static_cast<int>(tag), from_epoll(ready[i].events));
+            }
+        }
+    }
+    
+    bool resumed = !runnable_.empty();
+    while (!runnable_.empty()) {
+        auto handle = runnable_.front();
+        runnable_.pop_front();
+        handle.resume();
+    }
+    
+    current_context = previous;
+    reap_finished();
+    return resumed;
+}
+
+void IoContext::SocketWait::await_suspend(std::coroutine_handle<> handle) {
+    context_.park(socket_, {handle, events_, &fired_});
+}
+
+void IoContext::FdWait::await_suspend(std::coroutine_handle<> handle) {
+    context_.park(fd_, {handle, events_, &fired_});
+}
+
+void IoContext::park(TCPSocket& socket, const Waiter& waiter) {
+    // Edge-triggered: we re-arm by hand on every wait, and add()/modify()
+    // report a socket that is already ready
+    auto& waiters = socket_waiters_[&socket];
+    uint32_t interest = waiter.events;
+    for (const auto& other : waiters) {
+        interest |= other.events;
+    }
+    bool registered = !waiters.empty();
+    waiters.push_back(waiter);
+    
+    uint64_t data = reinterpret_cast<uint64_t>(&socket);
+    if (registered) {
+        poller_.modify(socket, interest | EventPoller::EDGE_TRIGGERED, data);
+    } else {
+        poller_.add(socket, interest | EventPoller::EDGE_TRIGGERED, data);
+    }
+}
+
+void IoContext::park(int fd, const Waiter& waiter) {
+    auto& waiters = fd_waiters_[fd];
+    uint32_t interest = waiter.events;
+    for (const auto& other : waiters) {
+        interest |= other.events;
+    }
+    bool registered = !waiters.empty();
+    waiters.push_back(waiter);
+    
+    if (!update_fd_interest(fd, interest, registered)) {
+        // Not pollable: let the operation retry and fail for itself
+        *waiter.fired = EventPoller::ERROR;
+        waiters.pop_back();
+        if (waiters.empty()) {
+            fd_waiters_.erase(fd);
+        }
+        runnable_.push_back(waiter.handle);
+    }
+}
+
+void IoContext::dispatch(TCPSocket* socket, uint32_t events) {
+    auto it = socket_waiters_.find(socket);
+    if (it == socket_waiters_.end()) {
+        return;
+    }
+    
+    uint32_t interest = 0;
+    std::vector<Waiter> remaining;
+    for (const auto& waiter : it->second) {
+        uint32_t fired = events & (waiter.events | EventPoller::ERROR);
+        if (fired) {
+            *waiter.fired = fired;
+            runnable_.push_back(waiter.handle);
+        } else {
+            remaining.push_back(waiter);
+            interest |= waiter.events;
+        }
+    }
+    
+    if (remaining.empty()) {
+        socket_waiters_.erase(it);
+        poller_.remove(*socket);
+    } else {
+        it->second = std::move(remaining);
+        poller_.modify(*socket, interest | EventPoller::EDGE_TRIGGERED,
+                       reinterpret_cast<uint64_t>(socket));
+    }
+}
+
+void IoContext::dispatch(int fd, uint32_t events) {
+    auto it = fd_waiters_.find(fd);
+    if (it == fd_waiters_.end()) {
+        return;
+    }
+    
+    uint32_t interest = 0;
+    std::vector<Waiter> remaining;
+    for (const auto& waiter : it->second) {
+        uint32_t fired = events & (waiter.events | EventPoller::ERROR);
+        if (fired) {
+            *waiter.fired = fired;
+            runnable_.push_back(waiter.handle);
+        } else {
+            remaining.push_back(waiter);
+            interest |= waiter.events;
+        }
+    }
+    
+    if (remaining.empty()) {
+        fd_waiters_.erase(it);
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    } else {
+        it->second = std::move(remaining);
+        update_fd_interest(fd, interest, true);
+    }
+}
+
+bool IoContext::update_fd_interest(int fd, uint32_t events, bool registered) {
+    if (epoll_fd_ < 0 || fd < 0) {
+        return false;
+    }
+    epoll_event event{};
+    event.events = to_epoll(events);
+    event.data.u64 = static_cast<uint64_t>(fd);
+    return epoll_ctl(epoll_fd_, registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+void IoContext::reap_finished() {
+    for (size_t i = 0; i < tasks_.size();) {
+        if (!tasks_[i].done()) {
+            ++i;
+            continue;
+        }
+        Task<void> finished = std::move(tasks_[i]);
+        tasks_[i] = std::move(tasks_.back());
+        tasks_.pop_back();
+        finished.await_resume();    // Rethrows what escaped the task
+    }
+}
+
+Task<ssize_t> async_recv(TCPSocket& socket, void* buffer, size_t length) {
+    IoContext* context = IoContext::current();
+    socket.set_blocking(false);
+    
+    while (true) {
+        ssize_t received = socket.recv(buffer, length);
+        if (received != 0) {
+            co_return received;
+        }
+        
+        // Nothing buffered. Readable now means data raced in or the peer
+        // closed; take the one or report the other.
+        uint32_t events = socket.poll_events();
+        if (events & EventPoller::ERROR) {
+            co_return -1;
+        }
+        if (events & EventPoller::READABLE) {
+            received = socket.recv(buffer, length);
+            co_return received > 0 ? received : 0;
+        }
+        if (!context) {
+            co_return -1;
+        }
+        co_await context->wait(socket, EventPoller::READABLE);
+    }
+}
+
+Task<ssize_t> async_send(TCPSocket& socket, const void* data, size_t length) {
+    // The stack buffers everything send() is given, so a connected socket
+    // never makes us wait
+    co_return socket.send(data, length);
+}
+
+Task<std::unique_ptr<TCPSocket>> async_accept(TCPSocket& listener) {
+    IoContext* context = IoContext::current();
+    
+    while (listener.is_listening()) {
+        auto connection = listener.accept();
+        if (connection || !context) {
+            co_return connection;
+        }
+        co_await context->wait(listener, EventPoller::ACCEPT);
+    }
+    co_return nullptr;
+}
+
+Task<bool> async_connect(TCPSocket& socket, const std::string& ip_address, uint16_t port) {
+    IoContext* context = IoContext::current();
+    if (!context || socket.connect_with_data(ip_address, port, nullptr, 0) < 0) {
+        co_return false;
+    }
+    
+    // The SYN-ACK signals WRITABLE, a reset ERROR
+    while (!socket.is_connected()) {
+        uint32_t events = co_await context->wait(socket, EventPoller::WRITABLE);
+        if (events & EventPoller::ERROR) {
+            co_return false;
+        }
+    }
+    co_return true;
+}
+
+Task<ssize_t> async_recv(LocalTCPSocket& socket, void* buffer, size_t length) {
+    IoContext* context = IoContext::current();
+    socket.set_blocking(false);
+    
+    while (socket.is_connected()) {
+        ssize_t received = socket.recv(buffer, length);
+        if (received >= 0 || !would_block() || !context) {
+            co_return received;
+        }
+        co_await context->wait(socket.get_fd(), EventPoller::READABLE);
+    }
+    co_return -1;
+}
+
+Task<ssize_t> async_send(LocalTCPSocket& socket, const void* data, size_t length) {
+    IoContext* context = IoContext::current();
+    socket.set_blocking(false);
+    
+    // Like a blocking send: done once all of it is with the kernel
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    size_t sent = 0;
+    while (sent < length && socket.is_connected()) {
+        ssize_t result = socket.send(bytes + sent, length - sent);
+        if (result > 0) {
+            sent += result;
+            continue;
+        }
+        if (result < 0 && (!would_block() || !context)) {
+            break;
+        }
+        co_await context->wait(socket.get_fd(), EventPoller::WRITABLE);
+    }
+    co_return sent > 0 || length == 0 ? static_cast<ssize_t>(sent) : -1;
+}
+
+Task<std::unique_ptr<LocalTCPSocket>> async_accept(LocalTCPSocket& listener) {
+    IoContext* context = IoContext::current();
+    listener.set_blocking(false);
+    
+    while (true) {
+        errno = 0;
+        auto connection = listener.accept();
+        if (connection || !would_block() || !context) {
+            co_return connection;
+        }
+        co_await context->wait(listener.get_fd(), EventPoller::READABLE);
+    }
+}
+
+Task<bool> async_connect(LocalTCPSocket& socket, const std::string& ip_address, uint16_t port) {
+    IoContext* context = IoContext::current();
+    if (!context || !socket.start_connect(ip_address, port)) {
+        co_return false;
+    }
+    if (!socket.is_connected()) {
+        co_await context->wait(socket.get_fd(), EventPoller::WRITABLE);
+        co_return socket.finish_connect();
+    }
+    co_return true;
+}
+
+} // namespace tcp_stack
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include "busy_poll_engine.h"
+#include "numa_utils.h"
+#include "logger.h"
+#include <pthread.h>
+#include <algorithm>
+
+namespace tcp_stack {
+
+namespace {
+
+// Tell the core we are spinning (frees pipeline resources for a sibling
+// hyperthread and saves power)
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+} // namespace
+
+BusyPollEngine::BusyPollEngine(PollFunction poll, BlockFunction block)
+    : poll_(std::move(poll)), block_(std::move(block)), running_(false),
+      polls_(0), empty_polls_(0), blocks_(0), spin_window_us_(0), cpu_(-1), numa_node_(-1) {}
+
+BusyPollEngine::~BusyPollEngine() {
+    stop();
+}
+
+bool BusyPollEngine::start(const BusyPollConfig& config) {
+    if (thread_.joinable()) {
+        return false;
+    }
+    config_ = config;
+    spin_window_us_.store(config.spin_budget.count(), std::memory_order_relaxed);
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&BusyPollEngine::run, this);
+    return true;
+}
+
+void BusyPollEngine::stop() {
+    running_.store(false, std::memory_order_release);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+BusyPollStats BusyPollEngine::get_stats() const {
+    BusyPollStats stats;
+    stats.polls = polls_.load(std::memory_order_relaxed);
+    stats.empty_polls = empty_polls_.load(std::memory_order_relaxed);
+    stats.blocks = blocks_.load(std::memory_order_relaxed);
+    stats.spin_window = std::chrono::microseconds(spin_window_us_.load(std::memory_order_relaxed));
+    stats.cpu = cpu_.load(std::memory_order_relaxed);
+    stats.numa_node = numa_node_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void BusyPollEngine::place() {
+    // From the engine thread itself, so it never runs a pass off its CPUs
+    // and the memory policy (a per-thread setting) applies to it
+    std::vector<int> cpus = config_.cpu >= 0 ? std::vector<int>{config_.cpu} : config_.cpus;
+    if (!cpus.empty() && !NumaUtils::pin_thread(pthread_self(), cpus)) {
+        TCP_LOG_WARN("Failed to pin busy-poll engine to its CPUs");
+    }
+    if (config_.numa_node >= 0 && !NumaUtils::prefer_node(config_.numa_node)) {
+        TCP_LOG_WARN("Failed to set busy-poll engine memory policy", "node", config_.numa_node);
+    }
+    sample_location();
+}
+
+void BusyPollEngine::sample_location() {
+    int cpu, node;
+    if (NumaUtils::current_location(cpu, node)) {
+        cpu_.store(cpu, std::memory_order_relaxed);
+        numa_node_.store(node, std::memory_order_relaxed);
+    }
+}
+
+void BusyPollEngine::run() {
+    using Clock = std::chrono::steady_clock;
+    
+    const auto budget = config_.spin_budget;
+    const auto min_window = budget / (1 << MIN_SPIN_SHIFT);
+    auto window = budget;
+    auto idle_since = Clock::now();
+    place();
+    
+    while (running_.load(std::memory_order_acquire)) {
+        bool found = poll_();
+        polls_.fetch_add(1, std::memory_order_relaxed);
+        
+        if (found) {
+            if (window != budget) {
+                window = budget;
+                spin_window_us_.store(window.count(), std::memory_order_relaxed);
+            }
+            idle_since = Clock::now();
+            continue;
+        }
+        empty_polls_.fetch_add(1, std::memory_order_relaxed);
+        
+        auto now = Clock::now();
+        if (now - idle_since < window) {
+            cpu_relax();
+            continue;
+        }
+        
+        // Nothing for a whole window: give the core back until traffic
+        // (or the block limit), and spin less next time we go idle
+        blocks_.fetch_add(1, std::memory_order_relaxed);
+        block_(config_.max_block);
+        sample_location();
+        window = std::max(window / 2, min_window);
+        spin_window_us_.store(window.count(), std::memory_order_relaxed);
+        idle_since = Clock::now();
+    }
+}
+
+} // namespace tcp_stack
\ No newline at end of file
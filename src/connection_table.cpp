@@ -0,0 +1,104 @@
+#include "connection_table.h"
+#include "tcp_connection_manager.h"
+#include <new>
+
+namespace tcp_stack {
+
+namespace {
+
+size_t round_up_pow2(size_t n) {
+    size_t size = 1;
+    while (size < n) {
+        size <<= 1;
+    }
+    return size;
+}
+
+} // namespace
+
+ConnectionTable::ConnectionTable(size_t buckets, int numa_node, bool huge_pages)
+    : mask_(round_up_pow2(std::max<size_t>(buckets, 1)) - 1),
+      memory_((mask_ + 1) * sizeof(Bucket), numa_node, huge_pages),
+      buckets_(static_cast<Bucket*>(memory_.data())), key_(SipHashKey::random()), size_(0) {
+    for (size_t i = 0; i <= mask_; ++i) {
+        new (&buckets_[i]) Bucket();
+    }
+}
+
+ConnectionTable::~ConnectionTable() {
+    // Nobody is reading any more; free the chains directly
+    for (size_t i = 0; i <= mask_; ++i) {
+        Node* node = buckets_[i].head.load(std::memory_order_relaxed);
+        while (node) {
+            Node* next = node->next.load(std::memory_order_relaxed);
+            delete node;
+            node = next;
+        }
+        buckets_[i].~Bucket();
+    }
+}
+
+ConnectionTable::Bucket& ConnectionTable::bucket_for(uint32_t local_ip, uint16_t local_port,
+                                                     uint32_t remote_ip, uint16_t remote_port) const {
+    // Keyed, so a peer choosing ports cannot aim everything at one chain
+    return buckets_[siphash24_tuple(key_, local_ip, local_port, remote_ip, remote_port) & mask_];
+}
+
+std::shared_ptr<TCPConnection> ConnectionTable::find(uint32_t local_ip, uint16_t local_port,
+                                                     uint32_t remote_ip, uint16_t remote_port) const {
+    EpochGuard guard;
+    const Bucket& bucket = bucket_for(local_ip, local_port, remote_ip, remote_port);
+    for (Node* node = bucket.head.load(std::memory_order_acquire); node;
+         node = node->next.load(std::memory_order_acquire)) {
+        if (node->local_ip == local_ip && node->local_port == local_port &&
+            node->remote_ip == remote_ip && node->remote_port == remote_port) {
+            return node->conn;
+        }
+    }
+    return nullptr;
+}
+
+bool ConnectionTable::insert(const std::shared_ptr<TCPConnection>& conn) {
+    Bucket& bucket = bucket_for(conn->local_ip, conn->local_port,
+                                conn->remote_ip, conn->remote_port);
+    std::lock_guard<std::mutex> lock(bucket.mutex);
+    
+    Node* head = bucket.head.load(std::memory_order_relaxed);
+    for (Node* node = head; node; node = node->next.load(std::memory_order_relaxed)) {
+        if (node->local_ip == conn->local_ip && node->local_port == conn->local_port &&
+            node->remote_ip == conn->remote_ip && node->remote_port == conn->remote_port) {
+            return false;
+        }
+    }
+    
+    // Fully built before the release store makes it reachable
+    Node* node = new Node{conn->local_ip, conn->local_port, conn->remote_ip, conn->remote_port,
+                          conn, {}};
+    node->next.store(head, std::memory_order_relaxed);
+    bucket.head.store(node, std::memory_order_release);
+    size_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool ConnectionTable::remove(const std::shared_ptr<TCPConnection>& conn) {
+    Bucket& bucket = bucket_for(conn->local_ip, conn->local_port,
+                                conn->remote_ip, conn->remote_port);
+    std::lock_guard<std::mutex> lock(bucket.mutex);
+    
+    std::atomic<Node*>* link = &bucket.head;
+    for (Node* node = link->load(std::memory_order_relaxed); node;
+         node = link->load(std::memory_order_relaxed)) {
+        if (node->conn == conn) {
+            // Readers on the node still find their way on through its
+            // next, which is left as it is
+            link->store(node->next.load(std::memory_order_relaxed), std::memory_order_release);
+            size_.fetch_sub(1, std::memory_order_relaxed);
+            EpochReclaimer::instance().retire([node] { delete node; });
+            return true;
+        }
+        link = &node->next;
+    }
+    return false;
+}
+
+} // namespace tcp_stack
\ No newline at end of file
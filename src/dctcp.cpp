@@ -0,0 +1,44 @@
+#include "dctcp.h"
+#include "tcp_sequence.h"
+#include <algorithm>
+
+namespace tcp_stack {
+
+DCTCP::DCTCP() {
+    reset(0);
+}
+
+void DCTCP::reset(uint32_t snd_nxt) {
+    alpha_ = ALPHA_ONE;
+    window_end_ = snd_nxt;
+    acked_bytes_ = 0;
+    marked_bytes_ = 0;
+}
+
+void DCTCP::on_ack(uint32_t snd_una, uint32_t snd_nxt, uint32_t acked_bytes, bool ece) {
+    acked_bytes_ += acked_bytes;
+    if (ece) {
+        marked_bytes_ += acked_bytes;
+    }
+    
+    if (!seq_gt(snd_una, window_end_)) {
+        return;
+    }
+    
+    // alpha = (1 - g) * alpha + g * F
+    if (acked_bytes_ > 0) {
+        uint32_t fraction = static_cast<uint32_t>(marked_bytes_ * ALPHA_ONE / acked_bytes_);
+        alpha_ = alpha_ - (alpha_ >> GAIN_SHIFT) + (fraction >> GAIN_SHIFT);
+    }
+    
+    window_end_ = snd_nxt;
+    acked_bytes_ = 0;
+    marked_bytes_ = 0;
+}
+
+uint32_t DCTCP::reduced_window(uint32_t cwnd, uint32_t mss) const {
+    uint64_t reduction = static_cast<uint64_t>(cwnd) * alpha_ / (2 * ALPHA_ONE);
+    return std::max<uint32_t>(cwnd - static_cast<uint32_t>(reduction), 2 * mss);
+}
+
+} // namespace tcp_stack
\ No newline at end of file
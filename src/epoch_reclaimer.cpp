@@ -0,0 +1,144 @@
+#include "epoch_reclaimer.h"
+#include <utility>
+
+namespace tcp_stack {
+
+namespace {
+
+// Gives the record back when its thread exits. The reclaimer is never
+// destroyed, so the record is still there to release.
+struct ThreadRecordHolder {
+    void* record = nullptr;
+    void (*release)(void*) = nullptr;
+    ~ThreadRecordHolder() {
+        if (record) {
+            release(record);
+        }
+    }
+};
+
+thread_local ThreadRecordHolder thread_holder;
+
+} // namespace
+
+EpochReclaimer& EpochReclaimer::instance() {
+    // Leaked on purpose: thread records must outlive every thread's exit
+    static EpochReclaimer* reclaimer = new EpochReclaimer();
+    return *reclaimer;
+}
+
+EpochReclaimer::ThreadRecord* EpochReclaimer::acquire_record() {
+    for (ThreadRecord* record = records_.load(std::memory_order_acquire); record;
+         record = record->next) {
+        bool expected = false;
+        if (!record->in_use.load(std::memory_order_relaxed) &&
+            record->in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+            return record;
+        }
+    }
+    
+    auto* record = new ThreadRecord();
+    record->in_use.store(true, std::memory_order_relaxed);
+    ThreadRecord* head = records_.load(std::memory_order_relaxed);
+    do {
+        record->next = head;
+    } while (!records_.compare_exchange_weak(head, record, std::memory_order_release,
+                                             std::memory_order_relaxed));
+    return record;
+}
+
+void EpochReclaimer::release_record(ThreadRecord* record) {
+    record->state.store(0, std::memory_order_release);
+    record->nesting = 0;
+    record->in_use.store(false, std::memory_order_release);
+}
+
+EpochReclaimer::ThreadRecord* EpochReclaimer::thread_record() {
+    if (!thread_holder.record) {
+        thread_holder.record = acquire_record();
+        thread_holder.release = [](void* record) {
+            release_record(static_cast<ThreadRecord*>(record));
+        };
+    }
+    return static_cast<ThreadRecord*>(thread_holder.record);
+}
+
+void EpochReclaimer::pin() {
+    ThreadRecord* record = thread_record();
+    if (record->nesting++ > 0) {
+        return;
+    }
+    // Announce the epoch before touching the structure: the fence orders
+    // the announcement before our loads, pairing with reclaim()'s fence.
+    // Release, so whatever we read while pinned earlier happens before a
+    // reclaimer that sees the new announcement frees it.
+    uint64_t epoch = global_epoch_.load(std::memory_order_acquire);
+    record->state.store((epoch << 1) | 1, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+void EpochReclaimer::unpin() {
+    ThreadRecord* record = thread_record();
+    if (--record->nesting == 0) {
+        record->state.store(0, std::memory_order_release);
+    }
+}
+
+void EpochReclaimer::retire(std::function<void()> deleter) {
+    bool due;
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex_);
+        retired_.push_back({global_epoch_.load(std::memory_order_acquire), std::move(deleter)});
+        due = ++since_reclaim_ >= RECLAIM_INTERVAL;
+    }
+    if (due) {
+        reclaim();
+    }
+}
+
+size_t EpochReclaimer::reclaim() {
+    std::vector<Retired> ready;
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex_);
+        since_reclaim_ = 0;
+        
+        // Advance only if every pinned thread has seen the current epoch
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint64_t epoch = global_epoch_.load(std::memory_order_relaxed);
+        bool advance = true;
+        for (ThreadRecord* record = records_.load(std::memory_order_acquire); record;
+             record = record->next) {
+            uint64_t state = record->state.load(std::memory_order_acquire);
+            if ((state & 1) && (state >> 1) != epoch) {
+                advance = false;
+                break;
+            }
+        }
+        if (advance) {
+            global_epoch_.store(++epoch, std::memory_order_release);
+        }
+        
+        // Retired two epochs ago: unreachable by anyone still pinned
+        auto keep = retired_.begin();
+        for (auto it = retired_.begin(); it != retired_.end(); ++it) {
+            if (it->epoch + 2 <= epoch) {
+                ready.push_back(std::move(*it));
+            } else {
+                *keep++ = std::move(*it);
+            }
+        }
+        retired_.erase(keep, retired_.end());
+    }
+    
+    for (auto& retired : ready) {
+        retired.deleter();
+    }
+    return ready.size();
+}
+
+size_t EpochReclaimer::pending() const {
+    std::lock_guard<std::mutex> lock(retired_mutex_);
+    return retired_.size();
+}
+
+} // namespace tcp_stack
\ No newline at end of file
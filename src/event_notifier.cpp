@@ -0,0 +1,46 @@
+#include "event_notifier.h"
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+
+namespace tcp_stack {
+
+EventNotifier::EventNotifier()
+    : fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+}
+
+EventNotifier::~EventNotifier() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+void EventNotifier::notify() {
+    uint64_t one = 1;
+    ssize_t result = ::write(fd_, &one, sizeof(one));
+    (void)result; // Only fails if the counter would overflow, i.e. already signalled
+}
+
+bool EventNotifier::wait(std::chrono::milliseconds timeout) {
+    if (consume()) {
+        return true;
+    }
+    
+    struct pollfd pfd = {fd_, POLLIN, 0};
+    int ms = timeout.count() < 0 ? -1 : static_cast<int>(timeout.count());
+    int result;
+    do {
+        result = ::poll(&pfd, 1, ms);
+    } while (result < 0 && errno == EINTR);
+    
+    return result > 0 && consume();
+}
+
+bool EventNotifier::consume() {
+    uint64_t count;
+    return ::read(fd_, &count, sizeof(count)) == static_cast<ssize_t>(sizeof(count));
+}
+
+} // namespace tcp_stack
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include "event_poller.h"
+#include "tcp_socket.h"
+#include <vector>
+
+namespace tcp_stack {
+
+EventPoller::EventPoller() = default;
+
+EventPoller::~EventPoller() {
+    std::vector<std::shared_ptr<PollRegistration>> registrations;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& entry : registrations_) {
+            registrations.push_back(entry.second);
+        }
+    }
+    for (auto& registration : registrations) {
+        if (registration->socket) {
+            registration->socket->detach_poll_registration(registration);
+        }
+    }
+}
+
+bool EventPoller::add(TCPSocket& socket, uint32_t events, uint64_t data) {
+    auto registration = std::make_shared<PollRegistration>();
+    registration->poller = this;
+    registration->socket = &socket;
+    registration->interest = events;
+    registration->data = data;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!registrations_.emplace(&socket, registration).second) {
+            return false;
+        }
+    }
+    socket.attach_poll_registration(registration);
+    
+    // Already ready: report it without waiting for the next event
+    if (socket.poll_events() & (events | ERROR)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        enqueue(registration);
+    }
+    return true;
+}
+
+bool EventPoller::modify(TCPSocket& socket, uint32_t events, uint64_t data) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = registrations_.find(&socket);
+    if (it == registrations_.end()) {
+        return false;
+    }
+    it->second->interest = events;
+    it->second->data = data;
+    if (socket.poll_events() & (events | ERROR)) {
+        enqueue(it->second);
+    }
+    return true;
+}
+
+bool EventPoller::remove(TCPSocket& socket) {
+    std::shared_ptr<PollRegistration> registration;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = registrations_.find(&socket);
+        if (it == registrations_.end()) {
+            return false;
+        }
+        registration = it->second;
+        registrations_.erase(it);
+        registration->socket = nullptr;     // Skipped if still on the ready list
+    }
+    socket.detach_poll_registration(registration);
+    return true;
+}
+
+int EventPoller::wait(PollEvent* events, int max_events, std::chrono::milliseconds timeout) {
+    if (max_events <= 0) {
+        return 0;
+    }
+    auto deadline = timeout.count() < 0 ? std::chrono::steady_clock::time_point::max()
+                                        : std::chrono::steady_clock::now() + timeout;
+    
+    while (true) {
+        int count = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            
+            // One pass over what is ready now; level-triggered entries that
+            // are still ready go to the back for the next wait()
+            size_t pending = ready_.size();
+            while (pending-- > 0 && count < max_events) {
+                auto registration = std::move(ready_.front());
+                ready_.pop_front();
+                registration->queued = false;
+                if (!registration->socket) {
+                    continue;
+                }
+                
+                uint32_t ready = registration->socket->poll_events() &
+                                 (registration->interest | ERROR);
+                if (ready == 0) {
+                    continue;
+                }
+                events[count++] = {ready, registration->data};
+                if (!(registration->interest & EDGE_TRIGGERED)) {
+                    enqueue(registration);
+                }
+            }
+            
+            if (ready_.empty()) {
+                notifier_.consume();
+            }
+        }
+        
+        auto now = std::chrono::steady_clock::now();
+        if (count > 0 || now >= deadline) {
+            return count;
+        }
+        auto remaining = deadline == std::chrono::steady_clock::time_point::max() ?
+            std::chrono::milliseconds(-1) :
+            std::chrono::ceil<std::chrono::milliseconds>(deadline - now);
+        notifier_.wait(remaining);
+        
+        // The notification is the ready list's; leave it set while the
+        // list is non-empty so a nesting epoll still sees the fd readable
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!ready_.empty()) {
+            notifier_.notify();
+        }
+    }
+}
+
+size_t EventPoller::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return registrations_.size();
+}
+
+void EventPoller::on_events(const std::shared_ptr<PollRegistration>& registration, uint32_t events) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (registration->socket && (events & (registration->interest | ERROR))) {
+        enqueue(registration);
+    }
+}
+
+void EventPoller::forget(const std::shared_ptr<PollRegistration>& registration) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (registration->socket) {
+        registrations_.erase(registration->socket);
+        registration->socket = nullptr;
+    }
+}
+
+void EventPoller::rebind(const std::shared_ptr<PollRegistration>& registration, TCPSocket& socket) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (registration->socket) {
+        registrations_.erase(registration->socket);
+        registration->socket = &socket;
+        registrations_[&socket] = registration;
+    }
+}
+
+void EventPoller::enqueue(const std::shared_ptr<PollRegistration>& registration) {
+    if (registration->queued) {
+        return;
+    }
+    registration->queued = true;
+    if (ready_.empty()) {
+        notifier_.notify();
+    }
+    ready_.push_back(registration);
+}
+
+} // namespace tcp_stack
\ No newline at end of file
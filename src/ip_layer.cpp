@@ -1,23 +1,35 @@
 #include "ip_layer.h"
 #include "network_utils.h"
+#include "logger.h"
 #include <arpa/inet.h>
+#include <poll.h>
 #include <cstring>
 #include <random>
-#include <iostream>
+#include <thread>
 
 namespace tcp_stack {
 
 IPLayer::IPLayer() : packet_id_(1) {
     raw_socket_ = std::make_unique<RawSocket>();
+    icmp_socket_ = std::make_unique<RawSocket>(IPPROTO_ICMP);
 }
 
 bool IPLayer::initialize() {
-    return raw_socket_->initialize();
+    if (!raw_socket_->initialize()) {
+        return false;
+    }
+    
+    // Path MTU discovery degrades to probing without ICMP
+    if (!icmp_socket_->initialize()) {
+        TCP_LOG_WARN("ICMP socket unavailable, relying on PLPMTUD");
+    }
+    return true;
 }
 
 std::vector<uint8_t> IPLayer::create_packet(uint32_t src_ip, uint32_t dst_ip, 
-                                           uint8_t protocol, const std::vector<uint8_t>& payload) {
-    IPHeader ip_header = create_ip_header(src_ip, dst_ip, protocol, payload.size());
+                                           uint8_t protocol, const std::vector<uint8_t>& payload,
+                                           uint8_t tos) {
+    IPHeader ip_header = create_ip_header(src_ip, dst_ip, protocol, payload.size(), tos);
     
     // Calculate and set checksum
     ip_header.checksum = 0;
@@ -63,7 +75,7 @@ bool IPLayer::parse_packet(const std::vector<uint8_t>& packet, IPHeader& ip_head
     
     // Validate checksum
     if (!validate_checksum(ip_header)) {
-        std::cerr << "IP header checksum validation failed" << std::endl;
+        TCP_LOG_DEBUG("IP header checksum validation failed");
         return false;
     }
     
@@ -80,15 +92,44 @@ bool IPLayer::parse_packet(const std::vector<uint8_t>& packet, IPHeader& ip_head
 }
 
 bool IPLayer::send_packet(uint32_t src_ip, uint32_t dst_ip, uint8_t protocol, 
-                         const std::vector<uint8_t>& payload) {
+                         const std::vector<uint8_t>& payload, uint8_t tos) {
     if (!raw_socket_->is_valid()) {
         return false;
     }
     
-    auto packet = create_packet(src_ip, dst_ip, protocol, payload);
+    auto packet = create_packet(src_ip, dst_ip, protocol, payload, tos);
     return raw_socket_->send_packet(packet, dst_ip);
 }
 
+size_t IPLayer::send_batch(uint32_t src_ip, uint32_t dst_ip, uint8_t protocol,
+                           std::vector<std::vector<uint8_t>>& packets, uint8_t tos) {
+    if (!raw_socket_->is_valid()) {
+        return 0;
+    }
+    
+    prepare_batch(src_ip, dst_ip, protocol, packets, tos);
+    return raw_socket_->send_packets(packets, dst_ip);
+}
+
+void IPLayer::prepare_batch(uint32_t src_ip, uint32_t dst_ip, uint8_t protocol,
+                            std::vector<std::vector<uint8_t>>& packets, uint8_t tos) {
+    IPHeader header = create_ip_header(src_ip, dst_ip, protocol, 0, tos);
+    header.total_length = 0;
+    header.identification = 0;
+    header.checksum = 0;
+    uint32_t base_sum = NetworkUtils::checksum_accumulate(&header, sizeof(header));
+    
+    for (auto& packet : packets) {
+        header.total_length = htons(static_cast<uint16_t>(packet.size()));
+        header.identification = htons(packet_id_.fetch_add(1, std::memory_order_relaxed));
+        
+        uint32_t sum = NetworkUtils::checksum_accumulate(&header.total_length, 4, base_sum);
+        header.checksum = htons(NetworkUtils::checksum_finish(sum));
+        std::memcpy(packet.data(), &header, sizeof(header));
+        header.checksum = 0;
+    }
+}
+
 bool IPLayer::receive_packet(IPHeader& ip_header, std::vector<uint8_t>& payload) {
     if (!raw_socket_->is_valid()) {
         return false;
@@ -104,6 +145,43 @@ bool IPLayer::receive_packet(IPHeader& ip_header, std::vector<uint8_t>& payload)
     return parse_packet(packet, ip_header, payload);
 }
 
+bool IPLayer::receive_icmp(IPHeader& ip_header, std::vector<uint8_t>& payload) {
+    if (!icmp_socket_->is_valid()) {
+        return false;
+    }
+    
+    std::vector<uint8_t> packet;
+    uint32_t src_ip;
+    
+    if (!icmp_socket_->receive_packet(packet, src_ip)) {
+        return false;
+    }
+    
+    return parse_packet(packet, ip_header, payload) && ip_header.protocol == IPPROTO_ICMP;
+}
+
+bool IPLayer::wait_for_packets(std::chrono::microseconds timeout) {
+    pollfd fds[2];
+    nfds_t count = 0;
+    for (const auto* socket : {raw_socket_.get(), icmp_socket_.get()}) {
+        if (socket->is_valid()) {
+            fds[count++] = {socket->get_fd(), POLLIN, 0};
+        }
+    }
+    
+    // No link to wait on: just let the time pass
+    if (count == 0) {
+        std::this_thread::sleep_for(timeout);
+        return false;
+    }
+    
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    timespec ts;
+    ts.tv_sec = seconds.count();
+    ts.tv_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout - seconds).count();
+    return ppoll(fds, count, &ts, nullptr) > 0;
+}
+
 bool IPLayer::validate_checksum(const IPHeader& header) {
     IPHeader temp_header = header;
     temp_header.checksum = 0;
@@ -117,15 +195,15 @@ uint16_t IPLayer::calculate_checksum(const IPHeader& header) {
 }
 
 IPHeader IPLayer::create_ip_header(uint32_t src_ip, uint32_t dst_ip, 
-                                  uint8_t protocol, uint16_t payload_length) {
+                                  uint8_t protocol, uint16_t payload_length, uint8_t tos) {
     IPHeader header;
     std::memset(&header, 0, sizeof(header));
     
     header.set_version(4);                    // IPv4
     header.set_ihl(5);                        // 20 bytes (no options)
-    header.tos = 0;                           // Default type of service
+    header.tos = tos;                         // DSCP and ECN codepoint
     header.total_length = htons(sizeof(IPHeader) + payload_length);
-    header.identification = htons(packet_id_++);
+    header.identification = htons(packet_id_.fetch_add(1, std::memory_order_relaxed));
     header.set_flags_fragment(0x2, 0);        // Don't Fragment flag set
     header.ttl = 64;                          // Default TTL
     header.protocol = protocol;
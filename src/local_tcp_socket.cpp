@@ -1,5 +1,5 @@
 #include "local_tcp_socket.h"
-#include <iostream>
+#include "logger.h"
 #include <cstring>
 #include <fcntl.h>
 #include <errno.h>
@@ -60,38 +60,38 @@ bool LocalTCPSocket::bind(const std::string& ip_address, uint16_t port) {
     local_addr_.sin_port = htons(port);
     
     if (inet_aton(ip_address.c_str(), &local_addr_.sin_addr) == 0) {
-        std::cerr << "Invalid IP address: " << ip_address << std::endl;
+        TCP_LOG_WARN("Invalid IP address", "ip", ip_address);
         return false;
     }
     
     // Enable address reuse
     int reuse = 1;
     if (setsockopt(socket_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) < 0) {
-        std::cerr << "Failed to set SO_REUSEADDR: " << strerror(errno) << std::endl;
+        TCP_LOG_WARN("Failed to set SO_REUSEADDR", "error", strerror(errno));
     }
     
     if (::bind(socket_fd_, reinterpret_cast<sockaddr*>(&local_addr_), sizeof(local_addr_)) < 0) {
-        std::cerr << "Bind failed: " << strerror(errno) << std::endl;
+        TCP_LOG_ERROR("Bind failed", "error", strerror(errno));
         return false;
     }
     
-    std::cout << "LocalTCPSocket bound to " << ip_address << ":" << port << std::endl;
+    TCP_LOG_INFO("LocalTCPSocket bound", "ip", ip_address, "port", port);
     return true;
 }
 
 bool LocalTCPSocket::listen(int backlog) {
     if (socket_fd_ == -1) {
-        std::cerr << "Socket not created" << std::endl;
+        TCP_LOG_WARN("Socket not created");
         return false;
     }
     
     if (::listen(socket_fd_, backlog) < 0) {
-        std::cerr << "Listen failed: " << strerror(errno) << std::endl;
+        TCP_LOG_ERROR("Listen failed", "error", strerror(errno));
         return false;
     }
     
     is_listening_ = true;
-    std::cout << "LocalTCPSocket listening with backlog " << backlog << std::endl;
+    TCP_LOG_INFO("LocalTCPSocket listening", "backlog", backlog);
     return true;
 }
 
@@ -106,13 +106,13 @@ std::unique_ptr<LocalTCPSocket> LocalTCPSocket::accept() {
     int client_fd = ::accept(socket_fd_, reinterpret_cast<sockaddr*>(&client_addr), &client_len);
     if (client_fd < 0) {
         if (errno != EAGAIN && errno != EWOULDBLOCK) {
-            std::cerr << "Accept failed: " << strerror(errno) << std::endl;
+            TCP_LOG_ERROR("Accept failed", "error", strerror(errno));
         }
         return nullptr;
     }
     
-    std::cout << "LocalTCPSocket accepted connection from " 
-              << inet_ntoa(client_addr.sin_addr) << ":" << ntohs(client_addr.sin_port) << std::endl;
+    TCP_LOG_INFO("LocalTCPSocket accepted connection", "ip", inet_ntoa(client_addr.sin_addr),
+                 "port", ntohs(client_addr.sin_port));
     
     return std::unique_ptr<LocalTCPSocket>(new LocalTCPSocket(client_fd, client_addr));
 }
@@ -126,12 +126,12 @@ bool LocalTCPSocket::connect(const std::string& ip_address, uint16_t port) {
     remote_addr_.sin_port = htons(port);
     
     if (inet_aton(ip_address.c_str(), &remote_addr_.sin_addr) == 0) {
-        std::cerr << "Invalid IP address: " << ip_address << std::endl;
+        TCP_LOG_WARN("Invalid IP address", "ip", ip_address);
         return false;
     }
     
     if (::connect(socket_fd_, reinterpret_cast<sockaddr*>(&remote_addr_), sizeof(remote_addr_)) < 0) {
-        std::cerr << "Connect failed: " << strerror(errno) << std::endl;
+        TCP_LOG_ERROR("Connect failed", "error", strerror(errno));
         return false;
     }
     
@@ -141,7 +141,53 @@ bool LocalTCPSocket::connect(const std::string& ip_address, uint16_t port) {
     socklen_t addr_len = sizeof(local_addr_);
     getsockname(socket_fd_, reinterpret_cast<sockaddr*>(&local_addr_), &addr_len);
     
-    std::cout << "LocalTCPSocket connected to " << ip_address << ":" << port << std::endl;
+    TCP_LOG_INFO("LocalTCPSocket connected", "ip", ip_address, "port", port);
+    return true;
+}
+
+bool LocalTCPSocket::start_connect(const std::string& ip_address, uint16_t port) {
+    if (!create_socket() || !set_blocking(false)) {
+        return false;
+    }
+    
+    remote_addr_.sin_family = AF_INET;
+    remote_addr_.sin_port = htons(port);
+    
+    if (inet_aton(ip_address.c_str(), &remote_addr_.sin_addr) == 0) {
+        TCP_LOG_WARN("Invalid IP address", "ip", ip_address);
+        return false;
+    }
+    
+    if (::connect(socket_fd_, reinterpret_cast<sockaddr*>(&remote_addr_), sizeof(remote_addr_)) < 0) {
+        if (errno != EINPROGRESS) {
+            TCP_LOG_ERROR("Connect failed", "error", strerror(errno));
+            return false;
+        }
+        return true;
+    }
+    
+    return finish_connect();
+}
+
+bool LocalTCPSocket::finish_connect() {
+    if (socket_fd_ == -1) {
+        return false;
+    }
+    
+    int error = 0;
+    socklen_t error_len = sizeof(error);
+    if (getsockopt(socket_fd_, SOL_SOCKET, SO_ERROR, &error, &error_len) < 0 || error != 0) {
+        TCP_LOG_ERROR("Connect failed", "error", strerror(error ? error : errno));
+        return false;
+    }
+    
+    is_connected_ = true;
+    
+    socklen_t addr_len = sizeof(local_addr_);
+    getsockname(socket_fd_, reinterpret_cast<sockaddr*>(&local_addr_), &addr_len);
+    
+    TCP_LOG_INFO("LocalTCPSocket connected", "ip", sockaddr_to_string(remote_addr_),
+                 "port", get_port_from_sockaddr(remote_addr_));
     return true;
 }
 
@@ -151,8 +197,8 @@ ssize_t LocalTCPSocket::send(const void* data, size_t length) {
     }
     
     ssize_t bytes_sent = ::send(socket_fd_, data, length, MSG_NOSIGNAL);
-    if (bytes_sent < 0) {
-        std::cerr << "Send failed: " << strerror(errno) << std::endl;
+    if (bytes_sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+        TCP_LOG_ERROR("Send failed", "error", strerror(errno));
     }
     
     return bytes_sent;
@@ -166,7 +212,7 @@ ssize_t LocalTCPSocket::recv(void* buffer, size_t length) {
     ssize_t bytes_received = ::recv(socket_fd_, buffer, length, 0);
     if (bytes_received < 0) {
         if (errno != EAGAIN && errno != EWOULDBLOCK) {
-            std::cerr << "Receive failed: " << strerror(errno) << std::endl;
+            TCP_LOG_ERROR("Receive failed", "error", strerror(errno));
         }
     } else if (bytes_received == 0) {
         // Connection closed by peer
@@ -240,7 +286,7 @@ uint16_t LocalTCPSocket::get_remote_port() const {
 bool LocalTCPSocket::create_socket() {
     socket_fd_ = socket(AF_INET, SOCK_STREAM, 0);
     if (socket_fd_ < 0) {
-        std::cerr << "Failed to create socket: " << strerror(errno) << std::endl;
+        TCP_LOG_ERROR("Failed to create socket", "error", strerror(errno));
         return false;
     }
     return true;
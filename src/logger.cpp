@@ -0,0 +1,337 @@
+#include "logger.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+namespace tcp_stack {
+
+namespace detail {
+
+LogRecordWriter::LogRecordWriter(LogLevel level, const char* message) : size_(sizeof(Header)) {
+    Header header{};
+    header.level = level;
+    header.timestamp_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    header.message = message;
+    std::memcpy(data_, &header, sizeof(header));
+}
+
+const uint8_t* LogRecordWriter::data() {
+    Header header;
+    std::memcpy(&header, data_, sizeof(header));
+    header.size = static_cast<uint16_t>(size_);
+    header.field_count = field_count_;
+    std::memcpy(data_, &header, sizeof(header));
+    return data_;
+}
+
+bool LogRecordWriter::begin_field(const char* name, Tag tag, size_t payload) {
+    // Fields that don't fit are left off rather than splitting the record
+    if (size_ + sizeof(name) + 1 + payload > MAX_SIZE || field_count_ == UINT8_MAX) {
+        return false;
+    }
+    std::memcpy(data_ + size_, &name, sizeof(name));
+    data_[size_ + sizeof(name)] = tag;
+    size_ += sizeof(name) + 1;
+    ++field_count_;
+    return true;
+}
+
+void LogRecordWriter::put_number(const char* name, Tag tag, uint64_t value) {
+    if (begin_field(name, tag, sizeof(value))) {
+        std::memcpy(data_ + size_, &value, sizeof(value));
+        size_ += sizeof(value);
+    }
+}
+
+void LogRecordWriter::put_double(const char* name, double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    put_number(name, DOUBLE, bits);
+}
+
+void LogRecordWriter::put_string(const char* name, std::string_view value) {
+    size_t room = MAX_SIZE - std::min(MAX_SIZE, size_ + sizeof(name) + 1 + sizeof(uint16_t));
+    uint16_t length = static_cast<uint16_t>(std::min({value.size(), MAX_STRING, room}));
+    if (begin_field(name, STRING, sizeof(length) + length)) {
+        std::memcpy(data_ + size_, &length, sizeof(length));
+        std::memcpy(data_ + size_ + sizeof(length), value.data(), length);
+        size_ += sizeof(length) + length;
+    }
+}
+
+} // namespace detail
+
+namespace {
+
+// Marks the thread's ring retired when the thread exits; the background
+// thread frees it once drained. The logger is never destroyed.
+struct ThreadBufferHolder {
+    void* buffer = nullptr;
+    std::atomic<bool>* retired = nullptr;
+    ~ThreadBufferHolder() {
+        if (retired) {
+            buffer = nullptr;
+            retired->store(true, std::memory_order_release);
+        }
+    }
+};
+
+thread_local ThreadBufferHolder buffer_holder;
+
+void write_stderr(std::string_view text) {
+    std::fwrite(text.data(), 1, text.size(), stderr);
+    std::fflush(stderr);
+}
+
+void append_quoted(std::string& out, std::string_view value) {
+    out += '"';
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+} // namespace
+
+Logger& Logger::instance() {
+    // Leaked on purpose: threads may log while statics are torn down
+    static Logger* logger = [] {
+        auto* created = new Logger();
+        std::atexit([] { instance().shutdown(); });
+        return created;
+    }();
+    return *logger;
+}
+
+Logger::Logger() : thread_([this]() { run(); }) {}
+
+std::string_view Logger::level_name(LogLevel level) {
+    switch (level) {
+        case LogLevel::LEVEL_TRACE: return "TRACE";
+        case LogLevel::LEVEL_DEBUG: return "DEBUG";
+        case LogLevel::LEVEL_INFO:  return "INFO";
+        case LogLevel::LEVEL_WARN:  return "WARN";
+        case LogLevel::LEVEL_ERROR: return "ERROR";
+        default:                    return "OFF";
+    }
+}
+
+void Logger::commit(detail::LogRecordWriter& record) {
+    ThreadBuffer* buffer = thread_buffer();
+    const uint8_t* data = record.data();
+    
+    // Whole records only: the drainer never sees half of one
+    if (buffer->ring.free_space() < record.size()) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer->ring.write(data, record.size());
+}
+
+Logger::ThreadBuffer* Logger::thread_buffer() {
+    if (!buffer_holder.buffer) {
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        buffers_.push_back(std::make_unique<ThreadBuffer>(next_thread_id_++));
+        ThreadBuffer* buffer = buffers_.back().get();
+        buffer_holder.buffer = buffer;
+        buffer_holder.retired = &buffer->retired;
+    }
+    return static_cast<ThreadBuffer*>(buffer_holder.buffer);
+}
+
+void Logger::set_sink(Sink sink) {
+    std::lock_guard<std::mutex> lock(drain_mutex_);
+    sink_ = std::move(sink);
+}
+
+void Logger::flush() {
+    drain();
+}
+
+void Logger::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    drain();
+}
+
+LoggerStats Logger::get_stats() const {
+    LoggerStats stats;
+    {
+        std::lock_guard<std::mutex> lock(drain_mutex_);
+        stats.records_written = records_written_;
+        stats.records_dropped = records_dropped_;
+    }
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    stats.thread_buffers = buffers_.size();
+    for (const auto& buffer : buffers_) {
+        stats.records_dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+void Logger::run() {
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    while (!stopping_) {
+        wake_.wait_for(lock, FLUSH_INTERVAL);
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+}
+
+void Logger::drain() {
+    std::lock_guard<std::mutex> drain_lock(drain_mutex_);
+    
+    // Registration may add buffers meanwhile; only drain_mutex_ holders
+    // remove them, so the snapshot stays valid
+    std::vector<ThreadBuffer*> buffers;
+    {
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        buffers.reserve(buffers_.size());
+        for (const auto& buffer : buffers_) {
+            buffers.push_back(buffer.get());
+        }
+    }
+    
+    struct Pending {
+        uint64_t timestamp_ns;
+        size_t offset;
+        uint32_t thread_id;
+    };
+    std::vector<Pending> pending;
+    std::vector<ThreadBuffer*> finished;
+    scratch_.clear();
+    text_.clear();
+    
+    for (ThreadBuffer* buffer : buffers) {
+        // Retired before draining: nothing can follow what we read now
+        bool retired = buffer->retired.load(std::memory_order_acquire);
+        size_t start = scratch_.size();
+        size_t available = buffer->ring.size();
+        scratch_.resize(start + available);
+        size_t read = buffer->ring.read(scratch_.data() + start, available);
+        scratch_.resize(start + read);
+        
+        for (size_t offset = start; offset < scratch_.size();) {
+            detail::LogRecordWriter::Header header;
+            std::memcpy(&header, scratch_.data() + offset, sizeof(header));
+            pending.push_back({header.timestamp_ns, offset, buffer->id});
+            offset += header.size;
+        }
+        
+        uint64_t dropped = buffer->dropped.exchange(0, std::memory_order_relaxed);
+        if (dropped > 0) {
+            records_dropped_ += dropped;
+            text_ += "Log records dropped thread=";
+            text_ += std::to_string(buffer->id);
+            text_ += " count=";
+            text_ += std::to_string(dropped);
+            text_ += '\n';
+        }
+        if (retired) {
+            finished.push_back(buffer);
+        }
+    }
+    
+    // Each ring is in order already; this interleaves the threads
+    std::stable_sort(pending.begin(), pending.end(),
+                     [](const Pending& a, const Pending& b) { return a.timestamp_ns < b.timestamp_ns; });
+    for (const Pending& record : pending) {
+        format(scratch_.data() + record.offset, record.thread_id);
+    }
+    records_written_ += pending.size();
+    
+    if (!text_.empty()) {
+        if (sink_) {
+            sink_(text_);
+        } else {
+            write_stderr(text_);
+        }
+    }
+    
+    if (!finished.empty()) {
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        buffers_.erase(std::remove_if(buffers_.begin(), buffers_.end(),
+                                      [&finished](const std::unique_ptr<ThreadBuffer>& buffer) {
+                                          return std::find(finished.begin(), finished.end(),
+                                                           buffer.get()) != finished.end();
+                                      }),
+                       buffers_.end());
+    }
+}
+
+void Logger::format(const uint8_t* record, uint32_t thread_id) {
+    using Writer = detail::LogRecordWriter;
+    
+    Writer::Header header;
+    std::memcpy(&header, record, sizeof(header));
+    
+    time_t seconds = static_cast<time_t>(header.timestamp_ns / 1000000000);
+    tm utc;
+    gmtime_r(&seconds, &utc);
+    char prefix[64];
+    size_t length = std::strftime(prefix, sizeof(prefix), "%Y-%m-%dT%H:%M:%S", &utc);
+    std::snprintf(prefix + length, sizeof(prefix) - length, ".%06uZ %-5s [%u] ",
+                  static_cast<unsigned>(header.timestamp_ns / 1000 % 1000000),
+                  level_name(header.level).data(), thread_id);
+    text_ += prefix;
+    text_ += header.message;
+    
+    const uint8_t* field = record + sizeof(header);
+    for (uint8_t i = 0; i < header.field_count; ++i) {
+        const char* name;
+        std::memcpy(&name, field, sizeof(name));
+        uint8_t tag = field[sizeof(name)];
+        field += sizeof(name) + 1;
+        
+        text_ += ' ';
+        text_ += name;
+        text_ += '=';
+        if (tag == Writer::STRING) {
+            uint16_t size;
+            std::memcpy(&size, field, sizeof(size));
+            append_quoted(text_, std::string_view(reinterpret_cast<const char*>(field + sizeof(size)), size));
+            field += sizeof(size) + size;
+            continue;
+        }
+        
+        uint64_t bits;
+        std::memcpy(&bits, field, sizeof(bits));
+        field += sizeof(bits);
+        if (tag == Writer::BOOL) {
+            text_ += bits ? "true" : "false";
+        } else if (tag == Writer::INT) {
+            text_ += std::to_string(static_cast<int64_t>(bits));
+        } else if (tag == Writer::UINT) {
+            text_ += std::to_string(bits);
+        } else {
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            char number[32];
+            std::snprintf(number, sizeof(number), "%g", value);
+            text_ += number;
+        }
+    }
+    text_ += '\n';
+}
+
+} // namespace tcp_stack
\ No newline at end of file
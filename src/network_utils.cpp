@@ -1,20 +1,19 @@
 #include "network_utils.h"
+#include "siphash.h"
 #include <arpa/inet.h>
-#include <random>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstring>
 #include <chrono>
 
 namespace tcp_stack {
 
 uint16_t NetworkUtils::calculate_checksum(const void* data, size_t length) {
-    uint32_t sum = checksum_accumulate(data, length);
-    
-    // Add carry
-    while (sum >> 16) {
-        sum = (sum & 0xFFFF) + (sum >> 16);
-    }
-    
-    // One's complement
-    return static_cast<uint16_t>(~sum);
+    return checksum_finish(checksum_accumulate(data, length));
 }
 
 uint16_t NetworkUtils::calculate_checksum(const std::vector<std::pair<const void*, size_t>>& segments) {
@@ -24,6 +23,10 @@ uint16_t NetworkUtils::calculate_checksum(const std::vector<std::pair<const void
         sum = checksum_accumulate(segment.first, segment.second, sum);
     }
     
+    return checksum_finish(sum);
+}
+
+uint16_t NetworkUtils::checksum_finish(uint32_t sum) {
     // Add carry
     while (sum >> 16) {
         sum = (sum & 0xFFFF) + (sum >> 16);
@@ -47,11 +50,50 @@ std::string NetworkUtils::ip_network_to_string(uint32_t ip_addr) {
     return std::string(inet_ntoa(addr));
 }
 
-uint32_t NetworkUtils::generate_sequence_number() {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<uint32_t> dis(0, UINT32_MAX);
-    return dis(gen);
+uint32_t NetworkUtils::generate_sequence_number(uint32_t local_ip, uint16_t local_port,
+                                                uint32_t remote_ip, uint16_t remote_port) {
+    // The secret is drawn once; after that this is a pure function of the
+    // tuple and the clock
+    static const SipHashKey secret = SipHashKey::random();
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    uint32_t ticks = static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(now).count() / 4);
+    return ticks + static_cast<uint32_t>(
+        siphash24_tuple(secret, local_ip, local_port, remote_ip, remote_port));
+}
+
+uint32_t NetworkUtils::get_interface_mtu(uint32_t local_ip) {
+    struct ifaddrs* addrs = nullptr;
+    if (getifaddrs(&addrs) == -1) {
+        return 0;
+    }
+    
+    std::string name;
+    for (struct ifaddrs* ifa = addrs; ifa; ifa = ifa->ifa_next) {
+        if (ifa->ifa_addr && ifa->ifa_addr->sa_family == AF_INET &&
+            reinterpret_cast<struct sockaddr_in*>(ifa->ifa_addr)->sin_addr.s_addr == local_ip) {
+            name = ifa->ifa_name;
+            break;
+        }
+    }
+    freeifaddrs(addrs);
+    
+    if (name.empty() || name.size() >= IFNAMSIZ) {
+        return 0;
+    }
+    
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd == -1) {
+        return 0;
+    }
+    
+    struct ifreq request;
+    std::memset(&request, 0, sizeof(request));
+    std::memcpy(request.ifr_name, name.c_str(), name.size());
+    int result = ioctl(fd, SIOCGIFMTU, &request);
+    close(fd);
+    
+    return result == -1 ? 0 : static_cast<uint32_t>(request.ifr_mtu);
 }
 
 uint32_t NetworkUtils::checksum_accumulate(const void* data, size_t length, uint32_t sum) {
@@ -0,0 +1,177 @@
+#include "numa_utils.h"
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sched.h>
+#include <unistd.h>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+
+namespace tcp_stack {
+
+namespace {
+
+const char* const NODE_DIR = "/sys/devices/system/node/";
+
+// Parse a sysfs CPU or node list such as "0-3,8,10-11"
+std::vector<int> parse_list(const std::string& text) {
+    std::vector<int> values;
+    std::stringstream ranges(text);
+    std::string range;
+    while (std::getline(ranges, range, ',')) {
+        if (range.empty()) {
+            continue;
+        }
+        int first = 0, last = 0;
+        size_t dash = range.find('-');
+        try {
+            first = std::stoi(range.substr(0, dash));
+            last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        } catch (const std::exception&) {
+            continue;
+        }
+        for (int value = first; value <= last; ++value) {
+            values.push_back(value);
+        }
+    }
+    return values;
+}
+
+std::string read_line(const std::string& path) {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+// One bit per node, as mbind() and set_mempolicy() take it
+struct NodeMask {
+    static constexpr unsigned long BITS = 8 * sizeof(unsigned long);
+    unsigned long words[16] = {};
+    
+    explicit NodeMask(int node) {
+        words[node / BITS] = 1UL << (node % BITS);
+    }
+    static constexpr unsigned long max_node() { return 16 * BITS; }
+};
+
+bool valid_node(int node) {
+    return node >= 0 && static_cast<unsigned long>(node) < NodeMask::max_node();
+}
+
+} // namespace
+
+int NumaUtils::node_count() {
+    return static_cast<int>(parse_list(read_line(std::string(NODE_DIR) + "online")).size());
+}
+
+std::vector<int> NumaUtils::node_cpus(int node) {
+    if (node < 0) {
+        return {};
+    }
+    return parse_list(read_line(std::string(NODE_DIR) + "node" + std::to_string(node) + "/cpulist"));
+}
+
+int NumaUtils::cpu_node(int cpu) {
+    for (int node : parse_list(read_line(std::string(NODE_DIR) + "online"))) {
+        for (int member : node_cpus(node)) {
+            if (member == cpu) {
+                return node;
+            }
+        }
+    }
+    return -1;
+}
+
+bool NumaUtils::current_location(int& cpu, int& node) {
+    unsigned int current_cpu = 0, current_node = 0;
+    if (syscall(SYS_getcpu, &current_cpu, &current_node, nullptr) != 0) {
+        return false;
+    }
+    cpu = static_cast<int>(current_cpu);
+    node = static_cast<int>(current_node);
+    return true;
+}
+
+bool NumaUtils::pin_thread(pthread_t thread, const std::vector<int>& cpus) {
+    if (cpus.empty()) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu < 0 || cpu >= CPU_SETSIZE) {
+            return false;
+        }
+        CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+}
+
+bool NumaUtils::prefer_node(int node) {
+    if (node < 0) {
+        return syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0) == 0;
+    }
+    if (!valid_node(node)) {
+        return false;
+    }
+    NodeMask mask(node);
+    return syscall(SYS_set_mempolicy, MPOL_PREFERRED, mask.words, NodeMask::max_node()) == 0;
+}
+
+bool NumaUtils::save_policy(MemoryPolicy& policy) {
+    static_assert(sizeof(policy.nodes) == sizeof(NodeMask::words), "policy mask must match NodeMask");
+    return syscall(SYS_get_mempolicy, &policy.mode, policy.nodes, NodeMask::max_node(), nullptr, 0) == 0;
+}
+
+bool NumaUtils::restore_policy(const MemoryPolicy& policy) {
+    return syscall(SYS_set_mempolicy, policy.mode, policy.nodes, NodeMask::max_node()) == 0;
+}
+
+bool NumaUtils::bind_memory(void* address, size_t length, int node) {
+    if (!valid_node(node)) {
+        return false;
+    }
+    NodeMask mask(node);
+    return syscall(SYS_mbind, address, length, MPOL_BIND, mask.words, NodeMask::max_node(),
+                   MPOL_MF_MOVE) == 0;
+}
+
+NodeMemory::NodeMemory(size_t bytes, int node, bool huge_pages)
+    : data_(MAP_FAILED), length_(0), bound_(false), huge_(false) {
+    if (huge_pages) {
+        length_ = (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+        data_ = mmap(nullptr, length_, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        huge_ = data_ != MAP_FAILED;
+    }
+    if (data_ == MAP_FAILED) {
+        long page = sysconf(_SC_PAGESIZE);
+        length_ = (bytes + page - 1) & ~static_cast<size_t>(page - 1);
+        data_ = mmap(nullptr, length_, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (data_ == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        if (huge_pages) {
+            madvise(data_, length_, MADV_HUGEPAGE);
+        }
+    }
+    
+    // Bind before the first touch, then fault everything in on the node
+    if (node >= 0) {
+        bound_ = NumaUtils::bind_memory(data_, length_, node);
+    }
+    std::memset(data_, 0, length_);
+}
+
+NodeMemory::~NodeMemory() {
+    if (data_ != MAP_FAILED) {
+        munmap(data_, length_);
+    }
+}
+
+} // namespace tcp_stack
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "pacing_scheduler.h"
+#include <algorithm>
+
+namespace tcp_stack {
+
+PacingScheduler::PacingScheduler(Clock::time_point origin)
+    : slots_(NUM_SLOTS), origin_(origin), current_tick_(0), scheduled_(0) {}
+
+uint64_t PacingScheduler::tick_of(Clock::time_point time, bool round_up) const {
+    if (time <= origin_) {
+        return 0;
+    }
+    auto elapsed = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(time - origin_).count());
+    uint64_t slot_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(SLOT_WIDTH).count();
+    uint64_t tick = elapsed / slot_ns;
+    if (round_up && elapsed % slot_ns != 0) {
+        tick++;
+    }
+    return tick;
+}
+
+void PacingScheduler::schedule(const std::shared_ptr<TCPConnection>& conn, Clock::time_point when) {
+    // Rounding up means a connection never fires before its time
+    uint64_t tick = std::max(tick_of(when, true), current_tick_);
+    tick = std::min<uint64_t>(tick, current_tick_ + NUM_SLOTS - 1);
+    slots_[tick % NUM_SLOTS].push_back(conn);
+    scheduled_++;
+}
+
+std::vector<std::shared_ptr<TCPConnection>> PacingScheduler::advance(Clock::time_point now) {
+    std::vector<std::shared_ptr<TCPConnection>> due;
+    uint64_t now_tick = tick_of(now, false);
+    
+    // One lap covers every slot; going further would only revisit them
+    uint64_t end_tick = std::min<uint64_t>(now_tick + 1, current_tick_ + NUM_SLOTS);
+    for (; current_tick_ < end_tick && scheduled_ > 0; ++current_tick_) {
+        auto& slot = slots_[current_tick_ % NUM_SLOTS];
+        scheduled_ -= slot.size();
+        for (auto& entry : slot) {
+            if (auto conn = entry.lock()) {
+                due.push_back(std::move(conn));
+            }
+        }
+        slot.clear();
+    }
+    current_tick_ = std::max(current_tick_, now_tick + 1);
+    
+    return due;
+}
+
+PacingScheduler::Clock::time_point PacingScheduler::next_deadline() const {
+    if (scheduled_ == 0) {
+        return Clock::time_point::max();
+    }
+    for (uint64_t tick = current_tick_; tick < current_tick_ + NUM_SLOTS; ++tick) {
+        if (!slots_[tick % NUM_SLOTS].empty()) {
+            return origin_ + std::chrono::microseconds(tick * SLOT_WIDTH.count());
+        }
+    }
+    return Clock::time_point::max();
+}
+
+} // namespace tcp_stack
\ No newline at end of file
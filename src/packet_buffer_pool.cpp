@@ -0,0 +1,41 @@
+#include "packet_buffer_pool.h"
+#include <algorithm>
+#include <utility>
+
+namespace tcp_stack {
+
+PacketBufferPool::PacketBufferPool(size_t max_cached) : max_cached_(max_cached) {
+    free_.reserve(max_cached_);
+}
+
+std::vector<uint8_t> PacketBufferPool::acquire(size_t size) {
+    if (free_.empty()) {
+        return std::vector<uint8_t>(size);
+    }
+    
+    std::vector<uint8_t> buffer = std::move(free_.back());
+    free_.pop_back();
+    buffer.resize(size);
+    return buffer;
+}
+
+void PacketBufferPool::reserve(size_t count, size_t size) {
+    while (free_.size() < std::min(count, max_cached_)) {
+        free_.emplace_back(size);
+    }
+}
+
+void PacketBufferPool::release(std::vector<uint8_t>&& buffer) {
+    if (free_.size() < max_cached_) {
+        free_.push_back(std::move(buffer));
+    }
+}
+
+void PacketBufferPool::release(std::vector<std::vector<uint8_t>>& buffers) {
+    for (auto& buffer : buffers) {
+        release(std::move(buffer));
+    }
+    buffers.clear();
+}
+
+} // namespace tcp_stack
\ No newline at end of file
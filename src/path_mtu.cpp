@@ -0,0 +1,122 @@
+#include "path_mtu.h"
+#include <algorithm>
+#include <iterator>
+
+namespace tcp_stack {
+
+namespace {
+
+// RFC 1191 section 7 plateau table, for routers that leave the
+// next-hop MTU field zero
+constexpr uint32_t MTU_PLATEAUS[] = {
+    65535, 32000, 17914, 8166, 4352, 2002, 1492, 1006, 508, 296, 68
+};
+
+uint32_t plateau_below(uint32_t packet_size) {
+    for (uint32_t plateau : MTU_PLATEAUS) {
+        if (plateau < packet_size) {
+            return plateau;
+        }
+    }
+    return MTU_PLATEAUS[std::size(MTU_PLATEAUS) - 1];
+}
+
+} // namespace
+
+PathMTU::PathMTU() {
+    reset(DEFAULT_LINK_MTU, false);
+}
+
+void PathMTU::reset(uint32_t link_mtu, bool probing_allowed) {
+    link_mtu_ = std::max(link_mtu, MIN_MTU);
+    mtu_ = link_mtu_;
+    search_high_ = link_mtu_;
+    probing_allowed_ = probing_allowed;
+    probing_ = false;
+    probe_mtu_ = 0;
+    probe_seq_ = 0;
+    probe_end_seq_ = 0;
+    next_probe_time_ = std::chrono::steady_clock::time_point::min();
+}
+
+bool PathMTU::on_packet_too_big(uint32_t next_hop_mtu, uint32_t packet_size) {
+    uint32_t reported = next_hop_mtu != 0 ? next_hop_mtu : plateau_below(packet_size);
+    reported = std::max(reported, MIN_MTU);
+    
+    if (reported >= mtu_) {
+        return false;
+    }
+    
+    mtu_ = reported;
+    search_high_ = reported;
+    probe_mtu_ = 0;
+    return true;
+}
+
+bool PathMTU::on_black_hole() {
+    if (!probing_allowed_ || mtu_ <= BASE_MTU) {
+        return false;
+    }
+    
+    // Everything above the base is suspect until a probe proves otherwise
+    search_high_ = mtu_ - 1;
+    mtu_ = BASE_MTU;
+    probing_ = true;
+    probe_mtu_ = 0;
+    next_probe_time_ = std::chrono::steady_clock::time_point::min();
+    return true;
+}
+
+bool PathMTU::should_probe(std::chrono::steady_clock::time_point now) {
+    if (!probing_ || probe_mtu_ != 0 || now < next_probe_time_) {
+        return false;
+    }
+    
+    // Converged: periodically check whether the path has grown back
+    if (search_high_ - mtu_ < PROBE_GRANULARITY) {
+        if (search_high_ >= link_mtu_) {
+            return false;
+        }
+        search_high_ = link_mtu_;
+    }
+    return true;
+}
+
+uint32_t PathMTU::next_probe_size() const {
+    return mtu_ + (search_high_ - mtu_ + 1) / 2;
+}
+
+void PathMTU::on_probe_sent(uint32_t seq, uint32_t end_seq, uint32_t probe_mtu) {
+    probe_mtu_ = probe_mtu;
+    probe_seq_ = seq;
+    probe_end_seq_ = end_seq;
+}
+
+bool PathMTU::on_ack(uint32_t ack_num) {
+    if (probe_mtu_ == 0 || !seq_geq(ack_num, probe_end_seq_)) {
+        return false;
+    }
+    
+    mtu_ = std::max(mtu_, probe_mtu_);
+    probe_mtu_ = 0;
+    finish_search_if_converged();
+    return true;
+}
+
+void PathMTU::on_probe_lost() {
+    if (probe_mtu_ == 0) {
+        return;
+    }
+    
+    search_high_ = probe_mtu_ - 1;
+    probe_mtu_ = 0;
+    finish_search_if_converged();
+}
+
+void PathMTU::finish_search_if_converged() {
+    if (search_high_ - mtu_ < PROBE_GRANULARITY) {
+        next_probe_time_ = std::chrono::steady_clock::now() + REPROBE_INTERVAL;
+    }
+}
+
+} // namespace tcp_stack
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "raw_socket.h"
+#include "logger.h"
 #include <sys/socket.h>
 #include <netinet/ip.h>
 #include <arpa/inet.h>
@@ -6,18 +7,17 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <cstring>
-#include <iostream>
 
 namespace tcp_stack {
 
-RawSocket::RawSocket() : socket_fd_(-1), initialized_(false) {}
+RawSocket::RawSocket(int protocol) : socket_fd_(-1), protocol_(protocol), initialized_(false) {}
 
 RawSocket::~RawSocket() {
     close();
 }
 
 RawSocket::RawSocket(RawSocket&& other) noexcept
-    : socket_fd_(other.socket_fd_), initialized_(other.initialized_) {
+    : socket_fd_(other.socket_fd_), protocol_(other.protocol_), initialized_(other.initialized_) {
     other.socket_fd_ = -1;
     other.initialized_ = false;
 }
@@ -26,6 +26,7 @@ RawSocket& RawSocket::operator=(RawSocket&& other) noexcept {
     if (this != &other) {
         close();
         socket_fd_ = other.socket_fd_;
+        protocol_ = other.protocol_;
         initialized_ = other.initialized_;
         other.socket_fd_ = -1;
         other.initialized_ = false;
@@ -39,12 +40,12 @@ bool RawSocket::initialize() {
     }
     
     if (!create_raw_socket()) {
-        std::cerr << "Failed to create raw socket: " << strerror(errno) << std::endl;
+        TCP_LOG_ERROR("Failed to create raw socket", "error", strerror(errno));
         return false;
     }
     
     if (!configure_socket()) {
-        std::cerr << "Failed to configure raw socket: " << strerror(errno) << std::endl;
+        TCP_LOG_ERROR("Failed to configure raw socket", "error", strerror(errno));
         close();
         return false;
     }
@@ -76,13 +77,51 @@ bool RawSocket::send_packet(const std::vector<uint8_t>& packet, uint32_t dst_ip)
                                sizeof(dest_addr));
     
     if (bytes_sent == -1) {
-        std::cerr << "Failed to send packet: " << strerror(errno) << std::endl;
+        TCP_LOG_ERROR("Failed to send packet", "error", strerror(errno));
         return false;
     }
     
     return bytes_sent == static_cast<ssize_t>(packet.size());
 }
 
+size_t RawSocket::send_packets(const std::vector<std::vector<uint8_t>>& packets, uint32_t dst_ip) {
+    if (!is_valid() || packets.empty()) {
+        return 0;
+    }
+    
+    struct sockaddr_in dest_addr;
+    std::memset(&dest_addr, 0, sizeof(dest_addr));
+    dest_addr.sin_family = AF_INET;
+    dest_addr.sin_addr.s_addr = dst_ip;
+    
+    std::vector<struct iovec> iovecs(packets.size());
+    std::vector<struct mmsghdr> messages(packets.size());
+    for (size_t i = 0; i < packets.size(); ++i) {
+        iovecs[i].iov_base = const_cast<uint8_t*>(packets[i].data());
+        iovecs[i].iov_len = packets[i].size();
+        
+        std::memset(&messages[i], 0, sizeof(messages[i]));
+        messages[i].msg_hdr.msg_name = &dest_addr;
+        messages[i].msg_hdr.msg_namelen = sizeof(dest_addr);
+        messages[i].msg_hdr.msg_iov = &iovecs[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+    
+    // The kernel may take only part of the batch per call
+    size_t sent = 0;
+    while (sent < messages.size()) {
+        int result = sendmmsg(socket_fd_, messages.data() + sent,
+                              static_cast<unsigned int>(messages.size() - sent), 0);
+        if (result <= 0) {
+            TCP_LOG_ERROR("Failed to send packet batch", "error", strerror(errno));
+            break;
+        }
+        sent += static_cast<size_t>(result);
+    }
+    
+    return sent;
+}
+
 bool RawSocket::receive_packet(std::vector<uint8_t>& packet, uint32_t& src_ip) {
     if (!is_valid()) {
         return false;
@@ -99,7 +138,7 @@ bool RawSocket::receive_packet(std::vector<uint8_t>& packet, uint32_t& src_ip) {
     
     if (bytes_received == -1) {
         if (errno != EAGAIN && errno != EWOULDBLOCK) {
-            std::cerr << "Failed to receive packet: " << strerror(errno) << std::endl;
+            TCP_LOG_ERROR("Failed to receive packet", "error", strerror(errno));
         }
         return false;
     }
@@ -129,7 +168,7 @@ bool RawSocket::set_non_blocking(bool non_blocking) {
 }
 
 bool RawSocket::create_raw_socket() {
-    socket_fd_ = socket(AF_INET, SOCK_RAW, IPPROTO_TCP);
+    socket_fd_ = socket(AF_INET, SOCK_RAW, protocol_);
     return socket_fd_ != -1;
 }
 
@@ -0,0 +1,90 @@
+#include "receive_buffer_tuner.h"
+#include "tcp_sequence.h"
+#include <algorithm>
+
+namespace tcp_stack {
+
+ReceiveBufferTuner::ReceiveBufferTuner() {
+    reset(INITIAL_BUFFER, INITIAL_BUFFER, 536, Clock::now());
+}
+
+void ReceiveBufferTuner::reset(uint32_t initial_buffer, uint32_t max_buffer, uint16_t mss,
+                               Clock::time_point now) {
+    max_buffer_ = std::max(max_buffer, MIN_BUFFER);
+    buffer_ = std::clamp(initial_buffer, MIN_BUFFER, max_buffer_);
+    mss_ = std::max<uint16_t>(mss, 1);
+    
+    space_ = std::min(buffer_, INITIAL_SPACE_SEGMENTS * mss_);
+    copied_ = 0;
+    space_copied_ = 0;
+    space_time_ = now;
+    
+    rtt_ = std::chrono::microseconds(0);
+    rtt_seq_ = 0;
+    rtt_time_ = now;
+    rtt_started_ = false;
+}
+
+void ReceiveBufferTuner::set_max_buffer(uint32_t max_buffer) {
+    max_buffer_ = std::max(max_buffer, MIN_BUFFER);
+    buffer_ = std::min(buffer_, max_buffer_);
+}
+
+void ReceiveBufferTuner::on_data_received(uint32_t rcv_nxt, uint32_t rcv_wnd, Clock::time_point now) {
+    if (rtt_started_) {
+        if (seq_lt(rcv_nxt, rtt_seq_)) {
+            return;
+        }
+        
+        // A window takes at least an RTT to arrive, so the smallest
+        // sample is the best estimate
+        auto sample = std::chrono::duration_cast<std::chrono::microseconds>(now - rtt_time_);
+        sample = std::max(sample, std::chrono::microseconds(1));
+        rtt_ = rtt_.count() == 0 ? sample : std::min(rtt_, sample);
+    }
+    
+    rtt_started_ = true;
+    rtt_seq_ = rcv_nxt + rcv_wnd;
+    rtt_time_ = now;
+}
+
+bool ReceiveBufferTuner::on_data_consumed(size_t bytes, Clock::time_point now, bool allow_growth) {
+    copied_ += bytes;
+    
+    // Measure over whole receiver RTTs
+    if (rtt_.count() == 0 || now - space_time_ < rtt_) {
+        return false;
+    }
+    
+    uint64_t copied = copied_ - space_copied_;
+    space_copied_ = copied_;
+    space_time_ = now;
+    if (copied <= space_) {
+        return false;
+    }
+    
+    // Twice the drain rate covers the sender's slow-start doubling; grow
+    // faster while the rate is still climbing
+    uint64_t target = 2 * copied + static_cast<uint64_t>(HEADROOM_SEGMENTS) * mss_;
+    uint64_t grow = target * (copied - space_) / space_;
+    target += 2 * grow;
+    space_ = static_cast<uint32_t>(std::min<uint64_t>(copied, UINT32_MAX));
+    
+    if (!allow_growth) {
+        return false;
+    }
+    
+    uint32_t new_buffer = static_cast<uint32_t>(std::min<uint64_t>(target, max_buffer_));
+    if (new_buffer <= buffer_) {
+        return false;
+    }
+    buffer_ = new_buffer;
+    return true;
+}
+
+void ReceiveBufferTuner::shrink(uint32_t keep) {
+    buffer_ = std::clamp(keep, MIN_BUFFER, buffer_);
+    space_ = std::min(space_, buffer_);
+}
+
+} // namespace tcp_stack
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "sack_scoreboard.h"
+#include <iterator>
+
+namespace tcp_stack {
+
+SackScoreboard::SackScoreboard() : sacked_bytes_(0) {}
+
+void SackScoreboard::add(uint32_t start, uint32_t end) {
+    if (!seq_lt(start, end)) {
+        return;
+    }
+    
+    // Step back to a range that may overlap or touch the new one
+    auto it = ranges_.upper_bound(start);
+    if (it != ranges_.begin()) {
+        auto prev = std::prev(it);
+        if (seq_geq(prev->second, start)) {
+            it = prev;
+        }
+    }
+    
+    // Absorb every range overlapping or adjacent to [start, end)
+    while (it != ranges_.end() && seq_leq(it->first, end)) {
+        if (seq_lt(it->first, start)) {
+            start = it->first;
+        }
+        if (seq_gt(it->second, end)) {
+            end = it->second;
+        }
+        sacked_bytes_ -= it->second - it->first;
+        it = ranges_.erase(it);
+    }
+    
+    ranges_.emplace(start, end);
+    sacked_bytes_ += end - start;
+}
+
+void SackScoreboard::remove_below(uint32_t ack_num) {
+    auto it = ranges_.begin();
+    while (it != ranges_.end() && seq_lt(it->first, ack_num)) {
+        if (seq_leq(it->second, ack_num)) {
+            sacked_bytes_ -= it->second - it->first;
+            it = ranges_.erase(it);
+        } else {
+            // Trim the partially acknowledged head range
+            uint32_t end = it->second;
+            sacked_bytes_ -= ack_num - it->first;
+            ranges_.erase(it);
+            ranges_.emplace(ack_num, end);
+            break;
+        }
+    }
+}
+
+void SackScoreboard::clear() {
+    ranges_.clear();
+    sacked_bytes_ = 0;
+}
+
+bool SackScoreboard::is_sacked(uint32_t start, uint32_t end) const {
+    auto it = ranges_.upper_bound(start);
+    if (it == ranges_.begin()) {
+        return false;
+    }
+    --it;
+    return seq_leq(it->first, start) && seq_geq(it->second, end);
+}
+
+uint32_t SackScoreboard::sacked_bytes_above(uint32_t seq) const {
+    uint32_t bytes = 0;
+    auto it = ranges_.upper_bound(seq);
+    if (it != ranges_.begin()) {
+        auto prev = std::prev(it);
+        if (seq_gt(prev->second, seq + 1)) {
+            bytes += prev->second - (seq + 1);
+        }
+    }
+    for (; it != ranges_.end(); ++it) {
+        bytes += it->second - it->first;
+    }
+    return bytes;
+}
+
+size_t SackScoreboard::ranges_above(uint32_t seq) const {
+    return std::distance(ranges_.upper_bound(seq), ranges_.end());
+}
+
+uint32_t SackScoreboard::highest_sacked() const {
+    return ranges_.empty() ? 0 : std::prev(ranges_.end())->second;
+}
+
+} // namespace tcp_stack
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "siphash.h"
+#include <random>
+#include <cstring>
+
+namespace tcp_stack {
+
+namespace {
+
+inline uint64_t rotl(uint64_t x, int b) {
+    return (x << b) | (x >> (64 - b));
+}
+
+inline void sip_round(uint64_t& v0, uint64_t& v1, uint64_t& v2, uint64_t& v3) {
+    v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32);
+    v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;
+    v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;
+    v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32);
+}
+
+inline uint64_t load_le64(const uint8_t* p) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+} // namespace
+
+SipHashKey SipHashKey::random() {
+    std::random_device rd;
+    SipHashKey key;
+    key.k0 = (static_cast<uint64_t>(rd()) << 32) | rd();
+    key.k1 = (static_cast<uint64_t>(rd()) << 32) | rd();
+    return key;
+}
+
+uint64_t siphash24(const SipHashKey& key, const void* data, size_t length) {
+    const uint8_t* in = static_cast<const uint8_t*>(data);
+    uint64_t v0 = 0x736f6d6570736575ULL ^ key.k0;
+    uint64_t v1 = 0x646f72616e646f6dULL ^ key.k1;
+    uint64_t v2 = 0x6c7967656e657261ULL ^ key.k0;
+    uint64_t v3 = 0x7465646279746573ULL ^ key.k1;
+    
+    size_t full = length - length % 8;
+    for (size_t i = 0; i < full; i += 8) {
+        uint64_t m = load_le64(in + i);
+        v3 ^= m;
+        sip_round(v0, v1, v2, v3);
+        sip_round(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+    
+    // Last block: remaining bytes, with the length in the top byte
+    uint8_t tail[8] = {};
+    std::memcpy(tail, in + full, length - full);
+    uint64_t b = load_le64(tail) | (static_cast<uint64_t>(length & 0xFF) << 56);
+    v3 ^= b;
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    v0 ^= b;
+    
+    v2 ^= 0xFF;
+    for (int i = 0; i < 4; ++i) {
+        sip_round(v0, v1, v2, v3);
+    }
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+uint64_t siphash24_tuple(const SipHashKey& key, uint32_t local_ip, uint16_t local_port,
+                         uint32_t remote_ip, uint16_t remote_port) {
+    uint8_t tuple[12];
+    std::memcpy(tuple, &local_ip, 4);
+    std::memcpy(tuple + 4, &remote_ip, 4);
+    std::memcpy(tuple + 8, &local_port, 2);
+    std::memcpy(tuple + 10, &remote_port, 2);
+    return siphash24(key, tuple, sizeof(tuple));
+}
+
+} // namespace tcp_stack
\ No newline at end of file
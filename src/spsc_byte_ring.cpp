@@ -0,0 +1,67 @@
+#include "spsc_byte_ring.h"
+#include <algorithm>
+#include <cstring>
+
+namespace tcp_stack {
+
+namespace {
+
+size_t round_up_power_of_two(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
+SPSCByteRing::SPSCByteRing(size_t capacity)
+    : capacity_(round_up_power_of_two(std::max<size_t>(capacity, 1))),
+      mask_(capacity_ - 1),
+      buffer_(new uint8_t[capacity_]),  // Left uninitialized; pages are touched as used
+      head_(0), tail_(0) {
+}
+
+size_t SPSCByteRing::write(const uint8_t* data, size_t length) {
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    uint64_t head = head_.load(std::memory_order_acquire);
+    size_t count = std::min(length, capacity_ - static_cast<size_t>(tail - head));
+    if (count == 0) {
+        return 0;
+    }
+    
+    // At most two copies: up to the end of the buffer, then from the start
+    size_t offset = static_cast<size_t>(tail) & mask_;
+    size_t first = std::min(count, capacity_ - offset);
+    std::memcpy(buffer_.get() + offset, data, first);
+    std::memcpy(buffer_.get(), data + first, count - first);
+    
+    tail_.store(tail + count, std::memory_order_release);
+    return count;
+}
+
+size_t SPSCByteRing::read(uint8_t* buffer, size_t length) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    uint64_t tail = tail_.load(std::memory_order_acquire);
+    size_t count = std::min(length, static_cast<size_t>(tail - head));
+    if (count == 0) {
+        return 0;
+    }
+    
+    size_t offset = static_cast<size_t>(head) & mask_;
+    size_t first = std::min(count, capacity_ - offset);
+    std::memcpy(buffer, buffer_.get() + offset, first);
+    std::memcpy(buffer + first, buffer_.get(), count - first);
+    
+    head_.store(head + count, std::memory_order_release);
+    return count;
+}
+
+size_t SPSCByteRing::size() const {
+    uint64_t tail = tail_.load(std::memory_order_acquire);
+    uint64_t head = head_.load(std::memory_order_acquire);
+    return static_cast<size_t>(tail - head);
+}
+
+} // namespace tcp_stack
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "stack.h"
+
+namespace tcp_stack {
+
+Stack::Stack(const PlacementConfig& placement)
+    : manager_(std::make_shared<TCPConnectionManager>(placement)),
+      initialized_(manager_->initialize()) {}
+
+Stack::~Stack() {
+    // The engine thread works on the manager, which sockets may keep
+    disable_busy_poll();
+}
+
+Stack& Stack::default_stack() {
+    // Initialized once, without a lock on every later call
+    static Stack stack;
+    return stack;
+}
+
+bool Stack::enable_busy_poll(const BusyPollConfig& config) {
+    return manager_->start_busy_poll(config);
+}
+
+void Stack::disable_busy_poll() {
+    manager_->stop_busy_poll();
+}
+
+bool Stack::is_busy_polling() const {
+    return manager_->is_busy_polling();
+}
+
+BusyPollStats Stack::get_busy_poll_stats() const {
+    return manager_->get_busy_poll_stats();
+}
+
+StackStats Stack::get_stats() const {
+    StackStats stats;
+    stats.connections = manager_->get_connection_count();
+    stats.busy_poll = manager_->get_busy_poll_stats();
+    stats.placement = manager_->get_placement_stats();
+    return stats;
+}
+
+} // namespace tcp_stack
\ No newline at end of file
@@ -1,66 +1,185 @@
 #include "tcp_connection_manager.h"
+#include "tcp_sequence.h"
+#include "tcp_segmenter.h"
+#include "logger.h"
 #include <algorithm>
-#include <iostream>
 #include <cstring>
 
 namespace tcp_stack {
 
-TCPConnectionManager::TCPConnectionManager() {
+TCPConnectionManager::TCPConnectionManager(const PlacementConfig& placement)
+    : placement_(placement),
+      connections_(ConnectionTable::DEFAULT_BUCKETS, placement.numa_node, placement.huge_pages),
+      tx_scheduler_([this](const TransmitFlow& flow, std::vector<std::vector<uint8_t>>& packets) {
+          size_t sent = ip_layer_->send_batch(flow.src_ip, flow.dst_ip, IPPROTO_TCP, packets,
+                                              flow.tos);
+          packet_pool_.release(packets);
+          return sent;
+      }) {
+    if (placement_.cpus.empty()) {
+        placement_.cpus = NumaUtils::node_cpus(placement_.numa_node);
+    }
+    
+    // What we allocate now, the packet pool above all, comes from the node
+    ScopedNodePreference prefer(placement_.numa_node);
+    if (placement_.numa_node >= 0) {
+        packet_pool_.reserve(PacketBufferPool::DEFAULT_MAX_CACHED, POOL_PREFILL_SIZE);
+        pool_prefilled_ = packet_pool_.cached();
+    }
+    
     ip_layer_ = std::make_unique<IPLayer>();
+    busy_poll_ = std::make_unique<BusyPollEngine>(
+        [this]() { return busy_poll_pass(); },
+        [this](std::chrono::microseconds timeout) { busy_poll_block(timeout); });
 }
 
 bool TCPConnectionManager::initialize() {
     return ip_layer_->initialize();
 }
 
-bool TCPConnectionManager::listen(uint32_t local_ip, uint16_t local_port) {
+bool TCPConnectionManager::listen(uint32_t local_ip, uint16_t local_port,
+                                  const TCPConnectionConfig& config) {
     auto listening_conn = std::make_shared<TCPConnection>();
     listening_conn->local_ip = local_ip;
     listening_conn->local_port = local_port;
     listening_conn->remote_ip = 0;
     listening_conn->remote_port = 0;
+    listening_conn->config = config;
     listening_conn->state_machine.process_event(TCPEvent::PASSIVE_OPEN);
     listening_conn->last_activity = std::chrono::steady_clock::now();
     
-    listening_sockets_.push_back(listening_conn);
-    std::cout << "Listening on " << NetworkUtils::ip_network_to_string(local_ip) 
-              << ":" << local_port << std::endl;
+    if (!listeners_.insert(listening_conn)) {
+        TCP_LOG_WARN("Already listening", "ip", NetworkUtils::ip_network_to_string(local_ip),
+                     "port", local_port);
+        return false;
+    }
+    TCP_LOG_INFO("Listening", "ip", NetworkUtils::ip_network_to_string(local_ip), "port", local_port);
     return true;
 }
 
-std::shared_ptr<TCPConnection> TCPConnectionManager::accept_connection() {
-    // Process incoming packets to handle SYN requests
-    IPHeader ip_header;
-    std::vector<uint8_t> payload;
-    
-    while (ip_layer_->receive_packet(ip_header, payload)) {
-        if (ip_header.protocol == IPPROTO_TCP) {
-            process_incoming_segment(ip_header, payload);
-        }
+std::shared_ptr<TCPConnection> TCPConnectionManager::accept_connection(
+        std::shared_ptr<TCPConnection> listener) {
+    // Process incoming packets to handle SYN requests (the busy-poll
+    // engine already does)
+    if (!is_busy_polling()) {
+        poll();
     }
     
-    // Look for established connections
-    for (auto& conn : connections_) {
-        if (conn->state_machine.is_established()) {
+    // Children queue on their listener once established, or as soon as
+    // the SYN-ACK is out for one whose SYN carried Fast Open data
+    if (listener) {
+        return dequeue_acceptable(listener);
+    }
+    std::shared_ptr<TCPConnection> found;
+    listeners_.for_each([&](const std::shared_ptr<TCPConnection>& candidate) {
+        found = dequeue_acceptable(candidate);
+        return !found;
+    });
+    return found;
+}
+
+bool TCPConnectionManager::has_pending_accept(std::shared_ptr<TCPConnection> listener) const {
+    return listener->accept_pending.load() > 0;
+}
+
+std::shared_ptr<TCPConnection> TCPConnectionManager::find_listener(uint32_t local_ip,
+                                                                  uint16_t local_port) const {
+    return listeners_.find(local_ip, local_port, 0, 0);
+}
+
+void TCPConnectionManager::notify_event(std::shared_ptr<TCPConnection> conn, uint32_t events) {
+    if (!conn) {
+        return;
+    }
+    // The owning socket replaces the handler under this lock when it is
+    // moved or closed; for a listener this runs on a child's thread
+    std::lock_guard<std::recursive_mutex> lock(conn->mutex);
+    if (conn->event_handler) {
+        conn->event_handler(events);
+    }
+}
+
+void TCPConnectionManager::notify_acceptable(std::shared_ptr<TCPConnection> conn) {
+    notify_event(conn, EventPoller::WRITABLE);
+    if (!conn->accepted) {
+        queue_acceptable(conn);
+        notify_event(conn->listener.lock(), EventPoller::ACCEPT);
+    }
+}
+
+void TCPConnectionManager::queue_acceptable(std::shared_ptr<TCPConnection> conn) {
+    auto listener = conn->listener.lock();
+    if (!listener) {
+        return;
+    }
+    // A Fast Open child queued at its SYN stays where it is
+    std::lock_guard<std::recursive_mutex> lock(listener->mutex);
+    if (conn->in_accept_queue || conn->accepted) {
+        return;
+    }
+    conn->in_accept_queue = true;
+    listener->accept_queue.push_back(conn);
+    listener->accept_pending.fetch_add(1);
+}
+
+std::shared_ptr<TCPConnection> TCPConnectionManager::dequeue_acceptable(
+        std::shared_ptr<TCPConnection> listener) {
+    std::lock_guard<std::recursive_mutex> lock(listener->mutex);
+    while (!listener->accept_queue.empty()) {
+        auto conn = std::move(listener->accept_queue.front());
+        listener->accept_queue.pop_front();
+        listener->accept_pending.fetch_sub(1);
+        conn->in_accept_queue = false;
+        
+        // One removed while it was being queued is skipped here
+        bool current = connections_.find(conn->local_ip, conn->local_port,
+                                         conn->remote_ip, conn->remote_port) == conn;
+        if (current && !conn->accepted.exchange(true)) {
             return conn;
         }
     }
-    
     return nullptr;
 }
 
+void TCPConnectionManager::drop_acceptable(std::shared_ptr<TCPConnection> conn) {
+    auto listener = conn->listener.lock();
+    if (!listener) {
+        return;
+    }
+    std::lock_guard<std::recursive_mutex> lock(listener->mutex);
+    if (!conn->in_accept_queue) {
+        return;
+    }
+    auto& queue = listener->accept_queue;
+    queue.erase(std::find(queue.begin(), queue.end(), conn));
+    conn->in_accept_queue = false;
+    listener->accept_pending.fetch_sub(1);
+}
+
 std::shared_ptr<TCPConnection> TCPConnectionManager::connect(uint32_t local_ip, uint16_t local_port,
-                                                           uint32_t remote_ip, uint16_t remote_port) {
+                                                           uint32_t remote_ip, uint16_t remote_port,
+                                                           const TCPConnectionConfig& config,
+                                                           const std::vector<uint8_t>& data) {
     auto conn = std::make_shared<TCPConnection>();
     conn->local_ip = local_ip;
     conn->local_port = local_port;
     conn->remote_ip = remote_ip;
     conn->remote_port = remote_port;
-    conn->local_seq = NetworkUtils::generate_sequence_number();
-    conn->window_size = 65535; // Default window size
+    conn->config = config;
+    conn->local_seq = NetworkUtils::generate_sequence_number(local_ip, local_port,
+                                                            remote_ip, remote_port);
+    conn->local_ack = 0;
+    conn->fastopen_data = data;
     conn->last_activity = std::chrono::steady_clock::now();
+    init_path_mtu(conn);
+    init_receive_window(conn);
     
-    connections_.push_back(conn);
+    // Locked before it is published, so segments for it wait for the SYN
+    std::lock_guard<std::recursive_mutex> lock(conn->mutex);
+    if (!connections_.insert(conn)) {
+        TCP_LOG_WARN("Connection already exists for this 4-tuple");
+        return nullptr;
+    }
     
     // Initiate connection with SYN
     conn->state_machine.process_event(TCPEvent::ACTIVE_OPEN);
@@ -78,27 +197,328 @@ bool TCPConnectionManager::send_segment(std::shared_ptr<TCPConnection> conn,
         return false;
     }
     
-    TCPHeader tcp_header = create_tcp_header(conn, data, flags);
+    // Anything above the current MSS was sized by next_segment_size() as a probe
+    if (data.size() > current_mss(conn)) {
+        uint32_t option_bytes = conn->effective_mss() - static_cast<uint32_t>(current_mss(conn));
+        conn->path_mtu.on_probe_sent(conn->local_seq, conn->local_seq + data.size(),
+                                     data.size() + option_bytes + PathMTU::IP_TCP_HEADER_SIZE);
+    }
+    
+    // The first new data after an ECN window reduction carries CWR
+    if (!data.empty() && conn->ecn_enabled && conn->reliability &&
+        conn->reliability->take_cwr()) {
+        flags |= TCPHeader::CWR;
+    }
+    
+    bool success = transmit_segment(conn, conn->local_seq, data, flags, !data.empty());
+    
+    // The data is tracked for retransmission either way, so a packet the IP
+    // layer failed to send still consumes sequence space, like a lost one
+    if (!data.empty()) {
+        conn->local_seq += data.size();
+    }
+    
+    return success;
+}
+
+size_t TCPConnectionManager::flush_send_queue(std::shared_ptr<TCPConnection> conn,
+                                              bool more, bool push) {
+    if (!conn) {
+        return 0;
+    }
+    std::lock_guard<std::recursive_mutex> lock(conn->mutex);
+    if (!conn->reliability || !conn->state_machine.can_send_data()) {
+        return 0;
+    }
+    auto& reliability = conn->reliability;
+    auto now = std::chrono::steady_clock::now();
+    update_pacing_rate(conn);
+    
+    // Each burst pushes the next send time out by its length at the pacing
+    // rate; an idle connection does not bank the time it was idle
+    auto pace = [&](size_t bytes) {
+        if (conn->pacing_rate != 0) {
+            conn->next_send_time = std::max(conn->next_send_time, now) +
+                std::chrono::nanoseconds(static_cast<uint64_t>(bytes) * 1000000000 / conn->pacing_rate);
+        }
+    };
+    
+    size_t total_sent = 0;
+    while (reliability->get_buffered_bytes() > 0) {
+        // Not yet due: the pacing scheduler calls back at next_send_time
+        if (conn->pacing_rate != 0 && now < conn->next_send_time) {
+            conn->pacing_push = conn->pacing_push || push;
+            if (!conn->pacing_scheduled) {
+                conn->pacing_scheduled = true;
+                std::lock_guard<std::mutex> pacing_lock(pacing_mutex_);
+                pacing_scheduler_.schedule(conn, conn->next_send_time);
+            }
+            break;
+        }
+        
+        size_t buffered = reliability->get_buffered_bytes();
+        size_t mss = current_mss(conn);
+        size_t segment_size = next_segment_size(conn, buffered);
+        
+        // PLPMTUD probes go out on their own
+        if (segment_size > mss) {
+            auto probe = reliability->get_data_to_send(segment_size);
+            if (probe.empty()) {
+                break;
+            }
+            uint8_t flags = TCPHeader::ACK;
+            if (reliability->get_buffered_bytes() == 0) {
+                flags |= TCPHeader::PSH;
+            }
+            send_segment(conn, probe, flags);
+            total_sent += probe.size();
+            pace(probe.size());
+            continue;
+        }
+        
+        // A trailing partial segment goes only if nothing holds it back
+        bool send_partial = push ||
+            (!conn->corked && !more &&
+             (conn->config.nodelay || (buffered < mss && reliability->get_bytes_in_flight() == 0)));
+        
+        // A paced connection sends about PACING_BURST_TIME worth at once,
+        // but never less than two segments
+        size_t max_burst = GSO_MAX_BYTES;
+        if (conn->pacing_rate != 0) {
+            uint64_t burst_bytes = conn->pacing_rate * PACING_BURST_TIME.count() / 1000000;
+            max_burst = static_cast<size_t>(std::clamp<uint64_t>(burst_bytes, 2 * mss, GSO_MAX_BYTES));
+        }
+        size_t burst = std::min(buffered, max_burst - max_burst % mss);
+        if (!send_partial) {
+            burst -= burst % mss;
+        }
+        if (burst == 0) {
+            if (conn->corked &&
+                conn->cork_deadline == std::chrono::steady_clock::time_point::max()) {
+                conn->cork_deadline = std::chrono::steady_clock::now() + TCPConnection::CORK_TIMEOUT;
+            }
+            break;
+        }
+        
+        auto segments = reliability->get_burst_to_send(burst, mss);
+        if (segments.empty()) {
+            break; // Window full
+        }
+        
+        // PSH marks the end of what the application has given us
+        transmit_burst(conn, segments, reliability->get_buffered_bytes() == 0);
+        size_t burst_sent = 0;
+        for (auto& segment : segments) {
+            burst_sent += segment->data.size();
+        }
+        total_sent += burst_sent;
+        pace(burst_sent);
+    }
+    
+    if (reliability->get_buffered_bytes() == 0) {
+        conn->cork_deadline = std::chrono::steady_clock::time_point::max();
+        conn->pacing_push = false;
+    }
+    
+    run_transmit();
+    return total_sent;
+}
+
+void TCPConnectionManager::update_pacing_rate(std::shared_ptr<TCPConnection> conn) {
+    uint64_t rate = conn->cc_pacing_rate;
+    if (rate == 0 && conn->reliability && conn->reliability->has_rtt_sample()) {
+        const auto& reliability = conn->reliability;
+        uint64_t srtt_us = std::max<int64_t>(reliability->get_srtt().count(), 1);
+        uint32_t ratio = reliability->get_cwnd() < reliability->get_ssthresh() / 2 ?
+            PACING_SS_RATIO : PACING_CA_RATIO;
+        rate = static_cast<uint64_t>(reliability->get_cwnd()) * 1000000 * ratio / 100 / srtt_us;
+    }
+    
+    uint64_t cap = conn->config.max_pacing_rate;
+    if (cap != 0 && (rate == 0 || rate > cap)) {
+        rate = cap;
+    }
+    conn->pacing_rate = rate;
+}
+
+void TCPConnectionManager::process_pacing() {
+    std::vector<std::shared_ptr<TCPConnection>> due;
+    {
+        std::lock_guard<std::mutex> lock(pacing_mutex_);
+        due = pacing_scheduler_.advance(std::chrono::steady_clock::now());
+    }
+    for (auto& conn : due) {
+        std::lock_guard<std::recursive_mutex> lock(conn->mutex);
+        conn->pacing_scheduled = false;
+        bool push = conn->pacing_push;
+        conn->pacing_push = false;
+        flush_send_queue(conn, false, push);
+    }
+}
+
+std::chrono::steady_clock::time_point TCPConnectionManager::next_pacing_deadline() const {
+    std::lock_guard<std::mutex> lock(pacing_mutex_);
+    return pacing_scheduler_.next_deadline();
+}
+
+bool TCPConnectionManager::retransmit_segment(std::shared_ptr<TCPConnection> conn,
+                                             const TCPSegment& segment) {
+    if (!conn) {
+        return false;
+    }
+    std::lock_guard<std::recursive_mutex> lock(conn->mutex);
+    if (!conn->state_machine.can_send_data()) {
+        return false;
+    }
+    
+    // A lost probe only bounds the search; repeated timeouts of full-sized
+    // segments on a path that sends no ICMP suggest a black hole
+    if (conn->path_mtu.is_probe(segment.seq_num)) {
+        conn->path_mtu.on_probe_lost();
+    } else if (conn->config.mtu_probing &&
+               segment.retransmit_count >= PathMTU::BLACK_HOLE_RETRANSMITS &&
+               segment.data.size() + PathMTU::IP_TCP_HEADER_SIZE > PathMTU::BASE_MTU &&
+               conn->path_mtu.on_black_hole()) {
+        update_mss(conn);
+    }
+    
+    // Segments sent before the MTU dropped (or failed probes) go out
+    // re-split at the current MSS
+    size_t mss = current_mss(conn);
+    if (segment.data.size() <= mss) {
+        return transmit_segment(conn, segment.seq_num, segment.data,
+                                TCPHeader::PSH | TCPHeader::ACK);
+    }
+    
+    bool success = true;
+    for (size_t offset = 0; offset < segment.data.size(); offset += mss) {
+        size_t length = std::min(mss, segment.data.size() - offset);
+        std::vector<uint8_t> piece(segment.data.begin() + offset,
+                                   segment.data.begin() + offset + length);
+        success = transmit_segment(conn, segment.seq_num + static_cast<uint32_t>(offset), piece,
+                                   TCPHeader::PSH | TCPHeader::ACK) && success;
+    }
+    return success;
+}
+
+size_t TCPConnectionManager::next_segment_size(std::shared_ptr<TCPConnection> conn,
+                                               size_t queued_bytes) {
+    size_t mss = current_mss(conn);
+    if (!conn->path_mtu.should_probe(std::chrono::steady_clock::now())) {
+        return mss;
+    }
+    
+    // Probes carry real data, so only send one when there is enough of it
+    // (RFC 4821 section 7.4), and never beyond what the peer accepts
+    size_t option_bytes = conn->effective_mss() - mss;
+    size_t probe = conn->path_mtu.next_probe_size() - PathMTU::IP_TCP_HEADER_SIZE - option_bytes;
+    size_t limit = std::min(conn->peer_mss, conn->local_mss) - option_bytes;
+    if (probe > mss && probe <= limit && queued_bytes >= probe) {
+        return probe;
+    }
+    return mss;
+}
+
+void TCPConnectionManager::transmit_burst(std::shared_ptr<TCPConnection> conn,
+                                          const std::vector<std::shared_ptr<TCPSegment>>& segments,
+                                          bool push) {
+    if (segments.empty()) {
+        return;
+    }
+    
+    // The flow's fields are shared with the scheduler
+    std::lock_guard<std::mutex> lock(tx_mutex_);
+    if (!conn->tx_flow) {
+        conn->tx_flow = std::make_shared<TransmitFlow>();
+        conn->tx_flow->src_ip = conn->local_ip;
+        conn->tx_flow->dst_ip = conn->remote_ip;
+    }
+    if (!conn->tx_flow->active) {
+        conn->tx_flow->priority = conn->config.tx_priority;
+        conn->tx_flow->weight = conn->config.tx_weight;
+    }
+    conn->tx_flow->tos = conn->ecn_enabled ? ECN_ECT0 : ECN_NOT_ECT;
+    
+    uint8_t ecn_flags = conn->ecn_enabled && conn->ece_pending ? TCPHeader::ECE : 0;
+    bool cwr = conn->ecn_enabled && conn->reliability && conn->reliability->take_cwr();
+    
+    // Every segment of the burst shares one header template and options
+    std::vector<uint8_t> options = build_options(conn, TCPHeader::ACK).serialize();
+    TCPSegmenter segmenter(conn->local_ip, conn->remote_ip,
+                           create_tcp_header(conn, 0, options, {}, 0), options);
+    
+    for (size_t i = 0; i < segments.size(); ++i) {
+        const auto& data = segments[i]->data;
+        uint8_t flags = TCPHeader::ACK | ecn_flags;
+        if (cwr && i == 0) {
+            flags |= TCPHeader::CWR;
+        }
+        if (push && i + 1 == segments.size()) {
+            flags |= TCPHeader::PSH;
+        }
+        
+        auto packet = packet_pool_.acquire(sizeof(IPHeader) + segmenter.header_length() + data.size());
+        segmenter.build(segments[i]->seq_num, flags, data.data(), data.size(),
+                        packet, sizeof(IPHeader));
+        tx_scheduler_.enqueue(conn->tx_flow, std::move(packet));
+    }
+    
+    // Sequence space is consumed once queued; a packet the link later
+    // refuses is recovered like a loss
+    const auto& last = segments.back();
+    conn->local_seq = last->seq_num + static_cast<uint32_t>(last->data.size());
+    conn->ack_pending_bytes = 0;
+    conn->ack_deadline = std::chrono::steady_clock::time_point::max();
+    conn->last_activity = std::chrono::steady_clock::now();
+}
+
+size_t TCPConnectionManager::run_transmit(size_t max_packets) {
+    std::lock_guard<std::mutex> lock(tx_mutex_);
+    return tx_scheduler_.run(max_packets);
+}
+
+size_t TCPConnectionManager::get_transmit_backlog() const {
+    std::lock_guard<std::mutex> lock(tx_mutex_);
+    return tx_scheduler_.backlog();
+}
+
+bool TCPConnectionManager::transmit_segment(std::shared_ptr<TCPConnection> conn, uint32_t seq,
+                                           const std::vector<uint8_t>& data, uint8_t flags,
+                                           bool ect) {
+    // Echo congestion on every ACK until the peer confirms with CWR
+    if (conn->ecn_enabled && conn->ece_pending &&
+        (flags & (TCPHeader::ACK | TCPHeader::SYN)) == TCPHeader::ACK) {
+        flags |= TCPHeader::ECE;
+    }
+    
+    std::vector<uint8_t> options = build_options(conn, flags).serialize();
+    TCPHeader tcp_header = create_tcp_header(conn, seq, options, data, flags);
     
     // Create TCP segment
-    std::vector<uint8_t> tcp_segment(sizeof(TCPHeader) + data.size());
+    std::vector<uint8_t> tcp_segment(sizeof(TCPHeader) + options.size() + data.size());
     
     // Copy header (convert to network byte order)
     TCPHeader net_header = tcp_header;
     net_header.to_network_order();
     std::memcpy(tcp_segment.data(), &net_header, sizeof(TCPHeader));
     
-    // Copy data
+    // Copy options and data
+    if (!options.empty()) {
+        std::memcpy(tcp_segment.data() + sizeof(TCPHeader), options.data(), options.size());
+    }
     if (!data.empty()) {
-        std::memcpy(tcp_segment.data() + sizeof(TCPHeader), data.data(), data.size());
+        std::memcpy(tcp_segment.data() + sizeof(TCPHeader) + options.size(),
+                    data.data(), data.size());
     }
     
     // Send via IP layer
-    bool success = ip_layer_->send_packet(conn->local_ip, conn->remote_ip, 
-                                         IPPROTO_TCP, tcp_segment);
+    bool success = ip_layer_->send_packet(conn->local_ip, conn->remote_ip, IPPROTO_TCP, tcp_segment,
+                                         ect && conn->ecn_enabled ? ECN_ECT0 : ECN_NOT_ECT);
     
-    if (success && !data.empty()) {
-        conn->local_seq += data.size();
+    // The ACK field rides on every segment, so any of them settles a delayed ACK
+    if (flags & TCPHeader::ACK) {
+        conn->ack_pending_bytes = 0;
+        conn->ack_deadline = std::chrono::steady_clock::time_point::max();
     }
     
     conn->last_activity = std::chrono::steady_clock::now();
@@ -107,60 +527,221 @@ bool TCPConnectionManager::send_segment(std::shared_ptr<TCPConnection> conn,
 
 bool TCPConnectionManager::process_incoming_segment(const IPHeader& ip_header, 
                                                    const std::vector<uint8_t>& tcp_data) {
+    ReceivedSegment segment;
+    if (!parse_segment(ip_header, tcp_data, segment)) {
+        return false;
+    }
+    
+    process_segment(segment);
+    return true;
+}
+
+size_t TCPConnectionManager::process_incoming_batch(
+        const std::vector<std::pair<IPHeader, std::vector<uint8_t>>>& packets) {
+    std::vector<ReceivedSegment> segments;
+    {
+        std::lock_guard<std::mutex> lock(coalescer_mutex_);
+        for (const auto& packet : packets) {
+            ReceivedSegment segment;
+            if (parse_segment(packet.first, packet.second, segment)) {
+                rx_coalescer_.add(std::move(segment));
+            }
+        }
+        segments = rx_coalescer_.flush();
+    }
+    for (const auto& segment : segments) {
+        process_segment(segment);
+    }
+    return segments.size();
+}
+
+bool TCPConnectionManager::parse_segment(const IPHeader& ip_header,
+                                         const std::vector<uint8_t>& tcp_data,
+                                         ReceivedSegment& segment) {
     if (tcp_data.size() < sizeof(TCPHeader)) {
         return false;
     }
     
-    TCPHeader tcp_header;
+    TCPHeader& tcp_header = segment.tcp_header;
     std::memcpy(&tcp_header, tcp_data.data(), sizeof(TCPHeader));
     tcp_header.to_host_order();
     
+    size_t header_length = tcp_header.get_header_length();
+    if (header_length < sizeof(TCPHeader) || header_length > tcp_data.size()) {
+        return false;
+    }
+    
+    // Split options and data payload
+    std::vector<uint8_t> option_bytes(tcp_data.begin() + sizeof(TCPHeader),
+                                      tcp_data.begin() + header_length);
+    segment.payload.assign(tcp_data.begin() + header_length, tcp_data.end());
+    
     // Validate checksum
     uint16_t received_checksum = tcp_header.checksum;
     tcp_header.checksum = 0;
     uint16_t calculated_checksum = calculate_tcp_checksum(ip_header.src_ip, ip_header.dst_ip,
-                                                         tcp_header, 
-                                                         std::vector<uint8_t>(tcp_data.begin() + sizeof(TCPHeader), 
-                                                                             tcp_data.end()));
+                                                         tcp_header, option_bytes, segment.payload);
     
     if (received_checksum != calculated_checksum) {
-        std::cerr << "TCP checksum mismatch" << std::endl;
+        TCP_LOG_DEBUG("TCP checksum mismatch", "received", received_checksum,
+                      "calculated", calculated_checksum);
+        return false;
+    }
+    
+    if (!TCPOptions::parse(option_bytes.data(), option_bytes.size(), segment.options)) {
         return false;
     }
     
-    // Extract data payload
-    std::vector<uint8_t> data;
-    if (tcp_data.size() > sizeof(TCPHeader)) {
-        data.assign(tcp_data.begin() + sizeof(TCPHeader), tcp_data.end());
+    segment.ip_header = ip_header;
+    return true;
+}
+
+void TCPConnectionManager::process_segment(const ReceivedSegment& segment) {
+    const IPHeader& ip_header = segment.ip_header;
+    const TCPHeader& tcp_header = segment.tcp_header;
+    const TCPOptions& options = segment.options;
+    const std::vector<uint8_t>& data = segment.payload;
+    
+    // A bare SYN is for a listener; everything else for an existing connection
+    if (tcp_header.has_flag(TCPHeader::SYN) && !tcp_header.has_flag(TCPHeader::ACK)) {
+        handle_syn_segment(ip_header, tcp_header, options, data);
+        return;
+    }
+    
+    auto conn = find_connection(ip_header.dst_ip, tcp_header.dst_port,
+                               ip_header.src_ip, tcp_header.src_port);
+    if (!conn) {
+        return;
+    }
+    
+    std::lock_guard<std::recursive_mutex> lock(conn->mutex);
+    process_ecn(conn, segment);
+    
+    if (try_fast_path(conn, segment)) {
+        return;
+    }
+    
+    // Slow path, in RFC 793 order: RST, SYN, ACK, data, FIN
+    if (tcp_header.has_flag(TCPHeader::RST)) {
+        handle_rst_segment(conn);
+        return;
     }
     
-    // Handle different segment types
     if (tcp_header.has_flag(TCPHeader::SYN)) {
-        if (tcp_header.has_flag(TCPHeader::ACK)) {
-            handle_syn_ack_segment(ip_header, tcp_header);
-        } else {
-            handle_syn_segment(ip_header, tcp_header);
-        }
+        handle_syn_ack_segment(conn, tcp_header, options);
     } else if (tcp_header.has_flag(TCPHeader::ACK)) {
-        handle_ack_segment(ip_header, tcp_header);
-    } else if (tcp_header.has_flag(TCPHeader::FIN)) {
-        handle_fin_segment(ip_header, tcp_header);
-    } else if (tcp_header.has_flag(TCPHeader::RST)) {
-        handle_rst_segment(ip_header, tcp_header);
+        handle_ack_segment(conn, tcp_header, data.size(), options);
     }
     
     if (!data.empty()) {
-        handle_data_segment(ip_header, tcp_header, data);
+        handle_data_segment(conn, segment);
+    }
+    
+    if (tcp_header.has_flag(TCPHeader::FIN)) {
+        handle_fin_segment(conn, tcp_header, data.size());
+    }
+}
+
+void TCPConnectionManager::process_ecn(std::shared_ptr<TCPConnection> conn,
+                                       const ReceivedSegment& segment) {
+    if (!conn->ecn_enabled) {
+        return;
+    }
+    
+    bool ce = segment.ip_header.get_ecn() == ECN_CE;
+    if (conn->reliability &&
+        conn->reliability->get_congestion_control() == CongestionControl::DCTCP) {
+        // DCTCP echoes exactly which segments were marked. When the CE
+        // state changes, data held for a delayed ACK is acknowledged at
+        // once under the old state so the sender's count stays accurate.
+        if (ce != conn->ece_pending) {
+            if (conn->ack_pending_bytes > 0) {
+                send_ack(conn);
+            }
+            conn->ece_pending = ce;
+        }
+        return;
+    }
+    
+    // RFC 3168 section 6.1.3: set ECE from a CE mark until a CWR arrives
+    if (segment.tcp_header.has_flag(TCPHeader::CWR)) {
+        conn->ece_pending = false;
+    }
+    if (ce) {
+        conn->ece_pending = true;
+    }
+}
+
+bool TCPConnectionManager::try_fast_path(std::shared_ptr<TCPConnection> conn,
+                                         const ReceivedSegment& segment) {
+    const TCPHeader& tcp_header = segment.tcp_header;
+    
+    // The prediction: ESTABLISHED, ACK or ACK|PSH only, no options, the
+    // expected sequence number, an unchanged window and no recovery or
+    // reassembly in progress
+    if ((tcp_header.flags & ~TCPHeader::PSH) != TCPHeader::ACK ||
+        !conn->state_machine.is_established() || !conn->reliability ||
+        !segment.options.empty() || tcp_header.seq_num != conn->local_ack ||
+        tcp_header.window_size != conn->peer_window || !conn->reassembly.empty() ||
+        conn->reliability->in_fast_recovery()) {
+        return false;
+    }
+    
+    uint32_t snd_una = conn->reliability->get_last_ack();
+    uint32_t ack = tcp_header.ack_num;
+    if (seq_lt(ack, snd_una) || seq_gt(ack, conn->local_seq)) {
+        return false;
     }
     
+    if (segment.payload.empty()) {
+        // Pure ACK for new data; duplicates feed loss detection on the slow path
+        if (ack == snd_una) {
+            return false;
+        }
+    } else if (segment.payload.size() > conn->window_size) {
+        return false;
+    }
+    
+    conn->fast_path_segments++;
+    conn->last_activity = std::chrono::steady_clock::now();
+    
+    if (ack != snd_una) {
+        process_ack(conn, tcp_header, segment.payload.size(), {});
+    }
+    if (!segment.payload.empty()) {
+        receive_in_order(conn, segment, 0);
+    }
     return true;
 }
 
+void TCPConnectionManager::process_timers(std::shared_ptr<TCPConnection> conn) {
+    if (!conn) {
+        return;
+    }
+    
+    std::lock_guard<std::recursive_mutex> lock(conn->mutex);
+    auto now = std::chrono::steady_clock::now();
+    
+    // A corked partial segment is not held forever
+    if (now >= conn->cork_deadline) {
+        conn->cork_deadline = std::chrono::steady_clock::time_point::max();
+        flush_send_queue(conn, false, true);
+    }
+    
+    if (now >= conn->ack_deadline) {
+        send_ack(conn);
+    }
+}
+
 bool TCPConnectionManager::close_connection(std::shared_ptr<TCPConnection> conn) {
     if (!conn) return false;
     
-    conn->state_machine.process_event(TCPEvent::CLOSE);
-    bool success = send_fin(conn);
+    bool success;
+    {
+        std::lock_guard<std::recursive_mutex> lock(conn->mutex);
+        conn->state_machine.process_event(TCPEvent::CLOSE);
+        success = send_fin(conn);
+    }
     
     // Remove from connections list after close
     remove_connection(conn);
@@ -169,38 +750,187 @@ bool TCPConnectionManager::close_connection(std::shared_ptr<TCPConnection> conn)
 
 std::shared_ptr<TCPConnection> TCPConnectionManager::find_connection(uint32_t local_ip, uint16_t local_port,
                                                                     uint32_t remote_ip, uint16_t remote_port) {
-    auto it = std::find_if(connections_.begin(), connections_.end(),
-        [=](const std::shared_ptr<TCPConnection>& conn) {
-            return conn->local_ip == local_ip && conn->local_port == local_port &&
-                   conn->remote_ip == remote_ip && conn->remote_port == remote_port;
-        });
-    
-    return (it != connections_.end()) ? *it : nullptr;
+    return connections_.find(local_ip, local_port, remote_ip, remote_port);
 }
 
-TCPHeader TCPConnectionManager::create_tcp_header(std::shared_ptr<TCPConnection> conn,
+TCPHeader TCPConnectionManager::create_tcp_header(std::shared_ptr<TCPConnection> conn, uint32_t seq,
+                                                 const std::vector<uint8_t>& options,
                                                  const std::vector<uint8_t>& data, uint8_t flags) {
     TCPHeader header;
     std::memset(&header, 0, sizeof(header));
     
     header.src_port = conn->local_port;
     header.dst_port = conn->remote_port;
-    header.seq_num = conn->local_seq;
+    header.seq_num = seq;
     header.ack_num = conn->local_ack;
-    header.set_data_offset(5); // 20 bytes, no options
+    header.set_data_offset((sizeof(TCPHeader) + options.size()) / 4);
     header.flags = flags;
-    header.window_size = conn->window_size;
+    header.window_size = select_window(conn, (flags & TCPHeader::SYN) != 0);
     header.urgent_pointer = 0;
     
     // Calculate checksum
     header.checksum = 0;
-    header.checksum = calculate_tcp_checksum(conn->local_ip, conn->remote_ip, header, data);
+    header.checksum = calculate_tcp_checksum(conn->local_ip, conn->remote_ip, header, options, data);
     
     return header;
 }
 
+TCPOptions TCPConnectionManager::build_options(std::shared_ptr<TCPConnection> conn, uint8_t flags) {
+    TCPOptions options;
+    
+    if (flags & TCPHeader::SYN) {
+        options.mss = conn->local_mss;
+        // A SYN-ACK may only echo SACK-permitted if the SYN carried it
+        options.sack_permitted = (flags & TCPHeader::ACK) ? conn->sack_enabled
+                                                          : conn->config.sack_permitted;
+        options.has_window_scale = (flags & TCPHeader::ACK) ? conn->wscale_enabled
+                                                            : conn->config.window_scaling;
+        options.window_scale = conn->rcv_wscale;
+        // The client offers its cookie (empty asks for one); the server
+        // issues one only when it has a new one to give
+        options.has_fastopen = (flags & TCPHeader::ACK) ? !conn->fastopen_cookie.empty()
+                                                        : conn->config.fastopen;
+        options.fastopen_cookie = conn->fastopen_cookie;
+    } else if (conn->sack_enabled && !conn->reassembly.empty()) {
+        options.sack_blocks = conn->reassembly.sack_blocks(TCPOptions::MAX_SACK_BLOCKS);
+    }
+    
+    return options;
+}
+
+size_t TCPConnectionManager::current_mss(std::shared_ptr<TCPConnection> conn) {
+    size_t option_bytes = build_options(conn, TCPHeader::ACK).serialize().size();
+    size_t mss = conn->effective_mss();
+    return mss > option_bytes ? mss - option_bytes : 1;
+}
+
+void TCPConnectionManager::init_path_mtu(std::shared_ptr<TCPConnection> conn) {
+    uint32_t link_mtu = NetworkUtils::get_interface_mtu(conn->local_ip);
+    if (link_mtu == 0) {
+        link_mtu = PathMTU::DEFAULT_LINK_MTU;
+    }
+    conn->path_mtu.reset(link_mtu, conn->config.mtu_probing);
+    
+    uint32_t mss = std::min<uint32_t>(conn->path_mtu.get_mss(), UINT16_MAX);
+    if (conn->config.mss != 0) {
+        mss = std::min<uint32_t>(mss, conn->config.mss);
+    }
+    conn->local_mss = static_cast<uint16_t>(mss);
+}
+
+void TCPConnectionManager::update_mss(std::shared_ptr<TCPConnection> conn) {
+    if (conn->reliability) {
+        conn->reliability->set_mss(conn->effective_mss());
+    }
+}
+
+void TCPConnectionManager::init_receive_window(std::shared_ptr<TCPConnection> conn) {
+    uint32_t cap = conn->config.max_receive_buffer != 0 ? conn->config.max_receive_buffer
+                                                        : max_receive_buffer_.load();
+    conn->rcv_tuner.reset(ReceiveBufferTuner::INITIAL_BUFFER, cap, conn->local_mss,
+                          std::chrono::steady_clock::now());
+    receive_memory_ += conn->rcv_tuner.get_buffer();
+    
+    // The smallest scale that lets the window reach the cap
+    conn->rcv_wscale = 0;
+    if (conn->config.window_scaling) {
+        while (conn->rcv_wscale < TCPOptions::MAX_WINDOW_SCALE &&
+               (static_cast<uint32_t>(UINT16_MAX) << conn->rcv_wscale) < cap) {
+            conn->rcv_wscale++;
+        }
+    }
+    
+    conn->window_size = std::min<uint32_t>(conn->rcv_tuner.get_buffer(), UINT16_MAX);
+    conn->rcv_wnd_edge = conn->local_ack;
+}
+
+uint16_t TCPConnectionManager::select_window(std::shared_ptr<TCPConnection> conn, bool syn) {
+    uint32_t buffer = conn->rcv_tuner.get_buffer();
+    uint32_t window = buffer > conn->rcv_queued ? buffer - conn->rcv_queued : 0;
+    
+    // A shrunken buffer closes the window as data arrives rather than by
+    // moving its right edge back
+    uint32_t offered = seq_gt(conn->rcv_wnd_edge, conn->local_ack) ?
+        conn->rcv_wnd_edge - conn->local_ack : 0;
+    window = std::max(window, offered);
+    
+    // The window field of a SYN is never scaled
+    uint8_t shift = syn ? 0 : conn->rcv_wscale;
+    uint32_t units = std::min<uint32_t>(window >> shift, UINT16_MAX);
+    if ((units << shift) < offered && units < UINT16_MAX) {
+        units++;
+    }
+    
+    conn->window_size = units << shift;
+    conn->rcv_wnd_edge = conn->local_ack + conn->window_size;
+    return static_cast<uint16_t>(units);
+}
+
+void TCPConnectionManager::on_data_consumed(std::shared_ptr<TCPConnection> conn, size_t bytes) {
+    if (!conn || bytes == 0) {
+        return;
+    }
+    
+    std::lock_guard<std::recursive_mutex> lock(conn->mutex);
+    conn->rcv_queued -= static_cast<uint32_t>(std::min<size_t>(bytes, conn->rcv_queued));
+    
+    uint32_t before = conn->rcv_tuner.get_buffer();
+    conn->rcv_tuner.on_data_consumed(bytes, std::chrono::steady_clock::now(),
+                                     !under_memory_pressure());
+    receive_memory_ += static_cast<size_t>(conn->rcv_tuner.get_buffer()) - before;
+    apply_memory_pressure(conn);
+    
+    // Window update when reading has at least doubled the window, and by
+    // enough to be worth it (receiver-side SWS avoidance, RFC 1122 4.2.3.3)
+    if (!conn->state_machine.can_receive_data()) {
+        return;
+    }
+    uint32_t buffer = conn->rcv_tuner.get_buffer();
+    uint32_t window_now = seq_gt(conn->rcv_wnd_edge, conn->local_ack) ?
+        conn->rcv_wnd_edge - conn->local_ack : 0;
+    uint32_t free_space = buffer > conn->rcv_queued ? buffer - conn->rcv_queued : 0;
+    uint32_t threshold = std::min<uint32_t>(conn->rcv_mss, buffer / 2);
+    if (free_space >= 2 * window_now && free_space - window_now >= threshold) {
+        send_ack(conn);
+    }
+}
+
+void TCPConnectionManager::apply_memory_pressure(std::shared_ptr<TCPConnection> conn) {
+    if (!under_memory_pressure()) {
+        return;
+    }
+    
+    // Keep room for what is queued plus a few segments so the flow moves
+    uint32_t before = conn->rcv_tuner.get_buffer();
+    conn->rcv_tuner.shrink(conn->rcv_queued + 4 * static_cast<uint32_t>(conn->rcv_mss));
+    receive_memory_ -= before - conn->rcv_tuner.get_buffer();
+}
+
+void TCPConnectionManager::set_max_receive_buffer(uint32_t bytes) {
+    max_receive_buffer_ = bytes;
+    connections_.for_each([&](const std::shared_ptr<TCPConnection>& conn) {
+        std::lock_guard<std::recursive_mutex> lock(conn->mutex);
+        if (conn->config.max_receive_buffer == 0) {
+            uint32_t before = conn->rcv_tuner.get_buffer();
+            conn->rcv_tuner.set_max_buffer(bytes);
+            receive_memory_ -= before - conn->rcv_tuner.get_buffer();
+        }
+        return true;
+    });
+}
+
+void TCPConnectionManager::set_max_receive_buffer(std::shared_ptr<TCPConnection> conn,
+                                                  uint32_t bytes) {
+    std::lock_guard<std::recursive_mutex> lock(conn->mutex);
+    conn->config.max_receive_buffer = bytes;
+    uint32_t before = conn->rcv_tuner.get_buffer();
+    conn->rcv_tuner.set_max_buffer(bytes != 0 ? bytes : max_receive_buffer_.load());
+    receive_memory_ -= before - conn->rcv_tuner.get_buffer();
+}
+
 uint16_t TCPConnectionManager::calculate_tcp_checksum(uint32_t src_ip, uint32_t dst_ip,
-                                                     const TCPHeader& header, 
+                                                     const TCPHeader& header,
+                                                     const std::vector<uint8_t>& options,
                                                      const std::vector<uint8_t>& data) {
     // Create pseudo header for checksum calculation
     TCPPseudoHeader pseudo_header;
@@ -208,7 +938,7 @@ uint16_t TCPConnectionManager::calculate_tcp_checksum(uint32_t src_ip, uint32_t
     pseudo_header.dst_ip = dst_ip;
     pseudo_header.reserved = 0;
     pseudo_header.protocol = IPPROTO_TCP;
-    pseudo_header.tcp_length = htons(sizeof(TCPHeader) + data.size());
+    pseudo_header.tcp_length = htons(sizeof(TCPHeader) + options.size() + data.size());
     
     // Prepare segments for checksum calculation
     std::vector<std::pair<const void*, size_t>> segments = {
@@ -216,6 +946,10 @@ uint16_t TCPConnectionManager::calculate_tcp_checksum(uint32_t src_ip, uint32_t
         {&header, sizeof(header)}
     };
     
+    if (!options.empty()) {
+        segments.push_back({options.data(), options.size()});
+    }
+    
     if (!data.empty()) {
         segments.push_back({data.data(), data.size()});
     }
@@ -224,14 +958,177 @@ uint16_t TCPConnectionManager::calculate_tcp_checksum(uint32_t src_ip, uint32_t
 }
 
 // Handle different segment types
-void TCPConnectionManager::handle_syn_segment(const IPHeader& ip_header, const TCPHeader& tcp_header) {
-    // Look for listening socket
-    auto listening_it = std::find_if(listening_sockets_.begin(), listening_sockets_.end(),
-        [&](const std::shared_ptr<TCPConnection>& conn) {
-            return conn->local_ip == ip_header.dst_ip && conn->local_port == tcp_header.dst_port;
-        });
+size_t TCPConnectionManager::poll() {
+    // Another thread is already draining the link; what arrives meanwhile
+    // is its to pick up
+    std::unique_lock<std::mutex> lock(rx_mutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return 0;
+    }
+    
+    IPHeader ip_header;
+    std::vector<uint8_t> payload;
+    std::vector<std::pair<IPHeader, std::vector<uint8_t>>> burst;
+    burst.reserve(RX_BURST_SIZE);
+    size_t received = 0;
+    
+    bool more = true;
+    while (more) {
+        burst.clear();
+        while (burst.size() < RX_BURST_SIZE && (more = ip_layer_->receive_packet(ip_header, payload))) {
+            received++;
+            if (ip_header.protocol == IPPROTO_TCP) {
+                burst.emplace_back(ip_header, std::move(payload));
+            }
+        }
+        process_incoming_batch(burst);
+    }
+    
+    while (ip_layer_->receive_icmp(ip_header, payload)) {
+        received++;
+        process_icmp_message(ip_header, payload);
+    }
+    return received;
+}
+
+bool TCPConnectionManager::start_busy_poll(const BusyPollConfig& config) {
+    // Unless told otherwise the engine runs where the stack is placed
+    BusyPollConfig placed = config;
+    if (placed.cpu < 0 && placed.cpus.empty()) {
+        placed.cpus = placement_.cpus;
+    }
+    if (placed.numa_node < 0) {
+        placed.numa_node = placement_.numa_node;
+    }
+    return busy_poll_->start(placed);
+}
+
+bool TCPConnectionManager::place_current_thread() {
+    if (placement_.cpus.empty() && placement_.numa_node < 0) {
+        return true;
+    }
+    
+    bool pinned = placement_.cpus.empty() || NumaUtils::pin_thread(pthread_self(), placement_.cpus);
+    bool preferred = placement_.numa_node < 0 || NumaUtils::prefer_node(placement_.numa_node);
+    if (pinned && preferred) {
+        threads_placed_++;
+        return true;
+    }
+    placement_failures_++;
+    return false;
+}
+
+PlacementStats TCPConnectionManager::get_placement_stats() const {
+    PlacementStats stats;
+    stats.numa_node = placement_.numa_node;
+    stats.cpus = placement_.cpus;
+    stats.table_on_node = connections_.is_node_bound();
+    stats.table_huge_pages = connections_.uses_huge_pages();
+    stats.pool_buffers = pool_prefilled_;
+    stats.threads_placed = threads_placed_.load();
+    stats.placement_failures = placement_failures_.load();
+    return stats;
+}
+
+bool TCPConnectionManager::busy_poll_pass() {
+    size_t received = poll();
+    process_pacing();
+    size_t sent = run_transmit();
+    return received > 0 || sent > 0;
+}
+
+void TCPConnectionManager::busy_poll_block(std::chrono::microseconds timeout) {
+    auto now = std::chrono::steady_clock::now();
+    auto deadline = next_pacing_deadline();
+    if (deadline <= now) {
+        return;
+    }
+    if (deadline - now < timeout) {
+        timeout = std::chrono::ceil<std::chrono::microseconds>(deadline - now);
+    }
+    ip_layer_->wait_for_packets(timeout);
+}
+
+bool TCPConnectionManager::process_icmp_message(const IPHeader& /* ip_header */,
+                                                const std::vector<uint8_t>& icmp_data) {
+    // ICMP header, then the offending IP header and 8 bytes of its TCP header
+    if (icmp_data.size() < sizeof(ICMPHeader) + sizeof(IPHeader) + 8) {
+        return false;
+    }
+    
+    ICMPHeader icmp_header;
+    std::memcpy(&icmp_header, icmp_data.data(), sizeof(ICMPHeader));
+    if (icmp_header.type != ICMPHeader::TYPE_DEST_UNREACHABLE ||
+        icmp_header.code != ICMPHeader::CODE_FRAG_NEEDED) {
+        return false;
+    }
     
-    if (listening_it != listening_sockets_.end()) {
+    IPHeader quoted;
+    std::memcpy(&quoted, icmp_data.data() + sizeof(ICMPHeader), sizeof(IPHeader));
+    size_t quoted_length = quoted.get_header_length();
+    if (quoted.protocol != IPPROTO_TCP || quoted_length < sizeof(IPHeader) ||
+        icmp_data.size() < sizeof(ICMPHeader) + quoted_length + 8) {
+        return false;
+    }
+    
+    const uint8_t* tcp_bytes = icmp_data.data() + sizeof(ICMPHeader) + quoted_length;
+    uint16_t src_port, dst_port;
+    uint32_t seq;
+    std::memcpy(&src_port, tcp_bytes, sizeof(src_port));
+    std::memcpy(&dst_port, tcp_bytes + 2, sizeof(dst_port));
+    std::memcpy(&seq, tcp_bytes + 4, sizeof(seq));
+    seq = ntohl(seq);
+    
+    auto conn = find_connection(quoted.src_ip, ntohs(src_port), quoted.dst_ip, ntohs(dst_port));
+    if (!conn) {
+        return false;
+    }
+    
+    std::lock_guard<std::recursive_mutex> lock(conn->mutex);
+    // Ignore messages quoting data that is not in flight (RFC 5927 section 4.1)
+    uint32_t snd_una = conn->reliability ? conn->reliability->get_last_ack() : conn->local_seq;
+    if (seq_lt(seq, snd_una) || seq_gt(seq, conn->local_seq)) {
+        return false;
+    }
+    
+    if (conn->path_mtu.on_packet_too_big(ntohs(icmp_header.next_hop_mtu),
+                                         ntohs(quoted.total_length))) {
+        TCP_LOG_DEBUG("Path MTU changed", "remote_ip", NetworkUtils::ip_network_to_string(conn->remote_ip),
+                      "mtu", conn->path_mtu.get_mtu());
+        update_mss(conn);
+        
+        // Resend what was dropped right away instead of waiting for the RTO
+        if (conn->reliability) {
+            conn->reliability->queue_oversized_retransmits(conn->effective_mss());
+            for (auto& segment : conn->reliability->take_fast_retransmits()) {
+                if (retransmit_segment(conn, *segment)) {
+                    conn->reliability->mark_segment_sent(segment);
+                }
+            }
+        }
+    }
+    
+    return true;
+}
+
+void TCPConnectionManager::handle_syn_segment(const IPHeader& ip_header, const TCPHeader& tcp_header,
+                                             const TCPOptions& options,
+                                             const std::vector<uint8_t>& data) {
+    // Look for listening socket
+    auto listener = find_listener(ip_header.dst_ip, tcp_header.dst_port);
+    if (listener) {
+        // A tuple already in the table is a retransmitted SYN: answer it
+        // from the connection it created instead of building another
+        auto existing = find_connection(ip_header.dst_ip, tcp_header.dst_port,
+                                        ip_header.src_ip, tcp_header.src_port);
+        if (existing) {
+            std::lock_guard<std::recursive_mutex> lock(existing->mutex);
+            if (existing->state_machine.get_state() == TCPState::SYN_RECEIVED) {
+                send_syn_ack(existing, true);
+            }
+            return;
+        }
+        
         // Create new connection
         auto new_conn = std::make_shared<TCPConnection>();
         new_conn->local_ip = ip_header.dst_ip;
@@ -240,104 +1137,388 @@ void TCPConnectionManager::handle_syn_segment(const IPHeader& ip_header, const T
         new_conn->remote_port = tcp_header.src_port;
         new_conn->remote_seq = tcp_header.seq_num;
         new_conn->local_ack = tcp_header.seq_num + 1;
-        new_conn->local_seq = NetworkUtils::generate_sequence_number();
-        new_conn->window_size = 65535;
+        new_conn->local_seq = NetworkUtils::generate_sequence_number(
+            new_conn->local_ip, new_conn->local_port, new_conn->remote_ip, new_conn->remote_port);
         new_conn->last_activity = std::chrono::steady_clock::now();
+        new_conn->config = listener->config;
+        new_conn->listener = listener;
         
+        // Fast Open: a valid cookie lets the SYN's data in at once, unless
+        // too many such connections are still half open (RFC 7413 section
+        // 5.1); a request or a stale cookie gets a fresh cookie instead
+        bool accept_data = false;
+        if (new_conn->config.fastopen && options.has_fastopen) {
+            if (fastopen_cookies_.validate(new_conn->remote_ip, options.fastopen_cookie)) {
+                // Take a slot first so concurrent SYNs can't overshoot
+                if (!data.empty()) {
+                    if (listener->fastopen_pending.fetch_add(1) < new_conn->config.fastopen_max_pending) {
+                        accept_data = true;
+                        new_conn->fastopen_slot = true;
+                    } else {
+                        listener->fastopen_pending.fetch_sub(1);
+                    }
+                }
+            } else {
+                new_conn->fastopen_cookie = fastopen_cookies_.generate(new_conn->remote_ip);
+            }
+        }
+        
+        new_conn->sack_enabled = new_conn->config.sack_permitted && options.sack_permitted;
+        init_path_mtu(new_conn);
+        init_receive_window(new_conn);
+        if (options.mss != 0) {
+            new_conn->peer_mss = options.mss;
+        }
+        // An ECN-setup SYN carries both ECE and CWR (RFC 3168 section 6.1.1)
+        new_conn->ecn_enabled = new_conn->config.ecn && tcp_header.has_flag(TCPHeader::ECE) &&
+                                tcp_header.has_flag(TCPHeader::CWR);
+        if (new_conn->config.window_scaling && options.has_window_scale) {
+            new_conn->wscale_enabled = true;
+            new_conn->snd_wscale = options.window_scale;
+        } else {
+            new_conn->rcv_wscale = 0;
+        }
+        
+        // The child starts out as a copy of the listener
+        new_conn->state_machine.process_event(TCPEvent::PASSIVE_OPEN);
         new_conn->state_machine.process_event(TCPEvent::SYN_RECEIVED);
-        connections_.push_back(new_conn);
+        
+        // Accepted SYN data is acknowledged by the SYN-ACK and readable
+        // from accept() without waiting for the handshake to finish
+        if (accept_data) {
+            new_conn->fastopen_accepted = true;
+            new_conn->local_ack += static_cast<uint32_t>(data.size());
+            deliver_data(new_conn, data);
+        }
+        
+        // Published only once complete, and locked until the SYN-ACK is out:
+        // a retransmitted SYN on another thread must not resend it first.
+        // Losing the insert means another thread took the same SYN at the
+        // same moment; it answers.
+        std::lock_guard<std::recursive_mutex> lock(new_conn->mutex);
+        if (!connections_.insert(new_conn)) {
+            receive_memory_ -= new_conn->rcv_tuner.get_buffer();
+            release_fastopen_slot(new_conn);
+            return;
+        }
         
         // Send SYN-ACK
         send_syn_ack(new_conn);
+        if (accept_data) {
+            queue_acceptable(new_conn);
+            notify_event(listener, EventPoller::ACCEPT);
+        }
     }
 }
 
-void TCPConnectionManager::handle_syn_ack_segment(const IPHeader& ip_header, const TCPHeader& tcp_header) {
-    auto conn = find_connection(ip_header.dst_ip, tcp_header.dst_port,
-                               ip_header.src_ip, tcp_header.src_port);
-    if (conn) {
+void TCPConnectionManager::handle_syn_ack_segment(std::shared_ptr<TCPConnection> conn,
+                                                 const TCPHeader& tcp_header,
+                                                 const TCPOptions& options) {
+    if (conn->state_machine.get_state() == TCPState::SYN_SENT) {
         conn->remote_seq = tcp_header.seq_num;
+        conn->peer_window = tcp_header.window_size;
         conn->local_ack = tcp_header.seq_num + 1;
+        conn->rcv_wnd_edge = conn->local_ack;
+        conn->sack_enabled = conn->config.sack_permitted && options.sack_permitted;
+        if (conn->config.window_scaling && options.has_window_scale) {
+            conn->wscale_enabled = true;
+            conn->snd_wscale = options.window_scale;
+        } else {
+            conn->rcv_wscale = 0;
+        }
+        if (options.mss != 0) {
+            conn->peer_mss = options.mss;
+        }
+        // An ECN-setup SYN-ACK carries ECE without CWR
+        conn->ecn_enabled = conn->config.ecn && tcp_header.has_flag(TCPHeader::ECE) &&
+                            !tcp_header.has_flag(TCPHeader::CWR);
+        if (conn->reliability) {
+            conn->reliability->set_sack_enabled(conn->sack_enabled);
+            conn->reliability->set_ecn_enabled(conn->ecn_enabled);
+        }
+        update_mss(conn);
+        complete_fastopen(conn, tcp_header, options);
         conn->state_machine.process_event(TCPEvent::SYN_ACK_RECEIVED);
         conn->last_activity = std::chrono::steady_clock::now();
         
-        // Send ACK to complete handshake
+        // Send ACK to complete handshake, with any data held for it
+        send_ack(conn);
+        flush_send_queue(conn);
+        notify_event(conn, EventPoller::WRITABLE);
+    } else {
+        // Our handshake ACK was lost; repeat it
         send_ack(conn);
     }
 }
 
-void TCPConnectionManager::handle_ack_segment(const IPHeader& ip_header, const TCPHeader& tcp_header) {
-    auto conn = find_connection(ip_header.dst_ip, tcp_header.dst_port,
-                               ip_header.src_ip, tcp_header.src_port);
-    if (conn) {
-        conn->state_machine.process_event(TCPEvent::ACK_RECEIVED);
-        conn->last_activity = std::chrono::steady_clock::now();
+void TCPConnectionManager::complete_fastopen(std::shared_ptr<TCPConnection> conn,
+                                            const TCPHeader& tcp_header,
+                                            const TCPOptions& options) {
+    // local_seq is just past the SYN; the SYN-ACK says how much of the
+    // data that rode with it the server took
+    uint32_t syn_acked = tcp_header.ack_num - conn->local_seq;
+    if (syn_acked > conn->fastopen_syn_bytes) {
+        syn_acked = 0;
+    }
+    
+    // Keep a cookie the server issued; a server that neither took the
+    // data nor answered the option no longer does Fast Open for us
+    if (conn->config.fastopen) {
+        if (options.has_fastopen && !options.fastopen_cookie.empty()) {
+            uint16_t mss = options.mss != 0 ? options.mss : TCPConnection::DEFAULT_PEER_MSS;
+            fastopen_cache_.store(conn->remote_ip, options.fastopen_cookie, mss);
+        } else if (!options.has_fastopen && syn_acked == 0 && conn->fastopen_syn_bytes > 0) {
+            fastopen_cache_.remove(conn->remote_ip);
+        }
+    }
+    
+    if (conn->fastopen_data.empty()) {
+        return;
+    }
+    
+    // Whatever the server did not take is sent as ordinary data
+    conn->local_seq += syn_acked;
+    if (conn->reliability) {
+        conn->reliability->set_initial_seq(conn->local_seq);
+        if (syn_acked < conn->fastopen_data.size()) {
+            conn->reliability->buffer_data(std::vector<uint8_t>(
+                conn->fastopen_data.begin() + syn_acked, conn->fastopen_data.end()));
+        }
     }
+    conn->fastopen_data.clear();
+    conn->fastopen_data.shrink_to_fit();
 }
 
-void TCPConnectionManager::handle_fin_segment(const IPHeader& ip_header, const TCPHeader& tcp_header) {
-    auto conn = find_connection(ip_header.dst_ip, tcp_header.dst_port,
-                               ip_header.src_ip, tcp_header.src_port);
-    if (conn) {
-        conn->state_machine.process_event(TCPEvent::FIN_RECEIVED);
-        conn->local_ack = tcp_header.seq_num + 1;
-        conn->last_activity = std::chrono::steady_clock::now();
-        
-        // Send ACK for FIN
-        send_ack(conn);
+void TCPConnectionManager::handle_ack_segment(std::shared_ptr<TCPConnection> conn,
+                                             const TCPHeader& tcp_header,
+                                             size_t payload_length, const TCPOptions& options) {
+    bool handshake = conn->state_machine.get_state() == TCPState::SYN_RECEIVED;
+    conn->state_machine.process_event(TCPEvent::ACK_RECEIVED);
+    conn->last_activity = std::chrono::steady_clock::now();
+    conn->peer_window = tcp_header.window_size;
+    if (handshake && conn->state_machine.get_state() != TCPState::SYN_RECEIVED) {
+        release_fastopen_slot(conn);
+    }
+    if (handshake && conn->state_machine.is_established()) {
+        notify_acceptable(conn);
     }
+    
+    process_ack(conn, tcp_header, payload_length, options.sack_blocks);
 }
 
-void TCPConnectionManager::handle_rst_segment(const IPHeader& ip_header, const TCPHeader& tcp_header) {
-    auto conn = find_connection(ip_header.dst_ip, tcp_header.dst_port,
-                               ip_header.src_ip, tcp_header.src_port);
-    if (conn) {
-        conn->state_machine.process_event(TCPEvent::RST_RECEIVED);
-        remove_connection(conn);
+void TCPConnectionManager::process_ack(std::shared_ptr<TCPConnection> conn,
+                                      const TCPHeader& tcp_header, size_t payload_length,
+                                      const std::vector<SackBlock>& sack_blocks) {
+    if (!conn->reliability) {
+        return;
     }
+    
+    uint32_t window = static_cast<uint32_t>(tcp_header.window_size) << conn->snd_wscale;
+    bool ece = conn->ecn_enabled && tcp_header.has_flag(TCPHeader::ECE);
+    conn->reliability->process_ack(tcp_header.ack_num, window, payload_length, sack_blocks, ece);
+    if (conn->path_mtu.on_ack(tcp_header.ack_num)) {
+        update_mss(conn);
+    }
+    
+    // Fast retransmit / NewReno partial ACK: resend without waiting for RTO
+    for (auto& segment : conn->reliability->take_fast_retransmits()) {
+        if (retransmit_segment(conn, *segment)) {
+            conn->reliability->mark_segment_sent(segment);
+        }
+    }
+    
+    // The ACK may have opened the window or released a Nagle-held segment
+    flush_send_queue(conn);
 }
 
-void TCPConnectionManager::handle_data_segment(const IPHeader& ip_header, const TCPHeader& tcp_header,
-                                              const std::vector<uint8_t>& data) {
-    auto conn = find_connection(ip_header.dst_ip, tcp_header.dst_port,
-                               ip_header.src_ip, tcp_header.src_port);
-    if (conn && conn->state_machine.can_receive_data()) {
-        conn->local_ack = tcp_header.seq_num + data.size();
-        conn->last_activity = std::chrono::steady_clock::now();
-        
-        // Send ACK for received data
+void TCPConnectionManager::handle_fin_segment(std::shared_ptr<TCPConnection> conn,
+                                             const TCPHeader& tcp_header, size_t payload_length) {
+    // The FIN follows the segment's data; one that arrives ahead of a gap
+    // is ignored and will be retransmitted
+    uint32_t fin_seq = tcp_header.seq_num + static_cast<uint32_t>(payload_length);
+    if (fin_seq != conn->local_ack) {
+        return;
+    }
+    
+    conn->state_machine.process_event(TCPEvent::FIN_RECEIVED);
+    conn->local_ack = fin_seq + 1;
+    conn->last_activity = std::chrono::steady_clock::now();
+    
+    // ACK the FIN, ideally piggybacked on our own FIN or response
+    schedule_ack(conn, 0, false);
+    notify_event(conn, EventPoller::READABLE);
+}
+
+void TCPConnectionManager::handle_rst_segment(std::shared_ptr<TCPConnection> conn) {
+    conn->state_machine.process_event(TCPEvent::RST_RECEIVED);
+    remove_connection(conn);
+    notify_event(conn, EventPoller::ERROR);
+}
+
+void TCPConnectionManager::handle_data_segment(std::shared_ptr<TCPConnection> conn,
+                                              const ReceivedSegment& segment) {
+    if (!conn->state_machine.can_receive_data()) {
+        return;
+    }
+    
+    const std::vector<uint8_t>& data = segment.payload;
+    uint32_t seq = segment.tcp_header.seq_num;
+    uint32_t end = seq + static_cast<uint32_t>(data.size());
+    conn->last_activity = std::chrono::steady_clock::now();
+    
+    if (seq_gt(seq, conn->local_ack)) {
+        // Out of order: hold it until the gap fills, within our window
+        if (seq_leq(end, conn->local_ack + conn->window_size)) {
+            conn->reassembly.insert(seq, data.data(), data.size());
+        }
+        conn->quick_acks_remaining = TCPConnection::QUICK_ACK_SEGMENTS;
+    } else if (seq_gt(end, conn->local_ack)) {
+        // In order (possibly overlapping what we already have)
+        receive_in_order(conn, segment, conn->local_ack - seq);
+        return;
+    }
+    
+    // Out-of-order and duplicate segments are ACKed at once so the
+    // sender's loss recovery is not delayed (RFC 5681 4.2)
+    schedule_ack(conn, data.size(), true, segment.segment_count);
+}
+
+void TCPConnectionManager::receive_in_order(std::shared_ptr<TCPConnection> conn,
+                                            const ReceivedSegment& segment, size_t offset) {
+    const std::vector<uint8_t>& data = segment.payload;
+    
+    // A segment that fills a gap is ACKed at once (RFC 5681 4.2)
+    bool filled_gap = !conn->reassembly.empty();
+    std::vector<uint8_t> in_order(data.begin() + offset, data.end());
+    conn->local_ack = segment.tcp_header.seq_num + static_cast<uint32_t>(data.size());
+    if (filled_gap) {
+        conn->reassembly.take_in_order(conn->local_ack, in_order);
+    }
+    deliver_data(conn, std::move(in_order));
+    conn->rcv_tuner.on_data_received(conn->local_ack, conn->window_size,
+                                     std::chrono::steady_clock::now());
+    
+    // Sized by wire segment, not by what GRO merged
+    uint16_t segment_size = segment.max_segment_size != 0 ? segment.max_segment_size :
+        static_cast<uint16_t>(std::min<size_t>(data.size(), UINT16_MAX));
+    conn->rcv_mss = std::max(conn->rcv_mss, segment_size);
+    
+    schedule_ack(conn, data.size(), filled_gap, segment.segment_count);
+}
+
+void TCPConnectionManager::schedule_ack(std::shared_ptr<TCPConnection> conn,
+                                       size_t segment_length, bool immediate,
+                                       uint16_t segment_count) {
+    conn->ack_pending_bytes += static_cast<uint32_t>(segment_length);
+    
+    // ACK at least every second full-sized segment; while the peer is in
+    // slow start (quick-ACK budget left) ACK every segment
+    bool ack_now = immediate || !conn->config.delayed_ack || conn->config.quick_ack ||
+                   conn->quick_acks_remaining > 0 ||
+                   conn->ack_pending_bytes >= 2u * conn->rcv_mss;
+    
+    if (ack_now) {
+        if (!immediate && conn->quick_acks_remaining > 0) {
+            conn->quick_acks_remaining -= static_cast<uint8_t>(
+                std::min<uint16_t>(segment_count, conn->quick_acks_remaining));
+        }
         send_ack(conn);
-        
-        // TODO: Buffer data for application
-        std::cout << "Received " << data.size() << " bytes of data" << std::endl;
+    } else if (conn->ack_deadline == std::chrono::steady_clock::time_point::max()) {
+        conn->ack_deadline = std::chrono::steady_clock::now() + conn->config.delayed_ack_timeout;
+    }
+}
+
+void TCPConnectionManager::deliver_data(std::shared_ptr<TCPConnection> conn,
+                                       std::vector<uint8_t> data) {
+    if (data.empty()) {
+        return;
+    }
+    
+    conn->rcv_queued += static_cast<uint32_t>(data.size());
+    apply_memory_pressure(conn);
+    
+    if (conn->data_handler) {
+        conn->data_handler(data);
+    } else {
+        conn->pending_data.insert(conn->pending_data.end(), data.begin(), data.end());
     }
 }
 
 // Send specific TCP segments
+// Control segments go out regardless of whether the state allows data
 bool TCPConnectionManager::send_syn(std::shared_ptr<TCPConnection> conn) {
-    return send_segment(conn, {}, TCPHeader::SYN);
+    uint8_t flags = TCPHeader::SYN;
+    if (conn->config.ecn) {
+        flags |= TCPHeader::ECE | TCPHeader::CWR;
+    }
+    
+    // Fast Open: with a cached cookie the first request rides in the SYN,
+    // as much as fits the server's MSS beside the options; without one
+    // the SYN asks for a cookie
+    std::vector<uint8_t> syn_data;
+    FastOpenCookieCache::Entry entry;
+    if (conn->config.fastopen && fastopen_cache_.lookup(conn->remote_ip, entry)) {
+        conn->fastopen_cookie = entry.cookie;
+        size_t option_bytes = build_options(conn, TCPHeader::SYN).serialize().size();
+        size_t mss = std::min<size_t>(entry.mss, conn->path_mtu.get_mss());
+        size_t room = mss > option_bytes ? mss - option_bytes : 0;
+        conn->fastopen_syn_bytes = std::min(conn->fastopen_data.size(), room);
+        syn_data.assign(conn->fastopen_data.begin(),
+                        conn->fastopen_data.begin() + conn->fastopen_syn_bytes);
+    }
+    
+    if (!transmit_segment(conn, conn->local_seq, syn_data, flags)) {
+        return false;
+    }
+    // The SYN occupies one sequence number; its data counts once acknowledged
+    conn->local_seq += 1;
+    return true;
 }
 
-bool TCPConnectionManager::send_syn_ack(std::shared_ptr<TCPConnection> conn) {
-    return send_segment(conn, {}, TCPHeader::SYN | TCPHeader::ACK);
+bool TCPConnectionManager::send_syn_ack(std::shared_ptr<TCPConnection> conn, bool retransmit) {
+    uint8_t flags = TCPHeader::SYN | TCPHeader::ACK;
+    if (conn->ecn_enabled) {
+        flags |= TCPHeader::ECE;
+    }
+    // A resent SYN-ACK reuses the ISN; the SYN's sequence number is
+    // already taken
+    if (retransmit) {
+        return transmit_segment(conn, conn->local_seq - 1, {}, flags);
+    }
+    if (!transmit_segment(conn, conn->local_seq, {}, flags)) {
+        return false;
+    }
+    conn->local_seq += 1;
+    return true;
 }
 
 bool TCPConnectionManager::send_ack(std::shared_ptr<TCPConnection> conn) {
-    return send_segment(conn, {}, TCPHeader::ACK);
+    return transmit_segment(conn, conn->local_seq, {}, TCPHeader::ACK);
 }
 
 bool TCPConnectionManager::send_fin(std::shared_ptr<TCPConnection> conn) {
-    return send_segment(conn, {}, TCPHeader::FIN | TCPHeader::ACK);
+    return transmit_segment(conn, conn->local_seq, {}, TCPHeader::FIN | TCPHeader::ACK);
 }
 
 bool TCPConnectionManager::send_rst(std::shared_ptr<TCPConnection> conn) {
-    return send_segment(conn, {}, TCPHeader::RST);
+    return transmit_segment(conn, conn->local_seq, {}, TCPHeader::RST);
 }
 
 void TCPConnectionManager::remove_connection(std::shared_ptr<TCPConnection> conn) {
-    connections_.erase(
-        std::remove(connections_.begin(), connections_.end(), conn),
-        connections_.end());
+    if (connections_.remove(conn)) {
+        receive_memory_ -= std::min<size_t>(receive_memory_, conn->rcv_tuner.get_buffer());
+    }
+    release_fastopen_slot(conn);
+    drop_acceptable(conn);
+}
+
+void TCPConnectionManager::release_fastopen_slot(std::shared_ptr<TCPConnection> conn) {
+    if (!conn->fastopen_slot.exchange(false)) {
+        return;
+    }
+    if (auto listener = conn->listener.lock()) {
+        listener->fastopen_pending.fetch_sub(1);
+    }
 }
 
 } // namespace tcp_stack
\ No newline at end of file
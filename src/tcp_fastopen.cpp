@@ -0,0 +1,85 @@
+#include "tcp_fastopen.h"
+#include <cstring>
+
+namespace tcp_stack {
+
+FastOpenCookieGenerator::FastOpenCookieGenerator()
+    : key_(SipHashKey::random()), has_previous_key_(false) {
+}
+
+std::vector<uint8_t> FastOpenCookieGenerator::make_cookie(const SipHashKey& key, uint32_t client_ip) {
+    uint64_t mac = siphash24(key, &client_ip, sizeof(client_ip));
+    std::vector<uint8_t> cookie(COOKIE_LENGTH);
+    std::memcpy(cookie.data(), &mac, COOKIE_LENGTH);
+    return cookie;
+}
+
+std::vector<uint8_t> FastOpenCookieGenerator::generate(uint32_t client_ip) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return make_cookie(key_, client_ip);
+}
+
+bool FastOpenCookieGenerator::validate(uint32_t client_ip, const std::vector<uint8_t>& cookie) const {
+    if (cookie.size() != COOKIE_LENGTH) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cookie == make_cookie(key_, client_ip) ||
+           (has_previous_key_ && cookie == make_cookie(previous_key_, client_ip));
+}
+
+void FastOpenCookieGenerator::rotate_key() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    previous_key_ = key_;
+    has_previous_key_ = true;
+    key_ = SipHashKey::random();
+}
+
+FastOpenCookieCache::FastOpenCookieCache(size_t capacity)
+    : capacity_(capacity == 0 ? 1 : capacity) {
+}
+
+bool FastOpenCookieCache::lookup(uint32_t server_ip, Entry& entry) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(server_ip);
+    if (it == entries_.end()) {
+        return false;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second.second);
+    entry = it->second.first;
+    return true;
+}
+
+void FastOpenCookieCache::store(uint32_t server_ip, const std::vector<uint8_t>& cookie, uint16_t mss) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(server_ip);
+    if (it != entries_.end()) {
+        it->second.first.cookie = cookie;
+        it->second.first.mss = mss;
+        lru_.splice(lru_.begin(), lru_, it->second.second);
+        return;
+    }
+    
+    if (entries_.size() >= capacity_) {
+        entries_.erase(lru_.back());
+        lru_.pop_back();
+    }
+    lru_.push_front(server_ip);
+    entries_[server_ip] = {Entry{cookie, mss}, lru_.begin()};
+}
+
+void FastOpenCookieCache::remove(uint32_t server_ip) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(server_ip);
+    if (it != entries_.end()) {
+        lru_.erase(it->second.second);
+        entries_.erase(it);
+    }
+}
+
+size_t FastOpenCookieCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+} // namespace tcp_stack
\ No newline at end of file
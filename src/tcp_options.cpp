@@ -0,0 +1,142 @@
+#include "tcp_options.h"
+#include <arpa/inet.h>
+#include <algorithm>
+#include <cstring>
+
+namespace tcp_stack {
+
+bool TCPOptions::parse(const uint8_t* data, size_t length, TCPOptions& options) {
+    options = TCPOptions();
+    
+    size_t pos = 0;
+    while (pos < length) {
+        uint8_t kind = data[pos];
+        
+        if (kind == KIND_EOL) {
+            break;
+        }
+        if (kind == KIND_NOP) {
+            pos++;
+            continue;
+        }
+        
+        // Every other option carries a length byte covering kind and length
+        if (pos + 1 >= length) {
+            return false;
+        }
+        uint8_t option_length = data[pos + 1];
+        if (option_length < 2 || pos + option_length > length) {
+            return false;
+        }
+        
+        const uint8_t* value = data + pos + 2;
+        size_t value_length = option_length - 2;
+        
+        switch (kind) {
+            case KIND_MSS: {
+                if (value_length != 2) {
+                    return false;
+                }
+                uint16_t mss;
+                std::memcpy(&mss, value, sizeof(mss));
+                options.mss = ntohs(mss);
+                break;
+            }
+                
+            case KIND_WINDOW_SCALE:
+                if (value_length != 1) {
+                    return false;
+                }
+                // Larger shifts are treated as the maximum (RFC 7323 section 2.3)
+                options.has_window_scale = true;
+                options.window_scale = std::min(value[0], MAX_WINDOW_SCALE);
+                break;
+                
+            case KIND_SACK_PERMITTED:
+                if (value_length != 0) {
+                    return false;
+                }
+                options.sack_permitted = true;
+                break;
+                
+            case KIND_SACK:
+                if (value_length == 0 || value_length % 8 != 0) {
+                    return false;
+                }
+                for (size_t i = 0; i < value_length; i += 8) {
+                    uint32_t start, end;
+                    std::memcpy(&start, value + i, sizeof(start));
+                    std::memcpy(&end, value + i + 4, sizeof(end));
+                    options.sack_blocks.push_back({ntohl(start), ntohl(end)});
+                }
+                break;
+                
+            case KIND_FASTOPEN:
+                // A request, or a cookie of 4 to 16 bytes in 2-byte steps
+                if (value_length != 0 && (value_length < 4 || value_length > 16 ||
+                                          value_length % 2 != 0)) {
+                    return false;
+                }
+                options.has_fastopen = true;
+                options.fastopen_cookie.assign(value, value + value_length);
+                break;
+                
+            default:
+                // Unknown options are skipped (RFC 793 section 3.1)
+                break;
+        }
+        
+        pos += option_length;
+    }
+    
+    return true;
+}
+
+std::vector<uint8_t> TCPOptions::serialize() const {
+    std::vector<uint8_t> out;
+    out.reserve(MAX_LENGTH);
+    
+    if (mss != 0) {
+        out.insert(out.end(), {KIND_MSS, 4, static_cast<uint8_t>(mss >> 8),
+                               static_cast<uint8_t>(mss & 0xFF)});
+    }
+    
+    if (sack_permitted) {
+        out.insert(out.end(), {KIND_NOP, KIND_NOP, KIND_SACK_PERMITTED, 2});
+    }
+    
+    if (has_window_scale) {
+        out.insert(out.end(), {KIND_NOP, KIND_WINDOW_SCALE, 3, window_scale});
+    }
+    
+    if (has_fastopen) {
+        out.insert(out.end(), {KIND_FASTOPEN, static_cast<uint8_t>(2 + fastopen_cookie.size())});
+        out.insert(out.end(), fastopen_cookie.begin(), fastopen_cookie.end());
+    }
+    
+    if (!sack_blocks.empty()) {
+        // NOP NOP keeps the 32-bit block edges aligned
+        size_t room = (MAX_LENGTH - out.size() - 4) / 8;
+        size_t count = std::min({sack_blocks.size(), MAX_SACK_BLOCKS, room});
+        if (count > 0) {
+            out.insert(out.end(), {KIND_NOP, KIND_NOP, KIND_SACK,
+                                   static_cast<uint8_t>(2 + 8 * count)});
+            for (size_t i = 0; i < count; ++i) {
+                uint32_t start = htonl(sack_blocks[i].start);
+                uint32_t end = htonl(sack_blocks[i].end);
+                const uint8_t* s = reinterpret_cast<const uint8_t*>(&start);
+                const uint8_t* e = reinterpret_cast<const uint8_t*>(&end);
+                out.insert(out.end(), s, s + 4);
+                out.insert(out.end(), e, e + 4);
+            }
+        }
+    }
+    
+    while (out.size() % 4 != 0) {
+        out.push_back(KIND_NOP);
+    }
+    
+    return out;
+}
+
+} // namespace tcp_stack
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "tcp_reassembly.h"
+#include <algorithm>
+
+namespace tcp_stack {
+
+TCPReassemblyQueue::TCPReassemblyQueue() : buffered_bytes_(0), last_received_seq_(0) {}
+
+void TCPReassemblyQueue::insert(uint32_t seq, const uint8_t* data, size_t length) {
+    if (length == 0) {
+        return;
+    }
+    
+    last_received_seq_ = seq;
+    
+    // Retransmissions may repeat a segment; keep the longer copy
+    auto it = segments_.find(seq);
+    if (it != segments_.end()) {
+        if (it->second.size() >= length) {
+            return;
+        }
+        buffered_bytes_ -= it->second.size();
+        it->second.assign(data, data + length);
+    } else {
+        segments_.emplace(seq, std::vector<uint8_t>(data, data + length));
+    }
+    buffered_bytes_ += length;
+}
+
+void TCPReassemblyQueue::take_in_order(uint32_t& rcv_nxt, std::vector<uint8_t>& out) {
+    auto it = segments_.begin();
+    while (it != segments_.end() && seq_leq(it->first, rcv_nxt)) {
+        uint32_t end = it->first + static_cast<uint32_t>(it->second.size());
+        if (seq_gt(end, rcv_nxt)) {
+            // Skip any prefix that overlaps data already delivered
+            size_t offset = rcv_nxt - it->first;
+            out.insert(out.end(), it->second.begin() + offset, it->second.end());
+            rcv_nxt = end;
+        }
+        buffered_bytes_ -= it->second.size();
+        it = segments_.erase(it);
+    }
+}
+
+std::vector<SackBlock> TCPReassemblyQueue::sack_blocks(size_t max_blocks) const {
+    // Merge overlapping and adjacent segments into contiguous blocks
+    std::vector<SackBlock> blocks;
+    for (const auto& entry : segments_) {
+        uint32_t start = entry.first;
+        uint32_t end = start + static_cast<uint32_t>(entry.second.size());
+        if (!blocks.empty() && seq_leq(start, blocks.back().end)) {
+            if (seq_gt(end, blocks.back().end)) {
+                blocks.back().end = end;
+            }
+        } else {
+            blocks.push_back({start, end});
+        }
+    }
+    
+    // Report the block covering the latest arrival first
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        if (seq_geq(last_received_seq_, blocks[i].start) &&
+            seq_lt(last_received_seq_, blocks[i].end)) {
+            std::rotate(blocks.begin(), blocks.begin() + i, blocks.begin() + i + 1);
+            break;
+        }
+    }
+    
+    if (blocks.size() > max_blocks) {
+        blocks.resize(max_blocks);
+    }
+    return blocks;
+}
+
+void TCPReassemblyQueue::clear() {
+    segments_.clear();
+    buffered_bytes_ = 0;
+}
+
+} // namespace tcp_stack
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include "tcp_receive_coalescer.h"
+#include <algorithm>
+#include <utility>
+
+namespace tcp_stack {
+
+void TCPReceiveCoalescer::add(ReceivedSegment&& segment) {
+    if (segment.max_segment_size == 0) {
+        segment.max_segment_size = static_cast<uint16_t>(
+            std::min<size_t>(segment.payload.size(), UINT16_MAX));
+    }
+    
+    // Only the flow's most recent entry can be extended; anything older
+    // would reorder it past a segment that could not be merged
+    for (auto it = segments_.rbegin(); it != segments_.rend(); ++it) {
+        if (!same_flow(*it, segment)) {
+            continue;
+        }
+        if (can_merge(*it, segment)) {
+            it->payload.insert(it->payload.end(), segment.payload.begin(), segment.payload.end());
+            it->tcp_header.flags = segment.tcp_header.flags;  // Carries PSH if the run ends here
+            it->segment_count++;
+            it->max_segment_size = std::max(it->max_segment_size, segment.max_segment_size);
+            return;
+        }
+        break;
+    }
+    
+    segments_.push_back(std::move(segment));
+}
+
+std::vector<ReceivedSegment> TCPReceiveCoalescer::flush() {
+    std::vector<ReceivedSegment> segments;
+    segments.swap(segments_);
+    return segments;
+}
+
+bool TCPReceiveCoalescer::same_flow(const ReceivedSegment& a, const ReceivedSegment& b) {
+    return a.ip_header.src_ip == b.ip_header.src_ip &&
+           a.ip_header.dst_ip == b.ip_header.dst_ip &&
+           a.tcp_header.src_port == b.tcp_header.src_port &&
+           a.tcp_header.dst_port == b.tcp_header.dst_port;
+}
+
+bool TCPReceiveCoalescer::can_merge(const ReceivedSegment& run, const ReceivedSegment& next) {
+    const TCPHeader& a = run.tcp_header;
+    const TCPHeader& b = next.tcp_header;
+    
+    // Plain data on both sides; a PSH closes the run
+    if (a.flags != TCPHeader::ACK ||
+        (b.flags != TCPHeader::ACK && b.flags != (TCPHeader::ACK | TCPHeader::PSH))) {
+        return false;
+    }
+    if (run.payload.empty() || next.payload.empty()) {
+        return false;
+    }
+    if (!run.options.empty() || !next.options.empty()) {
+        return false;
+    }
+    
+    // Same ACK, window and ECN codepoint, contiguous sequence numbers
+    return a.ack_num == b.ack_num && a.window_size == b.window_size &&
+           run.ip_header.tos == next.ip_header.tos &&
+           b.seq_num == a.seq_num + static_cast<uint32_t>(run.payload.size()) &&
+           run.payload.size() + next.payload.size() <= MAX_COALESCED_BYTES;
+}
+
+} // namespace tcp_stack
\ No newline at end of file
@@ -1,19 +1,73 @@
 #include "tcp_reliability.h"
+#include "tcp_sequence.h"
+#include "logger.h"
 #include <algorithm>
-#include <iostream>
 
 namespace tcp_stack {
 
 TCPReliability::TCPReliability()
-    : next_seq_num_(0), last_ack_received_(0), rto_(std::chrono::milliseconds(1000)),
-      srtt_(std::chrono::milliseconds(0)), rttvar_(std::chrono::milliseconds(0)),
-      max_retransmits_(3), send_window_size_(65535), remote_window_size_(65535),
-      bytes_in_flight_(0) {}
+    : next_seq_num_(0), last_ack_received_(0), rto_(DEFAULT_INITIAL_RTO),
+      min_rto_(DEFAULT_MIN_RTO), clock_granularity_(DEFAULT_CLOCK_GRANULARITY),
+      srtt_us_(0), rttvar_us_(0), has_rtt_sample_(false), max_retransmits_(3),
+      send_window_size_(DEFAULT_SEND_WINDOW), remote_window_size_(65535),
+      bytes_in_flight_(0), mss_(DEFAULT_MSS), cwnd_(DEFAULT_MSS * INITIAL_CWND_SEGMENTS),
+      ssthresh_(UINT32_MAX), dup_ack_count_(0), in_fast_recovery_(false), recover_(0),
+      ecn_enabled_(false), congestion_control_(CongestionControl::NEW_RENO), ecn_recover_(0),
+      cwr_pending_(false), ecn_reductions_(0), sack_enabled_(false), high_rxt_(0), loss_detection_(LossDetection::DUP_ACK),
+      rack_has_sample_(false), rack_end_seq_(0), rack_rtt_(0), rack_min_rtt_(0),
+      reorder_deadline_(std::chrono::steady_clock::time_point::max()),
+      tlp_deadline_(std::chrono::steady_clock::time_point::max()),
+      tlp_in_progress_(false), tlp_end_seq_(0), tlp_probe_count_(0) {}
+
+void TCPReliability::set_initial_seq(uint32_t seq) {
+    next_seq_num_ = seq;
+    last_ack_received_ = seq;
+    // recover starts just below the ISN so that a loss in the very first
+    // window still qualifies for fast retransmit (RFC 6582 section 3.2)
+    recover_ = seq - 1;
+    ecn_recover_ = seq;
+    dctcp_.reset(seq);
+}
+
+void TCPReliability::set_congestion_control(CongestionControl algorithm) {
+    congestion_control_ = algorithm;
+    dctcp_.reset(next_seq_num_);
+}
+
+bool TCPReliability::take_cwr() {
+    bool pending = cwr_pending_;
+    cwr_pending_ = false;
+    return pending;
+}
+
+void TCPReliability::set_mss(uint16_t mss) {
+    if (mss == 0) {
+        return;
+    }
+    mss_ = mss;
+    
+    // Nothing sent yet: restart the initial window at the new segment size
+    if (bytes_in_flight_ == 0 && next_seq_num_ == last_ack_received_) {
+        cwnd_ = static_cast<uint32_t>(mss_) * INITIAL_CWND_SEGMENTS;
+    }
+}
 
 void TCPReliability::process_ack(uint32_t ack_num) {
-    if (ack_num > last_ack_received_) {
+    process_ack(ack_num, remote_window_size_, 0);
+}
+
+void TCPReliability::process_ack(uint32_t ack_num, uint32_t window, size_t payload_length,
+                                 const std::vector<SackBlock>& sack_blocks, bool ece) {
+    if (seq_gt(ack_num, next_seq_num_)) {
+        return; // Acknowledges data we never sent
+    }
+    
+    bool new_sack_info = update_scoreboard(sack_blocks);
+    
+    if (seq_gt(ack_num, last_ack_received_)) {
         uint32_t newly_acked_bytes = ack_num - last_ack_received_;
         last_ack_received_ = ack_num;
+        remote_window_size_ = window;
         
         // Remove acknowledged segments
         remove_acknowledged_segments(ack_num);
@@ -25,48 +79,111 @@ void TCPReliability::process_ack(uint32_t ack_num) {
             bytes_in_flight_ = 0;
         }
         
-        std::cout << "ACK received for seq " << ack_num 
-                 << ", bytes in flight: " << bytes_in_flight_ << std::endl;
+        on_new_ack(newly_acked_bytes);
+        if (ecn_enabled_) {
+            on_ecn_echo(newly_acked_bytes, ece);
+        }
+        
+        // The probe's episode is over once everything up to it is acked.
+        // Without D-SACK we cannot tell whether the original got through,
+        // so assume the probe repaired a loss (RFC 8985 section 7.6.2).
+        if (tlp_in_progress_ && seq_geq(ack_num, tlp_end_seq_)) {
+            tlp_in_progress_ = false;
+            reduce_congestion_window();
+        }
+        
+        TCP_LOG_TRACE("ACK received", "ack", ack_num, "bytes_in_flight", bytes_in_flight_);
+    } else if (ack_num == last_ack_received_) {
+        // RFC 5681 section 2: no data, no window change, data outstanding.
+        // With SACK, new SACK information also marks a duplicate (RFC 6675).
+        bool duplicate = payload_length == 0 && bytes_in_flight_ > 0 &&
+                         (window == remote_window_size_ || new_sack_info);
+        remote_window_size_ = window;
+        
+        if (duplicate) {
+            on_duplicate_ack();
+        }
+        if (ecn_enabled_) {
+            on_ecn_echo(0, ece);
+        }
+    }
+    
+    if (loss_detection_ == LossDetection::RACK_TLP) {
+        auto now = std::chrono::steady_clock::now();
+        if (new_sack_info) {
+            for (const auto& segment : unacked_segments_) {
+                if (is_segment_sacked(*segment)) {
+                    rack_update(*segment, now);
+                }
+            }
+        }
+        rack_detect_loss(now);
+        arm_tlp(now);
     }
 }
 
 bool TCPReliability::is_seq_acknowledged(uint32_t seq_num) const {
-    return seq_num < last_ack_received_;
+    return seq_lt(seq_num, last_ack_received_);
 }
 
 bool TCPReliability::can_send_data(size_t data_size) const {
-    uint16_t effective_window = get_effective_window();
-    return (bytes_in_flight_ + data_size) <= effective_window;
+    uint32_t effective_window = get_effective_window();
+    return (get_flight_size() + data_size) <= effective_window;
 }
 
 void TCPReliability::buffer_data(const std::vector<uint8_t>& data) {
-    for (uint8_t byte : data) {
-        send_buffer_.push(byte);
-    }
+    send_buffer_.insert(send_buffer_.end(), data.begin(), data.end());
 }
 
 std::vector<uint8_t> TCPReliability::get_data_to_send(size_t max_size) {
-    std::vector<uint8_t> data;
-    size_t available_window = get_effective_window() - bytes_in_flight_;
-    size_t to_send = std::min({max_size, available_window, send_buffer_.size()});
+    size_t to_send = std::min({max_size, get_available_window(), send_buffer_.size()});
+    if (to_send == 0) {
+        return {};
+    }
+    return take_segment(to_send)->data;
+}
+
+std::vector<std::shared_ptr<TCPSegment>> TCPReliability::get_burst_to_send(size_t max_bytes,
+                                                                           size_t segment_size) {
+    std::vector<std::shared_ptr<TCPSegment>> segments;
+    if (segment_size == 0) {
+        return segments;
+    }
     
-    data.reserve(to_send);
-    for (size_t i = 0; i < to_send && !send_buffer_.empty(); ++i) {
-        data.push_back(send_buffer_.front());
-        send_buffer_.pop();
+    size_t remaining = std::min({max_bytes, get_available_window(), send_buffer_.size()});
+    segments.reserve((remaining + segment_size - 1) / segment_size);
+    while (remaining > 0) {
+        size_t length = std::min(segment_size, remaining);
+        segments.push_back(take_segment(length));
+        remaining -= length;
     }
+    return segments;
+}
+
+size_t TCPReliability::get_available_window() const {
+    uint32_t effective_window = get_effective_window();
+    uint32_t flight_size = get_flight_size();
+    return effective_window > flight_size ? effective_window - flight_size : 0;
+}
+
+std::shared_ptr<TCPSegment> TCPReliability::take_segment(size_t length) {
+    auto end = send_buffer_.begin() + length;
+    auto segment = std::make_shared<TCPSegment>(next_seq_num_,
+                                                std::vector<uint8_t>(send_buffer_.begin(), end));
+    send_buffer_.erase(send_buffer_.begin(), end);
     
-    if (!data.empty()) {
-        // Create segment for tracking
-        auto segment = std::make_shared<TCPSegment>(next_seq_num_, data);
-        unacked_segments_.push_back(segment);
-        
-        // Update sequence number and bytes in flight
-        advance_seq(data.size());
-        bytes_in_flight_ += data.size();
+    // Track for retransmission
+    unacked_segments_.push_back(segment);
+    
+    // Update sequence number and bytes in flight
+    advance_seq(length);
+    bytes_in_flight_ += length;
+    
+    if (loss_detection_ == LossDetection::RACK_TLP && !tlp_in_progress_) {
+        arm_tlp(segment->sent_time);
     }
     
-    return data;
+    return segment;
 }
 
 std::vector<std::shared_ptr<TCPSegment>> TCPReliability::get_segments_to_retransmit() {
@@ -74,7 +191,7 @@ std::vector<std::shared_ptr<TCPSegment>> TCPReliability::get_segments_to_retrans
     auto now = std::chrono::steady_clock::now();
     
     for (auto& segment : unacked_segments_) {
-        if (!segment->acknowledged && 
+        if (!segment->acknowledged && !is_segment_sacked(*segment) &&
             (now - segment->sent_time) > rto_ &&
             segment->retransmit_count < max_retransmits_) {
             
@@ -82,6 +199,21 @@ std::vector<std::shared_ptr<TCPSegment>> TCPReliability::get_segments_to_retrans
         }
     }
     
+    if (!segments_to_retx.empty()) {
+        // RFC 5681 section 3.1: collapse to one segment after an RTO
+        ssthresh_ = std::max(bytes_in_flight_ / 2, 2u * mss_);
+        cwnd_ = mss_;
+        dup_ack_count_ = 0;
+        in_fast_recovery_ = false;
+        recover_ = next_seq_num_;
+        high_rxt_ = last_ack_received_;
+        fast_retransmit_queue_.clear();
+        
+        reorder_deadline_ = std::chrono::steady_clock::time_point::max();
+        tlp_deadline_ = std::chrono::steady_clock::time_point::max();
+        tlp_in_progress_ = false;
+    }
+    
     return segments_to_retx;
 }
 
@@ -90,6 +222,12 @@ void TCPReliability::mark_segment_sent(std::shared_ptr<TCPSegment> segment) {
     segment->retransmit_count++;
 }
 
+std::vector<std::shared_ptr<TCPSegment>> TCPReliability::take_fast_retransmits() {
+    std::vector<std::shared_ptr<TCPSegment>> segments;
+    segments.swap(fast_retransmit_queue_);
+    return segments;
+}
+
 bool TCPReliability::has_timeout() const {
     auto now = std::chrono::steady_clock::now();
     
@@ -104,58 +242,466 @@ bool TCPReliability::has_timeout() const {
     return false;
 }
 
-void TCPReliability::update_rtt(std::chrono::milliseconds rtt) {
-    if (srtt_.count() == 0) {
-        // First RTT measurement
-        srtt_ = rtt;
-        rttvar_ = rtt / 2;
+void TCPReliability::update_rtt(std::chrono::microseconds rtt) {
+    // Sub-microsecond samples still count as a measurement
+    int64_t m = std::max<int64_t>(rtt.count(), 1);
+    m = std::min<int64_t>(m, MAX_RTO.count());
+    
+    if (!has_rtt_sample_) {
+        // First RTT measurement: SRTT = R, RTTVAR = R/2
+        srtt_us_ = static_cast<uint32_t>(m << SRTT_SHIFT);
+        rttvar_us_ = static_cast<uint32_t>((m << RTTVAR_SHIFT) / 2);
+        has_rtt_sample_ = true;
     } else {
-        // RFC 6298 RTT estimation
-        auto rtt_diff = std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::duration<double, std::milli>(std::abs(srtt_.count() - rtt.count())));
+        // RFC 6298 RTT estimation on scaled integers:
+        //   RTTVAR = 3/4 * RTTVAR + 1/4 * |SRTT - R|
+        //   SRTT   = 7/8 * SRTT   + 1/8 * R
+        int64_t err = m - static_cast<int64_t>(srtt_us_ >> SRTT_SHIFT);
+        int64_t abs_err = err < 0 ? -err : err;
         
-        rttvar_ = std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::duration<double, std::milli>(
-                (1.0 - RTT_BETA) * rttvar_.count() + RTT_BETA * rtt_diff.count()));
-        
-        srtt_ = std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::duration<double, std::milli>(
-                (1.0 - RTT_ALPHA) * srtt_.count() + RTT_ALPHA * rtt.count()));
+        rttvar_us_ = static_cast<uint32_t>(
+            static_cast<int64_t>(rttvar_us_) + abs_err - (rttvar_us_ >> RTTVAR_SHIFT));
+        srtt_us_ = static_cast<uint32_t>(static_cast<int64_t>(srtt_us_) + err);
     }
     
     calculate_rto();
     
-    std::cout << "RTT updated: " << rtt.count() << "ms, SRTT: " << srtt_.count() 
-              << "ms, RTO: " << rto_.count() << "ms" << std::endl;
+    TCP_LOG_TRACE("RTT updated", "rtt_us", rtt.count(), "srtt_us", get_srtt().count(),
+                  "rto_us", rto_.count());
 }
 
-uint16_t TCPReliability::get_effective_window() const {
-    return std::min(send_window_size_, remote_window_size_);
+uint32_t TCPReliability::get_effective_window() const {
+    uint32_t flow_window = std::min(send_window_size_, remote_window_size_);
+    return std::min(flow_window, cwnd_);
 }
 
 void TCPReliability::remove_acknowledged_segments(uint32_t ack_num) {
+    auto now = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point newest_sent_time;
+    bool have_sample = false;
+    
     auto it = std::remove_if(unacked_segments_.begin(), unacked_segments_.end(),
-        [ack_num](const std::shared_ptr<TCPSegment>& segment) {
-            if (segment->seq_num + segment->data.size() <= ack_num) {
+        [&](const std::shared_ptr<TCPSegment>& segment) {
+            if (seq_leq(segment->seq_num + static_cast<uint32_t>(segment->data.size()), ack_num)) {
                 segment->acknowledged = true;
+                if (loss_detection_ == LossDetection::RACK_TLP) {
+                    rack_update(*segment, now);
+                }
+                // Karn's algorithm: never sample retransmitted segments
+                if (segment->retransmit_count == 0 &&
+                    (!have_sample || segment->sent_time > newest_sent_time)) {
+                    newest_sent_time = segment->sent_time;
+                    have_sample = true;
+                }
                 return true;
             }
             return false;
         });
     
     unacked_segments_.erase(it, unacked_segments_.end());
+    scoreboard_.remove_below(ack_num);
+    
+    if (have_sample) {
+        update_rtt(std::chrono::duration_cast<std::chrono::microseconds>(now - newest_sent_time));
+    }
 }
 
 void TCPReliability::calculate_rto() {
-    // RFC 6298: RTO = SRTT + max(G, K * RTTVAR)
-    auto k_rttvar = std::chrono::milliseconds(RTT_K * rttvar_.count());
-    auto max_term = std::max(std::chrono::milliseconds(RTT_G), k_rttvar);
+    // RFC 6298: RTO = SRTT + max(G, K * RTTVAR). With K = 4 and RTTVAR
+    // stored << 2, the scaled variance already is K * RTTVAR.
+    auto k_rttvar = std::chrono::microseconds(rttvar_us_);
+    auto max_term = std::max(clock_granularity_, k_rttvar);
+    
+    rto_ = get_srtt() + max_term;
+    
+    // Clamp RTO to configured bounds
+    rto_ = std::max(rto_, min_rto_);
+    rto_ = std::min(rto_, MAX_RTO);
+}
+
+void TCPReliability::on_new_ack(uint32_t acked_bytes) {
+    dup_ack_count_ = 0;
+    
+    if (in_fast_recovery_) {
+        if (seq_geq(last_ack_received_, recover_)) {
+            // Full ACK: deflate to min(ssthresh, max(FlightSize, SMSS) + SMSS)
+            uint32_t flight = std::max<uint32_t>(bytes_in_flight_, mss_);
+            cwnd_ = std::min(ssthresh_, flight + mss_);
+            in_fast_recovery_ = false;
+        } else if (loss_detection_ == LossDetection::RACK_TLP) {
+            // RACK decides which holes are lost after this ACK
+        } else if (sack_enabled_) {
+            // Partial ACK with SACK: pipe already reflects what left the
+            // network, so just fill further holes (RFC 6675 section 5)
+            queue_sack_retransmits();
+        } else {
+            // Partial ACK: the next hole is lost too, retransmit it now and
+            // deflate by the amount acked, adding back one SMSS
+            queue_first_unacked_for_retransmit();
+            cwnd_ = cwnd_ > acked_bytes ? cwnd_ - acked_bytes : 0;
+            if (acked_bytes >= mss_) {
+                cwnd_ += mss_;
+            }
+            cwnd_ = std::max<uint32_t>(cwnd_, mss_);
+        }
+        return;
+    }
+    
+    if (cwnd_ < ssthresh_) {
+        // Slow start
+        cwnd_ += std::min<uint32_t>(acked_bytes, mss_);
+    } else {
+        // Congestion avoidance: roughly one SMSS per RTT
+        cwnd_ += std::max<uint32_t>(1, static_cast<uint32_t>(mss_) * mss_ / cwnd_);
+    }
+}
+
+void TCPReliability::on_duplicate_ack() {
+    if (dup_ack_count_ < UINT8_MAX) {
+        dup_ack_count_++;
+    }
+    
+    // RACK replaces the duplicate threshold; losses come from delivery times
+    if (loss_detection_ == LossDetection::RACK_TLP) {
+        return;
+    }
+    
+    if (in_fast_recovery_) {
+        if (sack_enabled_) {
+            queue_sack_retransmits();
+        } else {
+            // Each further duplicate means another segment has left the network
+            cwnd_ += mss_;
+        }
+        return;
+    }
+    
+    // With SACK the scoreboard can declare snd.una lost before the third
+    // duplicate arrives (RFC 6675 section 5, step 2)
+    bool loss_detected = dup_ack_count_ >= DUP_ACK_THRESHOLD ||
+                         (sack_enabled_ && is_lost(last_ack_received_));
     
-    rto_ = srtt_ + max_term;
+    // Only one recovery per window of data (RFC 6582 section 3.2 step 2)
+    if (loss_detected && seq_gt(last_ack_received_, recover_)) {
+        enter_fast_recovery();
+    }
+}
+
+void TCPReliability::on_ecn_echo(uint32_t acked_bytes, bool ece) {
+    if (congestion_control_ == CongestionControl::DCTCP) {
+        dctcp_.on_ack(last_ack_received_, next_seq_num_, acked_bytes, ece);
+    }
+    
+    // At most one reduction per window of data, and none on top of loss
+    // recovery, which has already reduced (RFC 3168 section 6.1.2)
+    if (!ece || in_fast_recovery_ || !seq_gt(last_ack_received_, ecn_recover_)) {
+        return;
+    }
+    
+    if (congestion_control_ == CongestionControl::DCTCP) {
+        ssthresh_ = dctcp_.reduced_window(cwnd_, mss_);
+    } else {
+        ssthresh_ = std::max(bytes_in_flight_ / 2, 2u * mss_);
+    }
+    cwnd_ = std::min(cwnd_, ssthresh_);
+    ecn_recover_ = next_seq_num_;
+    cwr_pending_ = true;
+    ecn_reductions_++;
+}
+
+void TCPReliability::reduce_congestion_window() {
+    ssthresh_ = std::max(bytes_in_flight_ / 2, 2u * mss_);
+    cwnd_ = std::min(cwnd_, ssthresh_);
+}
+
+void TCPReliability::enter_fast_recovery() {
+    ssthresh_ = std::max(bytes_in_flight_ / 2, 2u * mss_);
+    recover_ = next_seq_num_;
+    in_fast_recovery_ = true;
+    high_rxt_ = last_ack_received_;
+    
+    if (sack_enabled_) {
+        // No window inflation: pipe tracks outstanding data instead.
+        // snd.una goes out unconditionally, then any further holes.
+        cwnd_ = ssthresh_;
+        queue_first_unacked_for_retransmit();
+        queue_sack_retransmits();
+    } else {
+        cwnd_ = ssthresh_ + DUP_ACK_THRESHOLD * mss_;
+        queue_first_unacked_for_retransmit();
+    }
+}
+
+void TCPReliability::queue_first_unacked_for_retransmit() {
+    if (unacked_segments_.empty()) {
+        return;
+    }
+    
+    // Segments are kept in transmission order, so the front is snd.una
+    auto& segment = unacked_segments_.front();
+    queue_retransmit(segment);
+    
+    uint32_t end = segment->seq_num + static_cast<uint32_t>(segment->data.size());
+    if (seq_gt(end, high_rxt_)) {
+        high_rxt_ = end;
+    }
+}
+
+void TCPReliability::queue_sack_retransmits() {
+    if (scoreboard_.empty()) {
+        return;
+    }
+    if (seq_lt(high_rxt_, last_ack_received_)) {
+        high_rxt_ = last_ack_received_;
+    }
+    
+    // NextSeg() (RFC 6675 section 4): holes below the highest SACKed byte
+    // that are deemed lost and not yet retransmitted in this recovery,
+    // sent while cwnd - pipe >= 1 SMSS
+    uint32_t pipe = get_pipe();
+    uint32_t high_sacked = scoreboard_.highest_sacked();
+    
+    for (auto& segment : unacked_segments_) {
+        if (pipe + mss_ > cwnd_ || seq_geq(segment->seq_num, high_sacked)) {
+            break;
+        }
+        
+        uint32_t length = static_cast<uint32_t>(segment->data.size());
+        if (seq_lt(segment->seq_num, high_rxt_) || is_segment_sacked(*segment) ||
+            !is_lost(segment->seq_num)) {
+            continue;
+        }
+        
+        queue_retransmit(segment);
+        high_rxt_ = segment->seq_num + length;
+        pipe += length;
+    }
+}
+
+bool TCPReliability::is_lost(uint32_t seq) const {
+    // IsLost() (RFC 6675 section 4)
+    return scoreboard_.ranges_above(seq) >= DUP_ACK_THRESHOLD ||
+           scoreboard_.sacked_bytes_above(seq) > (DUP_ACK_THRESHOLD - 1u) * mss_;
+}
+
+bool TCPReliability::is_segment_sacked(const TCPSegment& segment) const {
+    if (!sack_enabled_ || scoreboard_.empty()) {
+        return false;
+    }
+    uint32_t end = segment.seq_num + static_cast<uint32_t>(segment.data.size());
+    return scoreboard_.is_sacked(segment.seq_num, end);
+}
+
+uint32_t TCPReliability::get_pipe() const {
+    // SetPipe() (RFC 6675 section 4). Walking from the highest segment down
+    // accumulates the SACKed data above each segment, so IsLost() is
+    // evaluated without rescanning the scoreboard per segment.
+    uint32_t pipe = 0;
+    uint32_t sacked_bytes_above = 0;
+    uint32_t sacked_segments_above = 0;
+    
+    for (auto it = unacked_segments_.rbegin(); it != unacked_segments_.rend(); ++it) {
+        const auto& segment = *it;
+        uint32_t length = static_cast<uint32_t>(segment->data.size());
+        
+        if (is_segment_sacked(*segment)) {
+            sacked_bytes_above += length;
+            sacked_segments_above++;
+            continue;
+        }
+        
+        bool lost = sacked_segments_above >= DUP_ACK_THRESHOLD ||
+                    sacked_bytes_above > (DUP_ACK_THRESHOLD - 1u) * mss_;
+        if (!lost) {
+            pipe += length;
+        }
+        if (in_fast_recovery_ && seq_lt(segment->seq_num, high_rxt_)) {
+            pipe += length;
+        }
+    }
+    
+    return pipe;
+}
+
+uint32_t TCPReliability::get_flight_size() const {
+    return (sack_enabled_ && in_fast_recovery_) ? get_pipe() : bytes_in_flight_;
+}
+
+bool TCPReliability::update_scoreboard(const std::vector<SackBlock>& sack_blocks) {
+    if (!sack_enabled_ || sack_blocks.empty()) {
+        return false;
+    }
+    
+    uint32_t sacked_before = scoreboard_.sacked_bytes();
+    size_t ranges_before = scoreboard_.range_count();
+    
+    for (const auto& block : sack_blocks) {
+        // Ignore D-SACKs and blocks outside the outstanding window
+        if (!seq_lt(block.start, block.end) ||
+            seq_leq(block.end, last_ack_received_) ||
+            seq_gt(block.end, next_seq_num_)) {
+            continue;
+        }
+        uint32_t start = seq_lt(block.start, last_ack_received_) ? last_ack_received_ : block.start;
+        scoreboard_.add(start, block.end);
+    }
+    
+    return scoreboard_.sacked_bytes() != sacked_before ||
+           scoreboard_.range_count() != ranges_before;
+}
+
+void TCPReliability::queue_oversized_retransmits(size_t mss) {
+    for (auto& segment : unacked_segments_) {
+        if (!segment->acknowledged && segment->data.size() > mss && !is_segment_sacked(*segment)) {
+            queue_retransmit(segment);
+        }
+    }
+}
+
+void TCPReliability::queue_retransmit(const std::shared_ptr<TCPSegment>& segment) {
+    if (std::find(fast_retransmit_queue_.begin(), fast_retransmit_queue_.end(), segment) ==
+        fast_retransmit_queue_.end()) {
+        fast_retransmit_queue_.push_back(segment);
+    }
+}
+
+void TCPReliability::process_timers() {
+    if (loss_detection_ != LossDetection::RACK_TLP) {
+        return;
+    }
+    
+    auto now = std::chrono::steady_clock::now();
+    
+    if (now >= reorder_deadline_) {
+        reorder_deadline_ = std::chrono::steady_clock::time_point::max();
+        rack_detect_loss(now);
+    }
+    
+    if (now >= tlp_deadline_) {
+        tlp_deadline_ = std::chrono::steady_clock::time_point::max();
+        send_tail_loss_probe();
+    }
+}
+
+std::chrono::steady_clock::time_point TCPReliability::get_next_timer_deadline() const {
+    auto deadline = std::min(reorder_deadline_, tlp_deadline_);
+    
+    for (const auto& segment : unacked_segments_) {
+        if (segment->retransmit_count < max_retransmits_ && !is_segment_sacked(*segment)) {
+            deadline = std::min(deadline, segment->sent_time + rto_);
+        }
+    }
+    
+    return deadline;
+}
+
+void TCPReliability::rack_update(const TCPSegment& segment,
+                                 std::chrono::steady_clock::time_point now) {
+    auto rtt = std::chrono::duration_cast<std::chrono::microseconds>(now - segment.sent_time);
+    
+    // An ACK arriving sooner than min RTT after a retransmission was
+    // triggered by the original transmission (RFC 8985 section 6.2 step 2)
+    if (segment.retransmit_count > 0 && rack_min_rtt_.count() > 0 && rtt < rack_min_rtt_) {
+        return;
+    }
+    
+    if (rack_min_rtt_.count() == 0 || rtt < rack_min_rtt_) {
+        rack_min_rtt_ = std::max(rtt, std::chrono::microseconds(1));
+    }
+    
+    uint32_t end_seq = segment.seq_num + static_cast<uint32_t>(segment.data.size());
+    if (!rack_has_sample_ || segment.sent_time > rack_xmit_ts_ ||
+        (segment.sent_time == rack_xmit_ts_ && seq_gt(end_seq, rack_end_seq_))) {
+        rack_xmit_ts_ = segment.sent_time;
+        rack_end_seq_ = end_seq;
+        rack_rtt_ = rtt;
+        rack_has_sample_ = true;
+    }
+}
+
+std::chrono::microseconds TCPReliability::rack_reorder_window() const {
+    // RFC 8985 section 6.2 step 4: min_RTT / 4, bounded by SRTT
+    auto reo_wnd = rack_min_rtt_ / 4;
+    if (has_rtt_sample_) {
+        reo_wnd = std::min(reo_wnd, get_srtt());
+    }
+    return reo_wnd;
+}
+
+void TCPReliability::rack_detect_loss(std::chrono::steady_clock::time_point now) {
+    if (!rack_has_sample_) {
+        return;
+    }
+    
+    // RFC 8985 section 6.2 step 5: a segment sent before the most recently
+    // delivered one is lost once it has been outstanding for longer than
+    // that delivery's RTT plus the reordering window
+    auto reo_wnd = rack_reorder_window();
+    std::chrono::microseconds timeout(0);
+    bool lost_any = false;
+    
+    for (auto& segment : unacked_segments_) {
+        if (is_segment_sacked(*segment)) {
+            continue;
+        }
+        
+        uint32_t end_seq = segment->seq_num + static_cast<uint32_t>(segment->data.size());
+        bool sent_before = segment->sent_time < rack_xmit_ts_ ||
+                           (segment->sent_time == rack_xmit_ts_ && seq_lt(end_seq, rack_end_seq_));
+        if (!sent_before) {
+            continue;
+        }
+        
+        auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(
+            segment->sent_time + rack_rtt_ + reo_wnd - now);
+        if (remaining.count() <= 0) {
+            queue_retransmit(segment);
+            lost_any = true;
+        } else {
+            timeout = std::max(timeout, remaining);
+        }
+    }
+    
+    reorder_deadline_ = timeout.count() > 0 ? now + timeout
+                                            : std::chrono::steady_clock::time_point::max();
+    
+    if (lost_any && !in_fast_recovery_ && seq_gt(last_ack_received_, recover_)) {
+        // Congestion response once per window, as for dup-ACK recovery
+        ssthresh_ = std::max(bytes_in_flight_ / 2, 2u * mss_);
+        cwnd_ = ssthresh_;
+        recover_ = next_seq_num_;
+        in_fast_recovery_ = true;
+    }
+}
+
+void TCPReliability::arm_tlp(std::chrono::steady_clock::time_point now) {
+    if (in_fast_recovery_ || tlp_in_progress_ || unacked_segments_.empty()) {
+        tlp_deadline_ = std::chrono::steady_clock::time_point::max();
+        return;
+    }
+    
+    // RFC 8985 section 7.2: PTO = 2 * SRTT, plus room for a delayed ACK
+    // when a single segment is outstanding, never beyond the RTO
+    std::chrono::microseconds pto = has_rtt_sample_ ? 2 * get_srtt() : TLP_DEFAULT_PTO;
+    if (unacked_segments_.size() == 1) {
+        pto += TLP_WORST_CASE_ACK_DELAY;
+    }
+    pto = std::min(pto, rto_);
+    
+    tlp_deadline_ = now + pto;
+}
+
+void TCPReliability::send_tail_loss_probe() {
+    if (in_fast_recovery_ || unacked_segments_.empty()) {
+        return;
+    }
     
-    // Clamp RTO to reasonable bounds
-    rto_ = std::max(rto_, std::chrono::milliseconds(200));   // Minimum 200ms
-    rto_ = std::min(rto_, std::chrono::milliseconds(60000)); // Maximum 60s
+    // Unsent data is only ever held back by the window, so probe by
+    // retransmitting the last segment (RFC 8985 section 7.3)
+    queue_retransmit(unacked_segments_.back());
+    tlp_in_progress_ = true;
+    tlp_end_seq_ = next_seq_num_;
+    tlp_probe_count_++;
 }
 
 } // namespace tcp_stack
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include "tcp_segmenter.h"
+#include "ip_header.h"
+#include "network_utils.h"
+#include <cstring>
+
+namespace tcp_stack {
+
+TCPSegmenter::TCPSegmenter(uint32_t src_ip, uint32_t dst_ip, const TCPHeader& header,
+                           const std::vector<uint8_t>& options)
+    : template_(header), options_(options) {
+    template_.set_data_offset(static_cast<uint8_t>(header_length() / 4));
+    template_.checksum = 0;
+    
+    // Sum the invariant parts with the per-segment fields zeroed. The
+    // checksum is taken over the host-order header, as create_tcp_header() does.
+    TCPHeader zeroed = template_;
+    zeroed.seq_num = 0;
+    zeroed.data_offset_reserved = 0;
+    zeroed.flags = 0;
+    
+    TCPPseudoHeader pseudo_header;
+    pseudo_header.src_ip = src_ip;
+    pseudo_header.dst_ip = dst_ip;
+    pseudo_header.reserved = 0;
+    pseudo_header.protocol = IPPROTO_TCP;
+    pseudo_header.tcp_length = 0;
+    
+    base_sum_ = NetworkUtils::checksum_accumulate(&pseudo_header, sizeof(pseudo_header));
+    base_sum_ = NetworkUtils::checksum_accumulate(&zeroed, sizeof(zeroed), base_sum_);
+    if (!options_.empty()) {
+        base_sum_ = NetworkUtils::checksum_accumulate(options_.data(), options_.size(), base_sum_);
+    }
+}
+
+void TCPSegmenter::build(uint32_t seq, uint8_t flags, const uint8_t* payload, size_t length,
+                         std::vector<uint8_t>& out, size_t offset) const {
+    TCPHeader header = template_;
+    header.seq_num = seq;
+    header.flags = flags;
+    
+    uint16_t tcp_length = htons(static_cast<uint16_t>(header_length() + length));
+    uint32_t sum = NetworkUtils::checksum_accumulate(&header.seq_num, sizeof(header.seq_num), base_sum_);
+    sum = NetworkUtils::checksum_accumulate(&header.data_offset_reserved, 2, sum);
+    sum = NetworkUtils::checksum_accumulate(&tcp_length, sizeof(tcp_length), sum);
+    sum = NetworkUtils::checksum_accumulate(payload, length, sum);
+    header.checksum = NetworkUtils::checksum_finish(sum);
+    
+    header.to_network_order();
+    uint8_t* dst = out.data() + offset;
+    std::memcpy(dst, &header, sizeof(header));
+    if (!options_.empty()) {
+        std::memcpy(dst + sizeof(header), options_.data(), options_.size());
+    }
+    std::memcpy(dst + header_length(), payload, length);
+}
+
+} // namespace tcp_stack
\ No newline at end of file
@@ -1,26 +1,16 @@
 #include "tcp_socket.h"
 #include "network_utils.h"
-#include <iostream>
+#include "logger.h"
 #include <algorithm>
 
 namespace tcp_stack {
 
-// Global connection manager (singleton pattern)
-static std::shared_ptr<TCPConnectionManager> g_connection_manager = nullptr;
-static std::mutex g_manager_mutex;
+TCPSocket::TCPSocket() : TCPSocket(Stack::default_stack()) {}
 
-static std::shared_ptr<TCPConnectionManager> get_connection_manager() {
-    std::lock_guard<std::mutex> lock(g_manager_mutex);
-    if (!g_connection_manager) {
-        g_connection_manager = std::make_shared<TCPConnectionManager>();
-        g_connection_manager->initialize();
-    }
-    return g_connection_manager;
-}
-
-TCPSocket::TCPSocket()
-    : connection_manager_(get_connection_manager()),
-      reliability_(std::make_unique<TCPReliability>()),
+TCPSocket::TCPSocket(Stack& stack)
+    : connection_manager_(stack.get_connection_manager()),
+      reliability_(std::make_shared<TCPReliability>()),
+      receive_notifier_(std::make_unique<EventNotifier>()), reader_parked_(false),
       is_listening_(false), is_blocking_(true),
       recv_timeout_(std::chrono::milliseconds(0)),
       send_timeout_(std::chrono::milliseconds(0)),
@@ -28,84 +18,133 @@ TCPSocket::TCPSocket()
 
 TCPSocket::~TCPSocket() {
     close();
+    leave_pollers();
 }
 
 TCPSocket::TCPSocket(TCPSocket&& other) noexcept
-    : connection_(std::move(other.connection_)),
-      connection_manager_(std::move(other.connection_manager_)),
-      reliability_(std::move(other.reliability_)),
-      receive_buffer_(std::move(other.receive_buffer_)),
-      packet_processor_(std::move(other.packet_processor_)),
-      is_listening_(other.is_listening_),
-      is_blocking_(other.is_blocking_),
-      recv_timeout_(other.recv_timeout_),
-      send_timeout_(other.send_timeout_),
-      local_ip_(other.local_ip_),
-      local_port_(other.local_port_),
-      should_stop_(other.should_stop_.load()) {
-    other.is_listening_ = false;
-    other.should_stop_ = false;
+    : reader_parked_(false), is_listening_(false), is_blocking_(true),
+      recv_timeout_(std::chrono::milliseconds(0)),
+      send_timeout_(std::chrono::milliseconds(0)),
+      local_ip_(0), local_port_(0), should_stop_(false) {
+    take_over(other);
 }
 
 TCPSocket& TCPSocket::operator=(TCPSocket&& other) noexcept {
     if (this != &other) {
         close();
-        
-        connection_ = std::move(other.connection_);
-        connection_manager_ = std::move(other.connection_manager_);
-        reliability_ = std::move(other.reliability_);
-        receive_buffer_ = std::move(other.receive_buffer_);
-        packet_processor_ = std::move(other.packet_processor_);
-        is_listening_ = other.is_listening_;
-        is_blocking_ = other.is_blocking_;
-        recv_timeout_ = other.recv_timeout_;
-        send_timeout_ = other.send_timeout_;
-        local_ip_ = other.local_ip_;
-        local_port_ = other.local_port_;
-        should_stop_ = other.should_stop_.load();
-        
-        other.is_listening_ = false;
-        other.should_stop_ = false;
+        leave_pollers();
+        take_over(other);
     }
     return *this;
 }
 
+void TCPSocket::take_over(TCPSocket& other) {
+    // The packet thread, the stack's handlers and the pollers all point at
+    // the other socket: stop the thread, re-aim the rest, then restart it
+    bool processing = other.packet_processor_.joinable();
+    other.stop_packet_processor();
+    
+    connection_ = std::move(other.connection_);
+    connection_manager_ = std::move(other.connection_manager_);
+    reliability_ = std::move(other.reliability_);
+    receive_ring_ = std::move(other.receive_ring_);
+    receive_overflow_ = std::move(other.receive_overflow_);
+    receive_notifier_ = std::move(other.receive_notifier_);
+    listener_ = std::move(other.listener_);
+    config_ = other.config_;
+    is_listening_ = other.is_listening_;
+    is_blocking_ = other.is_blocking_;
+    recv_timeout_ = other.recv_timeout_;
+    send_timeout_ = other.send_timeout_;
+    local_ip_ = other.local_ip_;
+    local_port_ = other.local_port_;
+    
+    other.is_listening_ = false;
+    other.should_stop_ = false;
+    
+    if (connection_) {
+        std::lock_guard<std::recursive_mutex> lock(connection_->mutex);
+        if (connection_->data_handler) {
+            connection_->data_handler = [this](const std::vector<uint8_t>& data) {
+                process_received_data(data);
+            };
+        }
+        if (connection_->event_handler) {
+            connection_->event_handler = [this](uint32_t events) { signal_pollers(events); };
+        }
+    }
+    if (listener_) {
+        std::lock_guard<std::recursive_mutex> lock(listener_->mutex);
+        listener_->event_handler = [this](uint32_t events) { signal_pollers(events); };
+    }
+    {
+        std::scoped_lock lock(poll_mutex_, other.poll_mutex_);
+        poll_registrations_ = std::move(other.poll_registrations_);
+        other.poll_registrations_.clear();
+        for (auto& registration : poll_registrations_) {
+            registration->poller->rebind(registration, *this);
+        }
+    }
+    
+    if (processing) {
+        start_packet_processor();
+    }
+}
+
+void TCPSocket::leave_pollers() {
+    std::vector<std::shared_ptr<PollRegistration>> registrations;
+    {
+        std::lock_guard<std::mutex> lock(poll_mutex_);
+        registrations.swap(poll_registrations_);
+    }
+    for (auto& registration : registrations) {
+        registration->poller->forget(registration);
+    }
+}
+
 TCPSocket::TCPSocket(std::shared_ptr<TCPConnection> conn, 
                     std::shared_ptr<TCPConnectionManager> manager)
     : connection_(conn), connection_manager_(manager),
-      reliability_(std::make_unique<TCPReliability>()),
+      reliability_(std::make_shared<TCPReliability>()),
+      receive_notifier_(std::make_unique<EventNotifier>()), reader_parked_(false),
       is_listening_(false), is_blocking_(true),
       recv_timeout_(std::chrono::milliseconds(0)),
       send_timeout_(std::chrono::milliseconds(0)),
       local_ip_(conn->local_ip), local_port_(conn->local_port),
       should_stop_(false) {
     
-    reliability_->set_initial_seq(conn->local_seq);
+    config_ = conn->config;
+    attach_connection();
     start_packet_processor();
 }
 
 bool TCPSocket::bind(const std::string& ip_address, uint16_t port) {
     local_ip_ = resolve_ip_address(ip_address);
     if (local_ip_ == 0) {
-        std::cerr << "Failed to resolve IP address: " << ip_address << std::endl;
+        TCP_LOG_WARN("Failed to resolve IP address", "ip", ip_address);
         return false;
     }
     
     local_port_ = port;
-    std::cout << "Socket bound to " << ip_address << ":" << port << std::endl;
+    TCP_LOG_INFO("Socket bound", "ip", ip_address, "port", port);
     return true;
 }
 
 bool TCPSocket::listen(int backlog) {
     if (local_ip_ == 0 || local_port_ == 0) {
-        std::cerr << "Socket not bound before listen" << std::endl;
+        TCP_LOG_WARN("Socket not bound before listen");
         return false;
     }
     
-    if (!connection_manager_->listen(local_ip_, local_port_)) {
+    if (!connection_manager_->listen(local_ip_, local_port_, config_)) {
         return false;
     }
     
+    listener_ = connection_manager_->find_listener(local_ip_, local_port_);
+    {
+        std::lock_guard<std::recursive_mutex> lock(listener_->mutex);
+        listener_->event_handler = [this](uint32_t events) { signal_pollers(events); };
+    }
     is_listening_ = true;
     start_packet_processor();
     return true;
@@ -116,7 +155,7 @@ std::unique_ptr<TCPSocket> TCPSocket::accept() {
         return nullptr;
     }
     
-    auto conn = connection_manager_->accept_connection();
+    auto conn = connection_manager_->accept_connection(listener_);
     if (!conn) {
         return nullptr;
     }
@@ -125,9 +164,30 @@ std::unique_ptr<TCPSocket> TCPSocket::accept() {
 }
 
 bool TCPSocket::connect(const std::string& ip_address, uint16_t port) {
+    if (!open_connection(ip_address, port, {})) {
+        return false;
+    }
+    
+    // Wait for connection establishment (simplified)
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    
+    return is_connected();
+}
+
+ssize_t TCPSocket::connect_with_data(const std::string& ip_address, uint16_t port,
+                                     const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    if (!open_connection(ip_address, port, std::vector<uint8_t>(bytes, bytes + length))) {
+        return -1;
+    }
+    return length;
+}
+
+bool TCPSocket::open_connection(const std::string& ip_address, uint16_t port,
+                                const std::vector<uint8_t>& data) {
     uint32_t remote_ip = resolve_ip_address(ip_address);
     if (remote_ip == 0) {
-        std::cerr << "Failed to resolve remote IP: " << ip_address << std::endl;
+        TCP_LOG_WARN("Failed to resolve remote IP", "ip", ip_address);
         return false;
     }
     
@@ -138,21 +198,21 @@ bool TCPSocket::connect(const std::string& ip_address, uint16_t port) {
         local_port_ = 12345; // Default local port - should be randomly assigned
     }
     
-    connection_ = connection_manager_->connect(local_ip_, local_port_, remote_ip, port);
+    connection_ = connection_manager_->connect(local_ip_, local_port_, remote_ip, port, config_, data);
     if (!connection_) {
         return false;
     }
     
-    reliability_->set_initial_seq(connection_->local_seq);
+    attach_connection();
     start_packet_processor();
-    
-    // Wait for connection establishment (simplified)
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    
-    return is_connected();
+    return true;
 }
 
 ssize_t TCPSocket::send(const void* data, size_t length) {
+    return send(data, length, 0);
+}
+
+ssize_t TCPSocket::send(const void* data, size_t length, int flags) {
     if (!is_connected()) {
         return -1;
     }
@@ -160,56 +220,78 @@ ssize_t TCPSocket::send(const void* data, size_t length) {
     const uint8_t* bytes = static_cast<const uint8_t*>(data);
     std::vector<uint8_t> data_vec(bytes, bytes + length);
     
-    // Buffer data for reliable transmission
+    // Buffer data for reliable transmission; whatever cannot go out now is
+    // sent as ACKs arrive, so all of it counts as accepted
+    std::lock_guard<std::recursive_mutex> lock(connection_->mutex);
     reliability_->buffer_data(data_vec);
+    connection_manager_->flush_send_queue(connection_, (flags & SEND_MORE) != 0);
     
-    // Send what we can immediately
-    size_t total_sent = 0;
-    while (total_sent < length && reliability_->can_send_data(1024)) {
-        auto chunk = reliability_->get_data_to_send(1024);
-        if (chunk.empty()) break;
-        
-        if (connection_manager_->send_segment(connection_, chunk, TCPHeader::PSH | TCPHeader::ACK)) {
-            total_sent += chunk.size();
-        } else {
-            break;
-        }
+    return length;
+}
+
+bool TCPSocket::cork() {
+    if (!connection_) {
+        return false;
     }
-    
-    return total_sent;
+    std::lock_guard<std::recursive_mutex> lock(connection_->mutex);
+    connection_->corked = true;
+    return true;
+}
+
+bool TCPSocket::uncork() {
+    if (!connection_) {
+        return false;
+    }
+    std::lock_guard<std::recursive_mutex> lock(connection_->mutex);
+    connection_->corked = false;
+    connection_->cork_deadline = std::chrono::steady_clock::time_point::max();
+    connection_manager_->flush_send_queue(connection_, false, true);
+    return true;
 }
 
 ssize_t TCPSocket::recv(void* buffer, size_t length) {
-    if (!is_connected()) {
+    if (!is_open() || !receive_ring_) {
         return -1;
     }
     
-    std::unique_lock<std::mutex> lock(receive_mutex_);
+    uint8_t* out = static_cast<uint8_t*>(buffer);
+    size_t copied = receive_ring_->read(out, length);
     
-    // Wait for data with timeout if specified
-    if (receive_buffer_.empty()) {
-        if (recv_timeout_.count() > 0) {
-            if (!receive_cv_.wait_for(lock, recv_timeout_, 
-                [this] { return !receive_buffer_.empty() || !is_connected(); })) {
-                return 0; // Timeout
+    // Wait for data with timeout if specified. The reader announces that
+    // it is parked and then looks once more, so data written while it
+    // was announcing is not missed; the writer only signals a parked
+    // reader. Waits are sliced so a connection closing under us is seen.
+    if (copied == 0 && (recv_timeout_.count() > 0 || is_blocking_)) {
+        auto deadline = recv_timeout_.count() > 0 ?
+            std::chrono::steady_clock::now() + recv_timeout_ :
+            std::chrono::steady_clock::time_point::max();
+        while (copied == 0 && is_open()) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                break;
             }
-        } else if (is_blocking_) {
-            receive_cv_.wait(lock, [this] { return !receive_buffer_.empty() || !is_connected(); });
+            
+            reader_parked_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            copied = receive_ring_->read(out, length);
+            if (copied == 0) {
+                auto slice = std::min<std::chrono::steady_clock::duration>(deadline - now,
+                                                                           RECEIVE_WAIT_SLICE);
+                receive_notifier_->wait(std::chrono::ceil<std::chrono::milliseconds>(slice));
+                copied = receive_ring_->read(out, length);
+            }
+            reader_parked_.store(false, std::memory_order_relaxed);
         }
     }
     
-    if (receive_buffer_.empty()) {
+    if (copied == 0) {
         return 0;
     }
     
-    // Copy data to user buffer
-    size_t to_copy = std::min(length, receive_buffer_.size());
-    std::copy(receive_buffer_.begin(), receive_buffer_.begin() + to_copy,
-              static_cast<uint8_t*>(buffer));
-    
-    receive_buffer_.erase(receive_buffer_.begin(), receive_buffer_.begin() + to_copy);
+    // Reading frees window and drives receive buffer autotuning
+    connection_manager_->on_data_consumed(connection_, copied);
     
-    return to_copy;
+    return copied;
 }
 
 bool TCPSocket::close() {
@@ -219,6 +301,16 @@ bool TCPSocket::close() {
         connection_manager_->close_connection(connection_);
     }
     
+    if (connection_) {
+        std::lock_guard<std::recursive_mutex> lock(connection_->mutex);
+        connection_->data_handler = nullptr;
+        connection_->event_handler = nullptr;
+    }
+    if (listener_) {
+        std::lock_guard<std::recursive_mutex> lock(listener_->mutex);
+        listener_->event_handler = nullptr;
+    }
+    listener_.reset();
     connection_.reset();
     is_listening_ = false;
     return true;
@@ -228,6 +320,42 @@ bool TCPSocket::is_connected() const {
     return connection_ && connection_->state_machine.is_established();
 }
 
+uint32_t TCPSocket::poll_events() const {
+    if (is_listening_) {
+        return listener_ && connection_manager_->has_pending_accept(listener_) ?
+            EventPoller::ACCEPT : 0;
+    }
+    if (!connection_) {
+        return 0;
+    }
+    
+    uint32_t events = 0;
+    TCPState state = connection_->state_machine.get_state();
+    bool peer_closed = state == TCPState::CLOSE_WAIT || state == TCPState::LAST_ACK ||
+                       state == TCPState::CLOSING || state == TCPState::TIME_WAIT;
+    if ((receive_ring_ && !receive_ring_->empty()) || peer_closed) {
+        events |= EventPoller::READABLE;
+    }
+    // send() takes everything it is given, so connected is writable
+    if (connection_->state_machine.can_send_data()) {
+        events |= EventPoller::WRITABLE;
+    }
+    // Reset (or never got through the handshake)
+    if (state == TCPState::CLOSED) {
+        events |= EventPoller::ERROR;
+    }
+    return events;
+}
+
+bool TCPSocket::is_open() const {
+    if (!connection_) {
+        return false;
+    }
+    TCPState state = connection_->state_machine.get_state();
+    return state == TCPState::ESTABLISHED || state == TCPState::SYN_SENT ||
+           (state == TCPState::SYN_RECEIVED && connection_->fastopen_accepted);
+}
+
 bool TCPSocket::set_blocking(bool blocking) {
     is_blocking_ = blocking;
     return true;
@@ -243,6 +371,165 @@ bool TCPSocket::set_send_timeout(std::chrono::milliseconds timeout) {
     return true;
 }
 
+bool TCPSocket::set_min_rto(std::chrono::microseconds min_rto) {
+    if (!reliability_ || min_rto.count() <= 0 || min_rto > TCPReliability::MAX_RTO) {
+        return false;
+    }
+    reliability_->set_min_rto(min_rto);
+    return true;
+}
+
+bool TCPSocket::set_clock_granularity(std::chrono::microseconds granularity) {
+    if (!reliability_ || granularity.count() <= 0) {
+        return false;
+    }
+    reliability_->set_clock_granularity(granularity);
+    return true;
+}
+
+bool TCPSocket::set_loss_detection(LossDetection mode) {
+    if (!reliability_) {
+        return false;
+    }
+    reliability_->set_loss_detection(mode);
+    return true;
+}
+
+bool TCPSocket::set_sack_enabled(bool enabled) {
+    // Negotiated on the SYN, so it has to be set before connect()/listen()
+    if (connection_ || is_listening_) {
+        return false;
+    }
+    config_.sack_permitted = enabled;
+    return true;
+}
+
+bool TCPSocket::set_ecn(bool enabled) {
+    // Negotiated on the SYN, so it has to be set before connect()/listen()
+    if (connection_ || is_listening_) {
+        return false;
+    }
+    config_.ecn = enabled;
+    return true;
+}
+
+bool TCPSocket::set_fastopen(bool enabled, uint32_t max_pending) {
+    // Offered on the SYN, so it has to be set before connect()/listen()
+    if (connection_ || is_listening_ || (enabled && max_pending == 0)) {
+        return false;
+    }
+    config_.fastopen = enabled;
+    config_.fastopen_max_pending = max_pending;
+    return true;
+}
+
+bool TCPSocket::set_congestion_control(CongestionControl algorithm) {
+    if (!reliability_) {
+        return false;
+    }
+    reliability_->set_congestion_control(algorithm);
+    return true;
+}
+
+bool TCPSocket::set_delayed_ack(bool enabled) {
+    config_.delayed_ack = enabled;
+    if (connection_) {
+        connection_->config.delayed_ack = enabled;
+    }
+    return true;
+}
+
+bool TCPSocket::set_delayed_ack_timeout(std::chrono::microseconds timeout) {
+    // RFC 1122 caps the delay at 500ms
+    if (timeout.count() <= 0 || timeout > std::chrono::milliseconds(500)) {
+        return false;
+    }
+    config_.delayed_ack_timeout = timeout;
+    if (connection_) {
+        connection_->config.delayed_ack_timeout = timeout;
+    }
+    return true;
+}
+
+bool TCPSocket::set_quick_ack(bool enabled) {
+    config_.quick_ack = enabled;
+    if (connection_) {
+        connection_->config.quick_ack = enabled;
+    }
+    return true;
+}
+
+bool TCPSocket::set_mss(uint16_t mss) {
+    // Advertised on the SYN, so it has to be set before connect()/listen()
+    if (connection_ || is_listening_ || (mss != 0 && mss < 88)) {
+        return false;
+    }
+    config_.mss = mss;
+    return true;
+}
+
+bool TCPSocket::set_mtu_probing(bool enabled) {
+    if (connection_ || is_listening_) {
+        return false;
+    }
+    config_.mtu_probing = enabled;
+    return true;
+}
+
+bool TCPSocket::set_max_pacing_rate(uint64_t bytes_per_second) {
+    config_.max_pacing_rate = bytes_per_second;
+    if (connection_) {
+        connection_->config.max_pacing_rate = bytes_per_second;
+    }
+    return true;
+}
+
+bool TCPSocket::set_priority(uint8_t priority) {
+    if (priority >= TransmitScheduler::NUM_PRIORITIES) {
+        return false;
+    }
+    config_.tx_priority = priority;
+    if (connection_) {
+        connection_->config.tx_priority = priority;
+    }
+    return true;
+}
+
+bool TCPSocket::set_tx_weight(uint32_t weight) {
+    if (weight == 0) {
+        return false;
+    }
+    config_.tx_weight = weight;
+    if (connection_) {
+        connection_->config.tx_weight = weight;
+    }
+    return true;
+}
+
+bool TCPSocket::set_max_receive_buffer(uint32_t bytes) {
+    config_.max_receive_buffer = bytes;
+    if (connection_) {
+        // The receive ring is already sized; the window must not outgrow it
+        uint32_t ring = static_cast<uint32_t>(std::min<size_t>(receive_ring_->capacity(), UINT32_MAX));
+        bytes = bytes == 0 ? ring : std::min(bytes, ring);
+        connection_manager_->set_max_receive_buffer(connection_, bytes);
+    }
+    return true;
+}
+
+bool TCPSocket::set_nodelay(bool enabled) {
+    config_.nodelay = enabled;
+    if (connection_) {
+        connection_->config.nodelay = enabled;
+        
+        // Anything Nagle was holding goes out now
+        if (enabled) {
+            connection_manager_->flush_send_queue(connection_);
+        }
+    }
+    return true;
+}
+
 std::string TCPSocket::get_local_address() const {
     return NetworkUtils::ip_network_to_string(local_ip_);
 }
@@ -262,34 +549,173 @@ uint16_t TCPSocket::get_remote_port() const {
     return connection_ ? connection_->remote_port : 0;
 }
 
+uint16_t TCPSocket::get_mss() const {
+    return connection_ ? connection_->effective_mss() : 0;
+}
+
+uint32_t TCPSocket::get_receive_buffer() const {
+    return connection_ ? connection_->rcv_tuner.get_buffer() : 0;
+}
+
 void TCPSocket::packet_processing_loop() {
+    // Run on the stack's CPUs, with memory from its node
+    connection_manager_->place_current_thread();
+    
     while (!should_stop_) {
         // This is a simplified version - in reality, this would integrate
-        // more closely with the connection manager's packet processing
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        // more closely with the connection manager's packet processing.
+        // Wake early for RACK/TLP/RTO deadlines shorter than the tick.
+        auto wake_time = std::chrono::steady_clock::now() + std::chrono::milliseconds(10);
+        // With busy polling the engine thread receives, paces and
+        // transmits; we are left with this connection's timers.
+        bool busy_polling = connection_manager_->is_busy_polling();
+        if (connection_) {
+            std::lock_guard<std::recursive_mutex> lock(connection_->mutex);
+            if (reliability_) {
+                wake_time = std::min(wake_time, reliability_->get_next_timer_deadline());
+            }
+            wake_time = std::min({wake_time, connection_->ack_deadline, connection_->cork_deadline});
+            if (!busy_polling) {
+                wake_time = std::min(wake_time, connection_manager_->next_pacing_deadline());
+                if (connection_manager_->get_transmit_backlog() > 0) {
+                    wake_time = std::chrono::steady_clock::now();
+                }
+            }
+        }
+        std::this_thread::sleep_until(wake_time);
+        
+        // ACKs, data and ICMP (path MTU) for our connection
+        if (connection_ && !busy_polling) {
+            connection_manager_->poll();
+        }
         
         // Process retransmissions
         if (connection_ && reliability_) {
+            std::lock_guard<std::recursive_mutex> lock(connection_->mutex);
             auto segments_to_retx = reliability_->get_segments_to_retransmit();
             for (auto& segment : segments_to_retx) {
-                connection_manager_->send_segment(connection_, segment->data, 
-                                                TCPHeader::PSH | TCPHeader::ACK);
+                connection_manager_->retransmit_segment(connection_, *segment);
+                reliability_->mark_segment_sent(segment);
+            }
+            
+            // RACK reordering-timer losses and tail loss probes
+            reliability_->process_timers();
+            for (auto& segment : reliability_->take_fast_retransmits()) {
+                connection_manager_->retransmit_segment(connection_, *segment);
                 reliability_->mark_segment_sent(segment);
             }
         }
+        
+        // Delayed ACK and cork timers, paced sends that are due, and the
+        // next share of the transmit scheduler's backlog
+        if (connection_) {
+            {
+                std::lock_guard<std::recursive_mutex> lock(connection_->mutex);
+                drain_receive_overflow();
+            }
+            connection_manager_->process_timers(connection_);
+            if (!busy_polling) {
+                connection_manager_->process_pacing();
+                connection_manager_->run_transmit();
+            }
+        }
     }
 }
 
 void TCPSocket::process_received_data(const std::vector<uint8_t>& data) {
-    std::lock_guard<std::mutex> lock(receive_mutex_);
-    receive_buffer_.insert(receive_buffer_.end(), data.begin(), data.end());
-    receive_cv_.notify_one();
+    // Held-back bytes go first to keep the stream in order
+    drain_receive_overflow();
+    
+    size_t written = 0;
+    if (receive_overflow_.empty()) {
+        written = receive_ring_->write(data.data(), data.size());
+    }
+    receive_overflow_.insert(receive_overflow_.end(), data.begin() + written, data.end());
+    wake_reader();
+    signal_pollers(EventPoller::READABLE);
+}
+
+void TCPSocket::drain_receive_overflow() {
+    if (receive_overflow_.empty()) {
+        return;
+    }
+    size_t written = receive_ring_->write(receive_overflow_.data(), receive_overflow_.size());
+    receive_overflow_.erase(receive_overflow_.begin(), receive_overflow_.begin() + written);
+    if (written > 0) {
+        wake_reader();
+        signal_pollers(EventPoller::READABLE);
+    }
+}
+
+void TCPSocket::signal_pollers(uint32_t events) {
+    std::lock_guard<std::mutex> lock(poll_mutex_);
+    for (auto& registration : poll_registrations_) {
+        registration->poller->on_events(registration, events);
+    }
+}
+
+void TCPSocket::attach_poll_registration(const std::shared_ptr<PollRegistration>& registration) {
+    std::lock_guard<std::mutex> lock(poll_mutex_);
+    poll_registrations_.push_back(registration);
+}
+
+void TCPSocket::detach_poll_registration(const std::shared_ptr<PollRegistration>& registration) {
+    std::lock_guard<std::mutex> lock(poll_mutex_);
+    poll_registrations_.erase(std::remove(poll_registrations_.begin(), poll_registrations_.end(),
+                                          registration),
+                              poll_registrations_.end());
+}
+
+void TCPSocket::wake_reader() {
+    // Pairs with the fence in recv(): either the reader sees the bytes
+    // just written or we see it parked
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (reader_parked_.load(std::memory_order_relaxed)) {
+        receive_notifier_->notify();
+    }
+}
+
+void TCPSocket::attach_connection() {
+    std::lock_guard<std::recursive_mutex> lock(connection_->mutex);
+    reliability_->set_initial_seq(connection_->local_seq);
+    reliability_->set_sack_enabled(connection_->sack_enabled);
+    reliability_->set_ecn_enabled(connection_->ecn_enabled);
+    reliability_->set_mss(connection_->effective_mss());
+    connection_->reliability = reliability_;
+    
+    // The ring holds everything the window can let in
+    size_t ring_capacity = std::max<size_t>({connection_->rcv_tuner.get_max_buffer(),
+                                             connection_->pending_data.size(), MIN_RECEIVE_RING});
+    receive_ring_ = std::make_unique<SPSCByteRing>(ring_capacity);
+    
+    connection_->data_handler = [this](const std::vector<uint8_t>& data) {
+        process_received_data(data);
+    };
+    connection_->event_handler = [this](uint32_t events) { signal_pollers(events); };
+    
+    // Data that arrived before the socket existed (e.g. before accept())
+    if (!connection_->pending_data.empty()) {
+        process_received_data(connection_->pending_data);
+        connection_->pending_data.clear();
+    }
 }
 
 uint32_t TCPSocket::resolve_ip_address(const std::string& ip_str) {
     return NetworkUtils::ip_string_to_network(ip_str);
 }
 
+bool TCPSocket::enable_busy_poll(const BusyPollConfig& config) {
+    return Stack::default_stack().enable_busy_poll(config);
+}
+
+void TCPSocket::disable_busy_poll() {
+    Stack::default_stack().disable_busy_poll();
+}
+
+BusyPollStats TCPSocket::get_busy_poll_stats() {
+    return Stack::default_stack().get_busy_poll_stats();
+}
+
 bool TCPSocket::start_packet_processor() {
     if (!packet_processor_.joinable()) {
         should_stop_ = false;
@@ -0,0 +1,71 @@
+#include "transmit_scheduler.h"
+#include <algorithm>
+#include <utility>
+
+namespace tcp_stack {
+
+TransmitScheduler::TransmitScheduler(LinkSend link_send)
+    : link_send_(std::move(link_send)), backlog_(0), dropped_(0) {}
+
+void TransmitScheduler::enqueue(const std::shared_ptr<TransmitFlow>& flow,
+                                std::vector<uint8_t>&& packet) {
+    flow->queued_bytes += packet.size();
+    flow->packets.push_back(std::move(packet));
+    backlog_++;
+    
+    if (!flow->active) {
+        flow->active = true;
+        flow->weight = std::max<uint32_t>(flow->weight, 1);
+        flow->deficit = static_cast<size_t>(flow->weight) * QUANTUM;
+        active_[std::min<size_t>(flow->priority, NUM_PRIORITIES - 1)].push_back(flow);
+    }
+}
+
+size_t TransmitScheduler::run(size_t max_packets) {
+    size_t total = 0;
+    std::vector<std::vector<uint8_t>> batch;
+    
+    while (total < max_packets) {
+        // Strict priority: only the highest class with work is served
+        auto band = std::find_if(active_.begin(), active_.end(),
+                                 [](const auto& flows) { return !flows.empty(); });
+        if (band == active_.end()) {
+            break;
+        }
+        
+        auto flow = band->front();
+        while (!flow->packets.empty() && total + batch.size() < max_packets &&
+               flow->packets.front().size() <= flow->deficit) {
+            flow->deficit -= flow->packets.front().size();
+            flow->queued_bytes -= flow->packets.front().size();
+            batch.push_back(std::move(flow->packets.front()));
+            flow->packets.pop_front();
+        }
+        
+        if (flow->packets.empty()) {
+            // An idle flow does not keep its unused deficit
+            flow->active = false;
+            flow->deficit = 0;
+            band->pop_front();
+        } else if (flow->packets.front().size() > flow->deficit) {
+            // Round used up: next turn with a fresh quantum
+            flow->deficit += static_cast<size_t>(flow->weight) * QUANTUM;
+            band->pop_front();
+            band->push_back(flow);
+        }
+        
+        if (!batch.empty()) {
+            // The link may consume the buffers, so count them first
+            size_t count = batch.size();
+            size_t sent = link_send_(*flow, batch);
+            dropped_ += count - std::min(sent, count);
+            backlog_ -= count;
+            total += count;
+            batch.clear();
+        }
+    }
+    
+    return total;
+}
+
+} // namespace tcp_stack
\ No newline at end of file
@@ -1,13 +1,57 @@
 #include "tcp_socket.h"
 #include "tcp_state_machine.h"
 #include "network_utils.h"
+#include "tcp_reliability.h"
+#include "tcp_sequence.h"
+#include "tcp_options.h"
+#include "tcp_reassembly.h"
+#include "sack_scoreboard.h"
+#include "tcp_connection_manager.h"
+#include "tcp_segmenter.h"
+#include "packet_buffer_pool.h"
+#include "tcp_receive_coalescer.h"
+#include "pacing_scheduler.h"
+#include "transmit_scheduler.h"
+#include "receive_buffer_tuner.h"
+#include "tcp_fastopen.h"
+#include "spsc_byte_ring.h"
+#include "event_notifier.h"
+#include "event_poller.h"
+#include "ip_layer.h"
+#include "busy_poll_engine.h"
+#include "epoch_reclaimer.h"
+#include "stack.h"
+#include "numa_utils.h"
+#include "logger.h"
 #include <iostream>
 #include <cassert>
 #include <chrono>
 #include <thread>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <cstring>
+#include <sys/epoll.h>
+#include <unistd.h>
 
 using namespace tcp_stack;
 
+namespace {
+
+int traced_transitions = 0;
+TCPState traced_from = TCPState::CLOSED;
+TCPState traced_to = TCPState::CLOSED;
+
+void count_transition(TCPState from, TCPState to, TCPEvent) {
+    ++traced_transitions;
+    traced_from = from;
+    traced_to = to;
+}
+
+} // namespace
+
 void test_state_machine() {
     std::cout << "Testing TCP State Machine..." << std::endl;
     
@@ -27,6 +71,31 @@ void test_state_machine() {
     // Test connection close
     sm.process_event(TCPEvent::CLOSE);
     assert(sm.get_state() == TCPState::FIN_WAIT_1);
+    assert(sm.get_state_name() == "FIN_WAIT_1");
+    
+    // The table is a compile-time constant
+    static_assert(TCPStateMachine::next_state(TCPState::CLOSED, TCPEvent::ACTIVE_OPEN) ==
+                  TCPState::SYN_SENT);
+    static_assert(TCPStateMachine::next_state(TCPState::LAST_ACK, TCPEvent::ACK_RECEIVED) ==
+                  TCPState::CLOSED);
+    static_assert(TCPStateMachine::next_state(TCPState::LISTEN, TCPEvent::RST_RECEIVED) ==
+                  TCPState::LISTEN);
+    static_assert(TCPStateMachine::next_state(TCPState::ESTABLISHED, TCPEvent::ACTIVE_OPEN) ==
+                  TCPState::ESTABLISHED);
+    static_assert(TCPStateMachine::get_state_name_for_state(TCPState::TIME_WAIT) == "TIME_WAIT");
+    static_assert(TCPStateMachine::get_event_name(TCPEvent::FIN_RECEIVED) == "FIN_RECEIVED");
+    
+    // Hooks see changes only, never events that leave the state alone
+    TCPStateMachine::set_transition_hook(count_transition);
+    sm.process_event(TCPEvent::PASSIVE_OPEN);
+    assert(traced_transitions == 0);
+    sm.process_event(TCPEvent::ACK_RECEIVED);
+    assert(traced_transitions == 1);
+    assert(traced_from == TCPState::FIN_WAIT_1 && traced_to == TCPState::FIN_WAIT_2);
+    TCPStateMachine::set_transition_hook(nullptr);
+    sm.process_event(TCPEvent::FIN_RECEIVED);
+    assert(traced_transitions == 1);
+    assert(sm.get_state() == TCPState::TIME_WAIT);
     
     std::cout << "State machine tests passed!" << std::endl;
 }
@@ -44,9 +113,1760 @@ void test_network_utils() {
     uint16_t checksum = NetworkUtils::calculate_checksum(data.data(), data.size());
     assert(checksum != 0); // Should not be zero for this data
     
+    // RFC 6528 ISNs: one tuple's numbers advance with the 4us clock
+    uint32_t local = NetworkUtils::ip_string_to_network("10.0.0.1");
+    uint32_t remote = NetworkUtils::ip_string_to_network("10.0.0.2");
+    uint32_t first = NetworkUtils::generate_sequence_number(local, 8080, remote, 40000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    uint32_t second = NetworkUtils::generate_sequence_number(local, 8080, remote, 40000);
+    [[maybe_unused]] uint32_t elapsed = second - first;
+    assert(elapsed >= 500 && elapsed < 250000);     // 2ms is 500 ticks
+    
     std::cout << "Network utils tests passed!" << std::endl;
 }
 
+void test_rtt_estimator() {
+    std::cout << "Testing RTT Estimator..." << std::endl;
+    
+    TCPReliability rel;
+    assert(!rel.has_rtt_sample());
+    assert(rel.get_rto() == TCPReliability::DEFAULT_INITIAL_RTO);
+    
+    // Datacenter-scale samples must not round down to zero
+    rel.set_min_rto(std::chrono::microseconds(1000));
+    rel.set_clock_granularity(std::chrono::microseconds(10));
+    rel.update_rtt(std::chrono::microseconds(80));
+    assert(rel.has_rtt_sample());
+    assert(rel.get_srtt().count() == 80);
+    assert(rel.get_rttvar().count() == 40);
+    assert(rel.get_rto().count() == 1000); // 80 + 4*40 clamped to min RTO
+    
+    for (int i = 0; i < 50; ++i) {
+        rel.update_rtt(std::chrono::microseconds(50));
+    }
+    assert(rel.get_srtt().count() >= 50 && rel.get_srtt().count() <= 52);
+    
+    // Lower min RTO lets the estimate through
+    rel.set_min_rto(std::chrono::microseconds(1));
+    rel.update_rtt(std::chrono::microseconds(50));
+    assert(rel.get_rto() < std::chrono::microseconds(200));
+    
+    // Zero-length samples still count
+    TCPReliability fresh;
+    fresh.update_rtt(std::chrono::microseconds(0));
+    assert(fresh.has_rtt_sample());
+    assert(fresh.get_rto() == TCPReliability::DEFAULT_MIN_RTO);
+    
+    std::cout << "RTT estimator tests passed!" << std::endl;
+}
+
+void test_fast_retransmit() {
+    std::cout << "Testing Fast Retransmit / NewReno..." << std::endl;
+    
+    assert(seq_lt(0xFFFFFF00u, 0x00000100u));
+    assert(seq_geq(0x00000100u, 0xFFFFFF00u));
+    
+    // Start just below 2^32 so the window straddles the wrap
+    const uint32_t isn = 0xFFFFF000u;
+    TCPReliability rel;
+    rel.set_initial_seq(isn);
+    rel.set_mss(1000);
+    rel.buffer_data(std::vector<uint8_t>(5000, 0xAB));
+    for (int i = 0; i < 5; ++i) {
+        auto sent = rel.get_data_to_send(1000);
+        assert(sent.size() == 1000);
+    }
+    assert(rel.get_bytes_in_flight() == 5000);
+    
+    // First segment lost: the receiver keeps acking isn
+    rel.process_ack(isn + 1000);
+    rel.process_ack(isn + 1000);
+    rel.process_ack(isn + 1000);
+    assert(!rel.in_fast_recovery());
+    rel.process_ack(isn + 1000);
+    assert(rel.in_fast_recovery());
+    assert(rel.get_ssthresh() == 2000);
+    
+    auto retx = rel.take_fast_retransmits();
+    assert(retx.size() == 1 && retx[0]->seq_num == isn + 1000);
+    retx = rel.take_fast_retransmits();
+    assert(retx.empty());
+    
+    // Partial ACK: the segment at isn + 3000 was lost too
+    rel.process_ack(isn + 3000);
+    assert(rel.in_fast_recovery());
+    retx = rel.take_fast_retransmits();
+    assert(retx.size() == 1 && retx[0]->seq_num == isn + 3000);
+    
+    // Full ACK past the wrap ends recovery
+    rel.process_ack(isn + 5000);
+    assert(!rel.in_fast_recovery());
+    assert(rel.get_bytes_in_flight() == 0);
+    assert(rel.get_last_ack() == isn + 5000);
+    assert(rel.get_cwnd() <= rel.get_ssthresh());
+    
+    // Data-bearing or window-changing ACKs are not duplicates
+    rel.buffer_data(std::vector<uint8_t>(1000, 0xCD));
+    rel.get_data_to_send(1000);
+    rel.process_ack(isn + 5000, 65535, 100);
+    rel.process_ack(isn + 5000, 65535, 100);
+    rel.process_ack(isn + 5000, 65535, 100);
+    assert(rel.get_dup_ack_count() == 0);
+    
+    std::cout << "Fast retransmit tests passed!" << std::endl;
+}
+
+void test_sack() {
+    std::cout << "Testing SACK..." << std::endl;
+    
+    // Option round trip
+    TCPOptions out;
+    out.sack_blocks = {{1000, 2000}, {3000, 4000}};
+    auto wire = out.serialize();
+    assert(wire.size() % 4 == 0 && wire.size() <= TCPOptions::MAX_LENGTH);
+    TCPOptions in;
+    [[maybe_unused]] bool parsed = TCPOptions::parse(wire.data(), wire.size(), in);
+    assert(parsed && !in.sack_permitted && in.sack_blocks == out.sack_blocks);
+    
+    TCPOptions syn;
+    syn.sack_permitted = true;
+    wire = syn.serialize();
+    parsed = TCPOptions::parse(wire.data(), wire.size(), in);
+    assert(parsed && in.sack_permitted);
+    
+    uint8_t truncated[] = {TCPOptions::KIND_SACK, 10, 0, 0};
+    parsed = TCPOptions::parse(truncated, sizeof(truncated), in);
+    assert(!parsed);
+    
+    // Scoreboard merges overlapping and adjacent ranges
+    SackScoreboard board;
+    board.add(3000, 4000);
+    board.add(1000, 2000);
+    board.add(2000, 2500);
+    assert(board.range_count() == 2 && board.sacked_bytes() == 2500);
+    assert(board.is_sacked(1200, 2500) && !board.is_sacked(2400, 2600));
+    board.add(2400, 3100);
+    assert(board.range_count() == 1 && board.highest_sacked() == 4000);
+    board.remove_below(1500);
+    assert(board.sacked_bytes() == 2500);
+    
+    // Receiver queue generates blocks, most recent first, and reassembles
+    TCPReassemblyQueue queue;
+    std::vector<uint8_t> payload(100, 0x11);
+    queue.insert(1100, payload.data(), payload.size());
+    queue.insert(1300, payload.data(), payload.size());
+    auto blocks = queue.sack_blocks(TCPOptions::MAX_SACK_BLOCKS);
+    assert(blocks.size() == 2 && blocks[0].start == 1300 && blocks[1].start == 1100);
+    
+    uint32_t rcv_nxt = 1100;
+    std::vector<uint8_t> delivered;
+    queue.take_in_order(rcv_nxt, delivered);
+    assert(rcv_nxt == 1200 && delivered.size() == 100 && !queue.empty());
+    
+    // Sender retransmits only the holes (RFC 6675)
+    TCPReliability rel;
+    rel.set_initial_seq(0);
+    rel.set_mss(100);
+    rel.set_sack_enabled(true);
+    rel.buffer_data(std::vector<uint8_t>(1000, 0x22));
+    for (int i = 0; i < 10; ++i) {
+        rel.get_data_to_send(100);
+    }
+    
+    // Segments [0,100) and [300,400) lost
+    rel.process_ack(0, 65535, 0, {{100, 300}});
+    rel.process_ack(0, 65535, 0, {{400, 600}, {100, 300}});
+    assert(rel.in_fast_recovery());
+    rel.process_ack(0, 65535, 0, {{400, 1000}, {100, 300}});
+    
+    std::vector<uint32_t> resent;
+    for (auto& segment : rel.take_fast_retransmits()) {
+        resent.push_back(segment->seq_num);
+    }
+    assert(resent.size() == 2 && resent[0] == 0 && resent[1] == 300);
+    
+    rel.process_ack(300, 65535, 0, {{400, 1000}});
+    auto retx = rel.take_fast_retransmits();
+    assert(retx.empty());
+    rel.process_ack(1000);
+    assert(!rel.in_fast_recovery() && rel.get_scoreboard().empty());
+    
+    std::cout << "SACK tests passed!" << std::endl;
+}
+
+void test_rack_tlp() {
+    std::cout << "Testing RACK-TLP..." << std::endl;
+    
+    // RACK: a later segment is SACKed, earlier ones are declared lost once
+    // the reordering window has passed
+    TCPReliability rack;
+    rack.set_initial_seq(0);
+    rack.set_mss(100);
+    rack.set_sack_enabled(true);
+    rack.set_loss_detection(LossDetection::RACK_TLP);
+    rack.buffer_data(std::vector<uint8_t>(300, 0x33));
+    for (int i = 0; i < 3; ++i) {
+        rack.get_data_to_send(100);
+    }
+    
+    std::this_thread::sleep_for(std::chrono::milliseconds(4));
+    rack.process_ack(0, 65535, 0, {{200, 300}});
+    auto lost = rack.take_fast_retransmits();
+    assert(lost.empty());   // Still within reo_wnd
+    
+    std::this_thread::sleep_for(std::chrono::milliseconds(4));
+    rack.process_timers();
+    lost = rack.take_fast_retransmits();
+    assert(lost.size() == 2 && lost[0]->seq_num == 0 && lost[1]->seq_num == 100);
+    assert(rack.in_fast_recovery());
+    
+    // TLP: nothing comes back for the tail, a probe goes out after the PTO
+    TCPReliability tlp;
+    tlp.set_initial_seq(5000);
+    tlp.set_min_rto(std::chrono::microseconds(1));
+    tlp.set_loss_detection(LossDetection::RACK_TLP);
+    tlp.update_rtt(std::chrono::microseconds(100));
+    tlp.buffer_data(std::vector<uint8_t>(2000, 0x44));
+    tlp.get_data_to_send(1000);
+    tlp.get_data_to_send(1000);
+    assert(tlp.get_next_timer_deadline() <=
+           std::chrono::steady_clock::now() + std::chrono::microseconds(200));
+    
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    tlp.process_timers();
+    auto probe = tlp.take_fast_retransmits();
+    assert(probe.size() == 1 && probe[0]->seq_num == 6000);
+    assert(tlp.get_tlp_probe_count() == 1);
+    
+    // The episode ends with the ACK; assume the probe repaired a loss
+    tlp.process_ack(7000);
+    assert(tlp.get_ssthresh() != UINT32_MAX);
+    assert(tlp.get_cwnd() <= tlp.get_ssthresh());
+    
+    std::cout << "RACK-TLP tests passed!" << std::endl;
+}
+
+// Build a checksummed segment as the manager would receive it from a peer
+std::vector<uint8_t> make_segment(const IPHeader& ip, uint16_t src_port, uint16_t dst_port,
+                                  uint32_t seq, uint32_t ack, uint8_t flags,
+                                  const std::vector<uint8_t>& data = {},
+                                  const TCPOptions& options = TCPOptions(),
+                                  uint16_t window = 65535) {
+    std::vector<uint8_t> option_bytes = options.serialize();
+
+    TCPHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.src_port = src_port;
+    header.dst_port = dst_port;
+    header.seq_num = seq;
+    header.ack_num = ack;
+    header.set_data_offset((sizeof(TCPHeader) + option_bytes.size()) / 4);
+    header.flags = flags;
+    header.window_size = window;
+    
+    TCPPseudoHeader pseudo_header;
+    pseudo_header.src_ip = ip.src_ip;
+    pseudo_header.dst_ip = ip.dst_ip;
+    pseudo_header.reserved = 0;
+    pseudo_header.protocol = tcp_stack::IPPROTO_TCP;
+    pseudo_header.tcp_length = htons(sizeof(TCPHeader) + option_bytes.size() + data.size());
+    std::vector<std::pair<const void*, size_t>> parts = {
+        {&pseudo_header, sizeof(pseudo_header)}, {&header, sizeof(header)}};
+    if (!option_bytes.empty()) {
+        parts.push_back({option_bytes.data(), option_bytes.size()});
+    }
+    if (!data.empty()) {
+        parts.push_back({data.data(), data.size()});
+    }
+    header.checksum = NetworkUtils::calculate_checksum(parts);
+    header.to_network_order();
+    
+    std::vector<uint8_t> segment(sizeof(header));
+    std::memcpy(segment.data(), &header, sizeof(header));
+    segment.insert(segment.end(), option_bytes.begin(), option_bytes.end());
+    segment.insert(segment.end(), data.begin(), data.end());
+    return segment;
+}
+
+// The peer, 10.0.0.2, talking to us at 10.0.0.1
+IPHeader make_test_ip() {
+    IPHeader ip;
+    std::memset(&ip, 0, sizeof(ip));
+    ip.src_ip = NetworkUtils::ip_string_to_network("10.0.0.2");
+    ip.dst_ip = NetworkUtils::ip_string_to_network("10.0.0.1");
+    return ip;
+}
+
+// Complete a passive open on port 8080 from the peer's remote_port
+std::shared_ptr<TCPConnection> establish_connection(TCPConnectionManager& manager,
+                                                    const IPHeader& ip, uint16_t remote_port) {
+    manager.process_incoming_segment(ip, make_segment(ip, remote_port, 8080, 1000, 0, TCPHeader::SYN));
+    auto conn = manager.find_connection(ip.dst_ip, 8080, ip.src_ip, remote_port);
+    manager.process_incoming_segment(ip, make_segment(ip, remote_port, 8080, 1001, conn->local_seq,
+                                                      TCPHeader::ACK));
+    return conn;
+}
+
+void test_delayed_ack() {
+    std::cout << "Testing Delayed ACK..." << std::endl;
+    
+    // No raw socket: ACKs are attempted but go nowhere, which is enough to
+    // observe when the manager decides to acknowledge
+    TCPConnectionManager manager;
+    IPHeader ip = make_test_ip();
+    
+    TCPConnectionConfig config;
+    config.delayed_ack_timeout = std::chrono::milliseconds(5);
+    manager.listen(ip.dst_ip, 8080, config);
+    manager.process_incoming_segment(ip, make_segment(ip, 40000, 8080, 1000, 0, TCPHeader::SYN));
+    auto conn = manager.find_connection(ip.dst_ip, 8080, ip.src_ip, 40000);
+    assert(conn);
+    manager.process_incoming_segment(ip, make_segment(ip, 40000, 8080, 1001, conn->local_seq,
+                                                      TCPHeader::ACK));
+    assert(conn->state_machine.is_established());
+    
+    // Slow start: the first segments are ACKed one by one
+    std::vector<uint8_t> payload(1000, 0x55);
+    uint32_t seq = 1001;
+    manager.process_incoming_segment(ip, make_segment(ip, 40000, 8080, seq, conn->local_seq,
+                                                      TCPHeader::ACK, payload));
+    seq += 1000;
+    assert(conn->ack_pending_bytes == 0);
+    assert(conn->quick_acks_remaining == TCPConnection::QUICK_ACK_SEGMENTS - 1);
+    
+    // Past the quick-ACK budget: every second full segment
+    conn->quick_acks_remaining = 0;
+    manager.process_incoming_segment(ip, make_segment(ip, 40000, 8080, seq, conn->local_seq,
+                                                      TCPHeader::ACK, payload));
+    seq += 1000;
+    assert(conn->ack_pending_bytes == 1000);
+    assert(conn->ack_deadline != std::chrono::steady_clock::time_point::max());
+    manager.process_incoming_segment(ip, make_segment(ip, 40000, 8080, seq, conn->local_seq,
+                                                      TCPHeader::ACK, payload));
+    seq += 1000;
+    assert(conn->ack_pending_bytes == 0);
+    assert(conn->ack_deadline == std::chrono::steady_clock::time_point::max());
+    
+    // A lone segment is ACKed by the timer
+    manager.process_incoming_segment(ip, make_segment(ip, 40000, 8080, seq, conn->local_seq,
+                                                      TCPHeader::ACK, payload));
+    seq += 1000;
+    manager.process_timers(conn);
+    assert(conn->ack_pending_bytes == 1000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(6));
+    manager.process_timers(conn);
+    assert(conn->ack_pending_bytes == 0);
+    
+    // ...or piggybacked on outgoing data
+    manager.process_incoming_segment(ip, make_segment(ip, 40000, 8080, seq, conn->local_seq,
+                                                      TCPHeader::ACK, payload));
+    seq += 1000;
+    assert(conn->ack_pending_bytes == 1000);
+    manager.send_segment(conn, {0x01, 0x02}, TCPHeader::PSH | TCPHeader::ACK);
+    assert(conn->ack_pending_bytes == 0);
+    
+    // Out-of-order data is ACKed at once and re-enters quick-ACK mode
+    manager.process_incoming_segment(ip, make_segment(ip, 40000, 8080, seq + 1000, conn->local_seq,
+                                                      TCPHeader::ACK, payload));
+    assert(conn->ack_pending_bytes == 0);
+    assert(conn->quick_acks_remaining == TCPConnection::QUICK_ACK_SEGMENTS);
+    
+    // Quick-ACK mode for interactive flows
+    conn->quick_acks_remaining = 0;
+    conn->config.quick_ack = true;
+    manager.process_incoming_segment(ip, make_segment(ip, 40000, 8080, seq, conn->local_seq,
+                                                      TCPHeader::ACK, payload));
+    assert(conn->ack_pending_bytes == 0);
+    
+    std::cout << "Delayed ACK tests passed!" << std::endl;
+}
+
+void test_mss_and_path_mtu() {
+    std::cout << "Testing MSS and Path MTU..." << std::endl;
+    
+    // MSS option round trip
+    TCPOptions syn_options;
+    syn_options.mss = 8960;
+    syn_options.sack_permitted = true;
+    auto wire = syn_options.serialize();
+    assert(wire.size() == 8);
+    TCPOptions parsed;
+    [[maybe_unused]] bool ok = TCPOptions::parse(wire.data(), wire.size(), parsed);
+    assert(ok && parsed.mss == 8960 && parsed.sack_permitted);
+    
+    // ICMP-driven discovery, including the plateau fallback
+    PathMTU pmtu;
+    pmtu.reset(9000, true);
+    assert(pmtu.get_mss() == 8960);
+    [[maybe_unused]] bool lowered = pmtu.on_packet_too_big(1500, 9000);
+    assert(lowered && pmtu.get_mtu() == 1500);
+    lowered = pmtu.on_packet_too_big(4000, 1500);
+    assert(!lowered);   // Never raised by ICMP
+    lowered = pmtu.on_packet_too_big(0, 1500);
+    assert(lowered && pmtu.get_mtu() == 1492);
+    
+    // Black hole: fall back, then binary-search upward with probes
+    lowered = pmtu.on_black_hole();
+    assert(lowered && pmtu.get_mtu() == PathMTU::BASE_MTU);
+    auto now = std::chrono::steady_clock::now();
+    [[maybe_unused]] bool probing = pmtu.should_probe(now);
+    assert(probing);
+    uint32_t probe = pmtu.next_probe_size();
+    assert(probe > PathMTU::BASE_MTU && probe < 1492);
+    pmtu.on_probe_sent(1000, 1000 + probe - 40, probe);
+    probing = pmtu.should_probe(now);
+    assert(!probing);
+    [[maybe_unused]] bool raised = pmtu.on_ack(1000);
+    assert(!raised);
+    raised = pmtu.on_ack(1000 + probe - 40);
+    assert(raised && pmtu.get_mtu() == probe);
+    
+    uint32_t second = pmtu.next_probe_size();
+    pmtu.on_probe_sent(5000, 5000 + second - 40, second);
+    assert(pmtu.is_probe(5000));
+    pmtu.on_probe_lost();
+    assert(pmtu.get_mtu() == probe && pmtu.get_search_high() == second - 1);
+    
+    // MSS exchange on the handshake
+    TCPConnectionManager manager;
+    IPHeader ip = make_test_ip();
+    manager.listen(ip.dst_ip, 8080);
+    
+    TCPOptions peer_options;
+    peer_options.mss = 8960;
+    manager.process_incoming_segment(ip, make_segment(ip, 40001, 8080, 1, 0, TCPHeader::SYN,
+                                                      {}, peer_options));
+    auto jumbo = manager.find_connection(ip.dst_ip, 8080, ip.src_ip, 40001);
+    assert(jumbo && jumbo->peer_mss == 8960);
+    assert(jumbo->effective_mss() == std::min<uint32_t>(jumbo->local_mss, 8960));
+    
+    manager.process_incoming_segment(ip, make_segment(ip, 40002, 8080, 1, 0, TCPHeader::SYN));
+    auto legacy = manager.find_connection(ip.dst_ip, 8080, ip.src_ip, 40002);
+    assert(legacy && legacy->peer_mss == TCPConnection::DEFAULT_PEER_MSS);
+    assert(legacy->effective_mss() == TCPConnection::DEFAULT_PEER_MSS);
+    
+    // ICMP fragmentation needed quoting one of our segments
+    auto frag_needed = [&](uint32_t quoted_seq) {
+        ICMPHeader icmp;
+        std::memset(&icmp, 0, sizeof(icmp));
+        icmp.type = ICMPHeader::TYPE_DEST_UNREACHABLE;
+        icmp.code = ICMPHeader::CODE_FRAG_NEEDED;
+        icmp.next_hop_mtu = htons(1400);
+        IPHeader quoted;
+        std::memset(&quoted, 0, sizeof(quoted));
+        quoted.set_version(4);
+        quoted.set_ihl(5);
+        quoted.protocol = tcp_stack::IPPROTO_TCP;
+        quoted.total_length = htons(1500);
+        quoted.src_ip = ip.dst_ip;
+        quoted.dst_ip = ip.src_ip;
+        uint16_t ports[2] = {htons(8080), htons(40001)};
+        uint32_t seq = htonl(quoted_seq);
+        
+        std::vector<uint8_t> message(sizeof(icmp) + sizeof(quoted) + 8);
+        std::memcpy(message.data(), &icmp, sizeof(icmp));
+        std::memcpy(message.data() + sizeof(icmp), &quoted, sizeof(quoted));
+        std::memcpy(message.data() + sizeof(icmp) + sizeof(quoted), ports, sizeof(ports));
+        std::memcpy(message.data() + sizeof(icmp) + sizeof(quoted) + 4, &seq, sizeof(seq));
+        return message;
+    };
+    
+    IPHeader icmp_ip = ip;
+    icmp_ip.protocol = tcp_stack::IPPROTO_ICMP;
+    [[maybe_unused]] bool handled =
+        manager.process_icmp_message(icmp_ip, frag_needed(jumbo->local_seq + 100000));
+    assert(!handled && jumbo->path_mtu.get_mtu() != 1400);
+    handled = manager.process_icmp_message(icmp_ip, frag_needed(jumbo->local_seq));
+    assert(handled && jumbo->path_mtu.get_mtu() == 1400);
+    assert(jumbo->effective_mss() == 1360);
+    assert(manager.next_segment_size(jumbo, 100000) == 1360);
+    
+    std::cout << "MSS and Path MTU tests passed!" << std::endl;
+}
+
+void test_nagle_and_cork() {
+    std::cout << "Testing Nagle and Cork..." << std::endl;
+    
+    TCPConnectionManager manager;
+    IPHeader ip = make_test_ip();
+    manager.listen(ip.dst_ip, 8080);
+    auto conn = establish_connection(manager, ip, 40010);
+    assert(conn->state_machine.is_established());
+    
+    auto reliability = std::make_shared<TCPReliability>();
+    reliability->set_initial_seq(conn->local_seq);
+    reliability->set_mss(conn->effective_mss());
+    conn->reliability = reliability;
+    size_t mss = conn->effective_mss();
+    auto ack_everything = [&]() {
+        manager.process_incoming_segment(ip, make_segment(ip, 40010, 8080, conn->local_ack,
+                                                          reliability->get_next_seq(), TCPHeader::ACK));
+    };
+    
+    // Nothing in flight: a small write goes straight out
+    reliability->buffer_data(std::vector<uint8_t>(100, 0x01));
+    [[maybe_unused]] size_t sent = manager.flush_send_queue(conn);
+    assert(sent == 100);    // No raw socket: lost on the wire
+    assert(reliability->get_bytes_in_flight() == 100);
+    assert(reliability->get_buffered_bytes() == 0);
+    
+    // Nagle: the next small write waits for that ACK, full segments do not
+    reliability->buffer_data(std::vector<uint8_t>(100, 0x02));
+    manager.flush_send_queue(conn);
+    assert(reliability->get_buffered_bytes() == 100);
+    reliability->buffer_data(std::vector<uint8_t>(mss, 0x03));
+    manager.flush_send_queue(conn);
+    assert(reliability->get_buffered_bytes() == 100);
+    assert(reliability->get_bytes_in_flight() == 100 + mss);
+    
+    // The ACK releases the held tail
+    ack_everything();
+    assert(reliability->get_buffered_bytes() == 0);
+    assert(reliability->get_bytes_in_flight() == 100);
+    
+    // TCP_NODELAY-like option
+    conn->config.nodelay = true;
+    reliability->buffer_data(std::vector<uint8_t>(10, 0x04));
+    manager.flush_send_queue(conn);
+    assert(reliability->get_buffered_bytes() == 0);
+    conn->config.nodelay = false;
+    ack_everything();
+    
+    // "More data coming": a header is held and merged with its body
+    reliability->buffer_data(std::vector<uint8_t>(20, 0x05));
+    manager.flush_send_queue(conn, true);
+    assert(reliability->get_buffered_bytes() == 20);
+    reliability->buffer_data(std::vector<uint8_t>(200, 0x06));
+    manager.flush_send_queue(conn);
+    assert(reliability->get_buffered_bytes() == 0);
+    assert(reliability->get_bytes_in_flight() == 220);
+    ack_everything();
+    
+    // Cork: held until uncorked or the cork timer fires
+    conn->corked = true;
+    reliability->buffer_data(std::vector<uint8_t>(30, 0x07));
+    manager.flush_send_queue(conn);
+    assert(reliability->get_buffered_bytes() == 30);
+    assert(conn->cork_deadline != std::chrono::steady_clock::time_point::max());
+    manager.process_timers(conn);
+    assert(reliability->get_buffered_bytes() == 30);
+    conn->cork_deadline = std::chrono::steady_clock::now();
+    manager.process_timers(conn);
+    assert(reliability->get_buffered_bytes() == 0);
+    
+    std::cout << "Nagle and cork tests passed!" << std::endl;
+}
+
+void test_segmentation_offload() {
+    std::cout << "Testing Segmentation Offload..." << std::endl;
+    
+    // One pass over the send queue yields MSS-sized segments within the window
+    TCPReliability reliability;
+    reliability.set_initial_seq(0);
+    reliability.set_mss(1460);
+    reliability.buffer_data(std::vector<uint8_t>(20000, 0x11));
+    auto burst = reliability.get_burst_to_send(TCPConnectionManager::GSO_MAX_BYTES, 1460);
+    assert(burst.size() == TCPReliability::INITIAL_CWND_SEGMENTS);
+    assert(burst[1]->seq_num == 1460 && burst[1]->data.size() == 1460);
+    assert(reliability.get_buffered_bytes() == 20000 - 14600);
+    
+    // Pooled buffers are recycled with their capacity
+    PacketBufferPool pool;
+    auto buffer = pool.acquire(9000);
+    [[maybe_unused]] const uint8_t* storage = buffer.data();
+    pool.release(std::move(buffer));
+    assert(pool.cached() == 1);
+    auto reused = pool.acquire(1500);
+    assert(reused.data() == storage && reused.size() == 1500);
+    
+    // Template-built segments are byte-identical to ones built from scratch
+    IPHeader ip = make_test_ip();
+    TCPConnectionManager manager;
+    manager.listen(ip.dst_ip, 8080);
+    auto conn = establish_connection(manager, ip, 40020);
+    
+    TCPHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.src_port = 40020;
+    header.dst_port = 8080;
+    header.ack_num = conn->local_seq;
+    header.window_size = 65535;
+    TCPSegmenter segmenter(ip.src_ip, ip.dst_ip, header, {});
+    
+    std::vector<uint8_t> payload(2001);
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = static_cast<uint8_t>(i * 7);
+    }
+    uint32_t seq = 1001;
+    for (size_t offset = 0; offset < payload.size(); offset += 1000) {
+        size_t length = std::min<size_t>(1000, payload.size() - offset);
+        uint8_t flags = TCPHeader::ACK | (offset + length == payload.size() ? TCPHeader::PSH : 0);
+        std::vector<uint8_t> built(segmenter.header_length() + length);
+        segmenter.build(seq, flags, payload.data() + offset, length, built, 0);
+        
+        std::vector<uint8_t> slice(payload.begin() + offset, payload.begin() + offset + length);
+        assert(built == make_segment(ip, 40020, 8080, seq, conn->local_seq, flags, slice));
+        [[maybe_unused]] bool accepted = manager.process_incoming_segment(ip, built);
+        assert(accepted);
+        seq += static_cast<uint32_t>(length);
+    }
+    assert(conn->pending_data == payload);
+    
+    // IP headers filled from one template still validate
+    IPLayer ip_layer;
+    std::vector<std::vector<uint8_t>> packets;
+    packets.push_back(std::vector<uint8_t>(sizeof(IPHeader) + 100, 0xAA));
+    packets.push_back(std::vector<uint8_t>(sizeof(IPHeader) + 37, 0xBB));
+    ip_layer.prepare_batch(ip.dst_ip, ip.src_ip, tcp_stack::IPPROTO_TCP, packets);
+    for (const auto& packet : packets) {
+        IPHeader parsed;
+        std::vector<uint8_t> parsed_payload;
+        [[maybe_unused]] bool valid = ip_layer.parse_packet(packet, parsed, parsed_payload);
+        assert(valid && parsed_payload.size() == packet.size() - sizeof(IPHeader));
+    }
+    
+    std::cout << "Segmentation offload tests passed!" << std::endl;
+}
+
+void test_receive_coalescing() {
+    std::cout << "Testing Receive Coalescing..." << std::endl;
+    
+    IPHeader ip = make_test_ip();
+    
+    auto segment = [&](uint16_t port, uint32_t seq, uint8_t flags, size_t length) {
+        ReceivedSegment s;
+        s.ip_header = ip;
+        std::memset(&s.tcp_header, 0, sizeof(s.tcp_header));
+        s.tcp_header.src_port = port;
+        s.tcp_header.dst_port = 8080;
+        s.tcp_header.seq_num = seq;
+        s.tcp_header.ack_num = 1;
+        s.tcp_header.flags = flags;
+        s.tcp_header.window_size = 65535;
+        s.payload.assign(length, 0x42);
+        return s;
+    };
+    
+    // Contiguous runs merge per flow; PSH ends a run, a gap starts a new one
+    TCPReceiveCoalescer coalescer;
+    coalescer.add(segment(1, 100, TCPHeader::ACK, 10));
+    coalescer.add(segment(2, 500, TCPHeader::ACK, 10));
+    coalescer.add(segment(1, 110, TCPHeader::ACK, 10));
+    coalescer.add(segment(1, 120, TCPHeader::ACK | TCPHeader::PSH, 10));
+    coalescer.add(segment(1, 130, TCPHeader::ACK, 10));
+    coalescer.add(segment(2, 520, TCPHeader::ACK, 10));
+    auto merged = coalescer.flush();
+    assert(merged.size() == 4 && coalescer.empty());
+    assert(merged[0].tcp_header.src_port == 1 && merged[0].payload.size() == 30);
+    assert(merged[0].segment_count == 3 && merged[0].max_segment_size == 10);
+    assert(merged[0].tcp_header.has_flag(TCPHeader::PSH));
+    assert(merged[1].tcp_header.src_port == 2 && merged[1].payload.size() == 10);
+    assert(merged[2].tcp_header.seq_num == 130);
+    assert(merged[3].tcp_header.seq_num == 520);
+    
+    // Through the manager: one delivery and one ACK decision per burst
+    TCPConnectionManager manager;
+    manager.listen(ip.dst_ip, 8080);
+    auto conn = establish_connection(manager, ip, 40030);
+    conn->quick_acks_remaining = 0;
+    size_t deliveries = 0;
+    std::vector<uint8_t> received;
+    conn->data_handler = [&](const std::vector<uint8_t>& data) {
+        deliveries++;
+        received.insert(received.end(), data.begin(), data.end());
+    };
+    
+    std::vector<std::pair<IPHeader, std::vector<uint8_t>>> burst;
+    for (uint32_t i = 0; i < 4; ++i) {
+        uint8_t flags = TCPHeader::ACK | (i == 3 ? TCPHeader::PSH : 0);
+        burst.emplace_back(ip, make_segment(ip, 40030, 8080, 1001 + i * 1000, conn->local_seq,
+                                            flags, std::vector<uint8_t>(1000, 0x10 + i)));
+    }
+    [[maybe_unused]] size_t segments = manager.process_incoming_batch(burst);
+    assert(segments == 1);
+    assert(deliveries == 1 && received.size() == 4000);
+    assert(received[3999] == 0x13);
+    assert(conn->rcv_mss == 1000);          // Wire segment size, not the merged size
+    assert(conn->ack_pending_bytes == 0);   // Four full segments: ACKed at once
+    
+    std::cout << "Receive coalescing tests passed!" << std::endl;
+}
+
+void test_header_prediction() {
+    std::cout << "Testing Header Prediction..." << std::endl;
+    
+    TCPConnectionManager manager;
+    IPHeader ip = make_test_ip();
+    manager.listen(ip.dst_ip, 8080);
+    auto conn = establish_connection(manager, ip, 40040);
+    assert(conn->fast_path_segments == 0); // The handshake ACK takes the slow path
+    
+    auto reliability = std::make_shared<TCPReliability>();
+    reliability->set_initial_seq(conn->local_seq);
+    reliability->set_mss(conn->effective_mss());
+    conn->reliability = reliability;
+    std::vector<uint8_t> received;
+    conn->data_handler = [&](const std::vector<uint8_t>& data) {
+        received.insert(received.end(), data.begin(), data.end());
+    };
+    auto deliver = [&](uint32_t seq, uint8_t flags, size_t length, uint16_t window = 65535) {
+        manager.process_incoming_segment(ip, make_segment(ip, 40040, 8080, seq,
+                                                          reliability->get_last_ack(), flags,
+                                                          std::vector<uint8_t>(length, 0x55),
+                                                          TCPOptions(), window));
+    };
+    
+    // In-order data and ACK|PSH are predicted
+    deliver(1001, TCPHeader::ACK, 100);
+    deliver(1101, TCPHeader::ACK | TCPHeader::PSH, 100);
+    assert(conn->fast_path_segments == 2);
+    assert(received.size() == 200 && conn->local_ack == 1201);
+    
+    // A pure ACK for new data is predicted and clears the flight
+    reliability->buffer_data(std::vector<uint8_t>(100, 0x01));
+    manager.flush_send_queue(conn);
+    assert(reliability->get_bytes_in_flight() == 100);
+    manager.process_incoming_segment(ip, make_segment(ip, 40040, 8080, conn->local_ack,
+                                                      reliability->get_next_seq(), TCPHeader::ACK));
+    assert(conn->fast_path_segments == 3);
+    assert(reliability->get_bytes_in_flight() == 0);
+    
+    // Out of order, a window change and a duplicate ACK all miss the prediction
+    deliver(1301, TCPHeader::ACK, 100);
+    assert(conn->fast_path_segments == 3 && received.size() == 200);
+    deliver(1201, TCPHeader::ACK, 100);     // Fills the gap, reassembly was non-empty
+    assert(conn->fast_path_segments == 3 && received.size() == 400);
+    deliver(1401, TCPHeader::ACK, 100, 32768);
+    assert(conn->fast_path_segments == 3 && received.size() == 500);
+    assert(conn->peer_window == 32768);
+    deliver(1501, TCPHeader::ACK, 0, 32768);
+    assert(conn->fast_path_segments == 3);
+    deliver(1501, TCPHeader::ACK, 100, 32768);  // New window learned: predicted again
+    assert(conn->fast_path_segments == 4 && received.size() == 600);
+    
+    // FIN|ACK carrying data: data first, then the FIN moves us to CLOSE_WAIT
+    deliver(1601, TCPHeader::ACK | TCPHeader::FIN, 50, 32768);
+    assert(conn->fast_path_segments == 4 && received.size() == 650);
+    assert(conn->local_ack == 1652);
+    assert(conn->state_machine.get_state() == TCPState::CLOSE_WAIT);
+    
+    std::cout << "Header prediction tests passed!" << std::endl;
+}
+
+void test_pacing() {
+    std::cout << "Testing Pacing..." << std::endl;
+    
+    // Timing wheel: never early, in time order, far times clamp to the horizon
+    auto origin = std::chrono::steady_clock::now();
+    PacingScheduler scheduler(origin);
+    auto first = std::make_shared<TCPConnection>();
+    auto second = std::make_shared<TCPConnection>();
+    auto far = std::make_shared<TCPConnection>();
+    scheduler.schedule(second, origin + std::chrono::microseconds(95));
+    scheduler.schedule(first, origin + std::chrono::microseconds(30));
+    scheduler.schedule(far, origin + std::chrono::seconds(10));
+    assert(scheduler.size() == 3);
+    assert(scheduler.next_deadline() == origin + std::chrono::microseconds(30));
+    auto due = scheduler.advance(origin + std::chrono::microseconds(29));
+    assert(due.empty());
+    due = scheduler.advance(origin + std::chrono::microseconds(100));
+    assert(due.size() == 2 && due[0] == first && due[1] == second);
+    assert(scheduler.next_deadline() <= origin + PacingScheduler::SLOT_WIDTH * PacingScheduler::NUM_SLOTS);
+    due = scheduler.advance(origin + std::chrono::seconds(1));
+    assert(due.size() == 1 && due[0] == far && scheduler.empty());
+    
+    // A capped connection sends two segments, then waits for the scheduler
+    TCPConnectionManager manager;
+    IPHeader ip = make_test_ip();
+    TCPConnectionConfig config;
+    config.nodelay = true;
+    config.max_pacing_rate = 1000000;   // 1MB/s: two 1460-byte segments take ~3ms
+    manager.listen(ip.dst_ip, 8080, config);
+    auto conn = establish_connection(manager, ip, 40050);
+    
+    auto reliability = std::make_shared<TCPReliability>();
+    reliability->set_initial_seq(conn->local_seq);
+    reliability->set_mss(conn->effective_mss());
+    conn->reliability = reliability;
+    size_t mss = conn->effective_mss();
+    
+    reliability->buffer_data(std::vector<uint8_t>(6 * mss, 0x01));
+    [[maybe_unused]] size_t sent = manager.flush_send_queue(conn);
+    assert(sent == 2 * mss);
+    assert(conn->pacing_rate == 1000000);
+    sent = manager.flush_send_queue(conn);
+    assert(sent == 0 && conn->pacing_scheduled);
+    manager.process_pacing();
+    assert(reliability->get_bytes_in_flight() == 2 * mss);
+    
+    auto deadline = manager.next_pacing_deadline();
+    assert(deadline >= conn->next_send_time);
+    assert(deadline < std::chrono::steady_clock::now() + std::chrono::milliseconds(4));
+    std::this_thread::sleep_until(deadline);
+    manager.process_pacing();
+    assert(reliability->get_bytes_in_flight() == 4 * mss);
+    assert(reliability->get_buffered_bytes() == 2 * mss);
+    
+    // Uncapped, the rate follows cwnd/srtt once there is an RTT sample;
+    // congestion control can set it outright
+    conn->config.max_pacing_rate = 0;
+    manager.process_incoming_segment(ip, make_segment(ip, 40050, 8080, conn->local_ack,
+                                                      reliability->get_next_seq(), TCPHeader::ACK));
+    assert(reliability->has_rtt_sample());
+    manager.update_pacing_rate(conn);
+    [[maybe_unused]] uint64_t srtt_us = std::max<int64_t>(reliability->get_srtt().count(), 1);
+    assert(conn->pacing_rate == static_cast<uint64_t>(reliability->get_cwnd()) * 1000000 *
+                                TCPConnectionManager::PACING_SS_RATIO / 100 / srtt_us);
+    conn->cc_pacing_rate = 12345;
+    manager.update_pacing_rate(conn);
+    assert(conn->pacing_rate == 12345);
+    
+    std::cout << "Pacing tests passed!" << std::endl;
+}
+
+void test_transmit_scheduler() {
+    std::cout << "Testing Transmit Scheduler..." << std::endl;
+    
+    // The fake link records one (destination, batch size) per visit
+    std::vector<std::pair<uint32_t, size_t>> batches;
+    TransmitScheduler scheduler([&](const TransmitFlow& flow, std::vector<std::vector<uint8_t>>& packets) {
+        batches.emplace_back(flow.dst_ip, packets.size());
+        return packets.size();
+    });
+    auto flow = [](uint32_t dst_ip, uint8_t priority, uint32_t weight) {
+        auto f = std::make_shared<TransmitFlow>();
+        f->dst_ip = dst_ip;
+        f->priority = priority;
+        f->weight = weight;
+        return f;
+    };
+    auto bulk_a = flow(1, 1, 1);
+    auto bulk_b = flow(2, 1, 2);
+    auto rpc = flow(3, 0, 1);
+    for (int i = 0; i < 20; ++i) {
+        scheduler.enqueue(bulk_a, std::vector<uint8_t>(1000));
+        scheduler.enqueue(bulk_b, std::vector<uint8_t>(1000));
+    }
+    assert(scheduler.backlog() == 40);
+    
+    // DRR: 1500 and 3000 bytes per round give a 1:2 split of 1000-byte packets
+    [[maybe_unused]] size_t transmitted = scheduler.run(27);
+    assert(transmitted == 27);
+    assert(batches[0] == std::make_pair(1u, size_t(1)));
+    assert(batches[1] == std::make_pair(2u, size_t(3)));
+    size_t sent_a = 0, sent_b = 0;
+    for (const auto& batch : batches) {
+        (batch.first == 1 ? sent_a : sent_b) += batch.second;
+    }
+    assert(sent_a == 9 && sent_b == 18);
+    assert(bulk_a->queued_bytes == 11000 && bulk_b->queued_bytes == 2000);
+    
+    // A higher class goes ahead of the bulk backlog
+    scheduler.enqueue(rpc, std::vector<uint8_t>(200));
+    transmitted = scheduler.run(1);
+    assert(transmitted == 1 && batches.back().first == 3 && !rpc->active);
+    transmitted = scheduler.run(100);
+    assert(transmitted == 13 && scheduler.backlog() == 0);
+    assert(!bulk_a->active && !bulk_b->active && scheduler.get_dropped() == 0);
+    
+    // What the link refuses is dropped, not retried
+    TransmitScheduler refusing([](const TransmitFlow&, std::vector<std::vector<uint8_t>>&) {
+        return size_t(0);
+    });
+    refusing.enqueue(bulk_a, std::vector<uint8_t>(100));
+    refusing.enqueue(bulk_a, std::vector<uint8_t>(100));
+    transmitted = refusing.run(10);
+    assert(transmitted == 2 && refusing.get_dropped() == 2 && refusing.backlog() == 0);
+    
+    // The manager queues bursts under the connection's class and drains them
+    TCPConnectionManager manager;
+    IPHeader ip = make_test_ip();
+    TCPConnectionConfig config;
+    config.tx_priority = 2;
+    config.tx_weight = 4;
+    manager.listen(ip.dst_ip, 8080, config);
+    auto conn = establish_connection(manager, ip, 40060);
+    auto reliability = std::make_shared<TCPReliability>();
+    reliability->set_initial_seq(conn->local_seq);
+    reliability->set_mss(conn->effective_mss());
+    conn->reliability = reliability;
+    
+    reliability->buffer_data(std::vector<uint8_t>(3 * conn->effective_mss(), 0x01));
+    [[maybe_unused]] size_t sent = manager.flush_send_queue(conn);
+    assert(sent == 3 * conn->effective_mss());
+    assert(conn->tx_flow && conn->tx_flow->priority == 2 && conn->tx_flow->weight == 4);
+    assert(manager.get_transmit_backlog() == 0);
+    
+    std::cout << "Transmit scheduler tests passed!" << std::endl;
+}
+
+void test_receive_autotuning() {
+    std::cout << "Testing Receive Autotuning..." << std::endl;
+    
+    // Window scale option round trip; a shift above 14 is read as 14
+    TCPOptions syn;
+    syn.mss = 1460;
+    syn.has_window_scale = true;
+    syn.window_scale = 7;
+    auto bytes = syn.serialize();
+    TCPOptions parsed;
+    [[maybe_unused]] bool ok = TCPOptions::parse(bytes.data(), bytes.size(), parsed);
+    assert(ok && parsed.has_window_scale && parsed.window_scale == 7 && parsed.mss == 1460);
+    const uint8_t too_large[] = {TCPOptions::KIND_WINDOW_SCALE, 3, 20, TCPOptions::KIND_NOP};
+    ok = TCPOptions::parse(too_large, sizeof(too_large), parsed);
+    assert(ok && parsed.window_scale == TCPOptions::MAX_WINDOW_SCALE);
+    
+    // Tuner: one window in 10ms sets the RTT; reading faster than the last
+    // round grows the buffer (to the cap here), reading less does not
+    auto t0 = std::chrono::steady_clock::now();
+    auto at = [&](int ms) { return t0 + std::chrono::milliseconds(ms); };
+    ReceiveBufferTuner tuner;
+    tuner.reset(65535, 1000000, 1000, t0);
+    tuner.on_data_received(1000, 65535, t0);
+    tuner.on_data_received(1000 + 65535, 65535, at(10));
+    assert(tuner.get_rtt() == std::chrono::milliseconds(10));
+    [[maybe_unused]] bool grew = tuner.on_data_consumed(50000, at(5));
+    assert(!grew);      // Still inside the first RTT
+    grew = tuner.on_data_consumed(50000, at(20));
+    assert(grew && tuner.get_buffer() == 1000000 && tuner.get_space() == 100000);
+    grew = tuner.on_data_consumed(1000, at(40));
+    assert(!grew);
+    tuner.shrink(20000);
+    assert(tuner.get_buffer() == 20000);
+    grew = tuner.on_data_consumed(500000, at(60), false);
+    assert(!grew && tuner.get_buffer() == 20000);     // Memory pressure: no growth
+    
+    // Window scaling is used only when both ends offer it
+    TCPConnectionManager manager;
+    IPHeader ip = make_test_ip();
+    manager.listen(ip.dst_ip, 8080);
+    [[maybe_unused]] size_t memory_before = manager.get_receive_memory();
+    
+    TCPOptions offer;
+    offer.has_window_scale = true;
+    offer.window_scale = 3;
+    manager.process_incoming_segment(ip, make_segment(ip, 40070, 8080, 1000, 0, TCPHeader::SYN, {}, offer));
+    auto scaled = manager.find_connection(ip.dst_ip, 8080, ip.src_ip, 40070);
+    manager.process_incoming_segment(ip, make_segment(ip, 40070, 8080, 1001, scaled->local_seq, TCPHeader::ACK,
+                                                      {}, TCPOptions(), 1000));
+    assert(scaled->wscale_enabled && scaled->snd_wscale == 3);
+    assert(scaled->rcv_wscale == 7);    // 65535 << 7 covers the 6MB default cap
+    assert(manager.get_receive_memory() == memory_before + ReceiveBufferTuner::INITIAL_BUFFER);
+    
+    auto reliability = std::make_shared<TCPReliability>();
+    reliability->set_initial_seq(scaled->local_seq);
+    scaled->reliability = reliability;
+    manager.process_incoming_segment(ip, make_segment(ip, 40070, 8080, 1001, scaled->local_seq, TCPHeader::ACK,
+                                                      {}, TCPOptions(), 1000));
+    assert(reliability->get_effective_window() == 8000);   // The peer's 1000 << 3
+    
+    auto plain = establish_connection(manager, ip, 40071);
+    assert(!plain->wscale_enabled && plain->rcv_wscale == 0 && plain->snd_wscale == 0);
+    
+    // Unread data takes window; reading it back gives it back
+    size_t received = 0;
+    plain->data_handler = [&](const std::vector<uint8_t>& data) { received += data.size(); };
+    manager.process_incoming_segment(ip, make_segment(ip, 40071, 8080, 1001, plain->local_seq,
+                                                      TCPHeader::ACK, std::vector<uint8_t>(1000, 0x11)));
+    assert(received == 1000 && plain->rcv_queued == 1000);
+    assert(plain->window_size == 65535 - 1000);     // Advertised on the quick ACK
+    manager.on_data_consumed(plain, 1000);
+    assert(plain->rcv_queued == 0);
+    
+    // Under memory pressure the buffer shrinks, but the window's right edge
+    // already offered is not pulled back
+    [[maybe_unused]] uint32_t edge = plain->rcv_wnd_edge;
+    manager.set_receive_memory_limit(1);
+    manager.process_incoming_segment(ip, make_segment(ip, 40071, 8080, 2001, plain->local_seq,
+                                                      TCPHeader::ACK, std::vector<uint8_t>(1000, 0x12)));
+    assert(plain->rcv_tuner.get_buffer() < ReceiveBufferTuner::INITIAL_BUFFER);
+    assert(seq_geq(plain->rcv_wnd_edge, edge));
+    assert(manager.get_receive_memory() < memory_before + 3 * ReceiveBufferTuner::INITIAL_BUFFER);
+    
+    std::cout << "Receive autotuning tests passed!" << std::endl;
+}
+
+void test_ecn() {
+    std::cout << "Testing ECN..." << std::endl;
+    
+    // DCTCP: alpha starts at 1 and decays by g = 1/16 per unmarked window
+    DCTCP dctcp;
+    dctcp.reset(0);
+    dctcp.on_ack(1000, 2000, 1000, true);
+    assert(dctcp.get_alpha() == DCTCP::ALPHA_ONE);
+    dctcp.on_ack(2000, 3000, 1000, true);       // Window not complete yet
+    assert(dctcp.get_alpha() == DCTCP::ALPHA_ONE);
+    dctcp.on_ack(3000, 3000, 1000, false);      // Half the window was marked
+    assert(dctcp.get_alpha() == DCTCP::ALPHA_ONE - 64 + 32);
+    assert(dctcp.reduced_window(10000, 1000) == 10000 - 10000 * 992 / 2048);
+    assert(dctcp.reduced_window(2500, 1000) == 2000);
+    
+    // Classic response: ECE halves the window once per window of data and
+    // the next new data carries CWR
+    TCPReliability rel;
+    rel.set_initial_seq(1000);
+    rel.set_mss(1000);
+    rel.set_ecn_enabled(true);
+    rel.buffer_data(std::vector<uint8_t>(5000, 0xEC));
+    for (int i = 0; i < 5; ++i) {
+        auto sent = rel.get_data_to_send(1000);
+        assert(sent.size() == 1000);
+    }
+    rel.process_ack(2000, 65535, 0, {}, false);
+    [[maybe_unused]] bool cwr = rel.take_cwr();
+    assert(rel.get_ecn_reductions() == 0 && !cwr);
+    rel.process_ack(3000, 65535, 0, {}, true);
+    assert(rel.get_ecn_reductions() == 1);
+    assert(rel.get_ssthresh() == 2000);     // Half of the 3000 still in flight, at least 2 MSS
+    assert(rel.get_cwnd() == rel.get_ssthresh());
+    cwr = rel.take_cwr();
+    assert(cwr);
+    cwr = rel.take_cwr();
+    assert(!cwr);
+    rel.process_ack(4000, 65535, 0, {}, true);  // Same window: no second cut
+    cwr = rel.take_cwr();
+    assert(rel.get_ecn_reductions() == 1 && !cwr);
+    
+    // Negotiation: ECE and CWR on the SYN, and only if the listener wants it
+    TCPConnectionManager manager;
+    IPHeader ip = make_test_ip();
+    TCPConnectionConfig config;
+    config.ecn = true;
+    config.delayed_ack = false;
+    manager.listen(ip.dst_ip, 8080, config);
+    
+    manager.process_incoming_segment(ip, make_segment(ip, 40080, 8080, 1000, 0,
+                                                      TCPHeader::SYN | TCPHeader::ECE));
+    assert(!manager.find_connection(ip.dst_ip, 8080, ip.src_ip, 40080)->ecn_enabled);
+    manager.process_incoming_segment(ip, make_segment(ip, 40081, 8080, 1000, 0,
+                                                      TCPHeader::SYN | TCPHeader::ECE | TCPHeader::CWR));
+    auto conn = manager.find_connection(ip.dst_ip, 8080, ip.src_ip, 40081);
+    assert(conn->ecn_enabled);
+    manager.process_incoming_segment(ip, make_segment(ip, 40081, 8080, 1001, conn->local_seq,
+                                                      TCPHeader::ACK));
+    assert(conn->state_machine.is_established());
+    
+    // A CE mark is echoed until the sender answers with CWR
+    IPHeader marked = ip;
+    marked.set_ecn(ECN_CE);
+    assert(marked.get_ecn() == ECN_CE);
+    manager.process_incoming_segment(ip, make_segment(ip, 40081, 8080, 1001, conn->local_seq,
+                                                      TCPHeader::ACK, std::vector<uint8_t>(100, 1)));
+    assert(!conn->ece_pending);
+    manager.process_incoming_segment(marked, make_segment(marked, 40081, 8080, 1101, conn->local_seq,
+                                                          TCPHeader::ACK, std::vector<uint8_t>(100, 2)));
+    assert(conn->ece_pending && conn->local_ack == 1201);
+    manager.process_incoming_segment(ip, make_segment(ip, 40081, 8080, 1201, conn->local_seq,
+                                                      TCPHeader::ACK, std::vector<uint8_t>(100, 3)));
+    assert(conn->ece_pending);
+    manager.process_incoming_segment(ip, make_segment(ip, 40081, 8080, 1301, conn->local_seq,
+                                                      TCPHeader::ACK | TCPHeader::CWR,
+                                                      std::vector<uint8_t>(100, 4)));
+    assert(!conn->ece_pending && conn->local_ack == 1401);
+    
+    // DCTCP receivers echo the CE state of each segment instead
+    auto reliability = std::make_shared<TCPReliability>();
+    reliability->set_initial_seq(conn->local_seq);
+    reliability->set_congestion_control(CongestionControl::DCTCP);
+    conn->reliability = reliability;
+    manager.process_incoming_segment(marked, make_segment(marked, 40081, 8080, 1401, conn->local_seq,
+                                                          TCPHeader::ACK, std::vector<uint8_t>(100, 5)));
+    assert(conn->ece_pending);
+    manager.process_incoming_segment(ip, make_segment(ip, 40081, 8080, 1501, conn->local_seq,
+                                                      TCPHeader::ACK, std::vector<uint8_t>(100, 6)));
+    assert(!conn->ece_pending && conn->local_ack == 1601);
+    
+    // Without ECN on the connection a CE mark is ignored
+    auto plain = establish_connection(manager, ip, 40082);
+    assert(!plain->ecn_enabled);
+    manager.process_incoming_segment(marked, make_segment(marked, 40082, 8080, 1001, plain->local_seq,
+                                                          TCPHeader::ACK, std::vector<uint8_t>(100, 7)));
+    assert(!plain->ece_pending);
+    
+    std::cout << "ECN tests passed!" << std::endl;
+}
+
+void test_fast_open() {
+    std::cout << "Testing TCP Fast Open..." << std::endl;
+    
+    // SipHash-2-4 reference vectors: key 00..0f, messages 00..(n-1)
+    SipHashKey key;
+    key.k0 = 0x0706050403020100ULL;
+    key.k1 = 0x0f0e0d0c0b0a0908ULL;
+    uint8_t message[15];
+    for (uint8_t i = 0; i < sizeof(message); ++i) {
+        message[i] = i;
+    }
+    assert(siphash24(key, message, 0) == 0x726fdb47dd0e0e31ULL);
+    assert(siphash24(key, message, 15) == 0xa129ca6149be45e5ULL);
+    
+    // Option: an empty cookie is a request; cookies are 4-16 bytes, even
+    TCPOptions syn;
+    syn.mss = 1460;
+    syn.has_fastopen = true;
+    auto bytes = syn.serialize();
+    TCPOptions parsed;
+    [[maybe_unused]] bool ok = TCPOptions::parse(bytes.data(), bytes.size(), parsed);
+    assert(ok && parsed.has_fastopen && parsed.fastopen_cookie.empty());
+    syn.fastopen_cookie = {1, 2, 3, 4, 5, 6, 7, 8};
+    bytes = syn.serialize();
+    assert(bytes.size() % 4 == 0);
+    ok = TCPOptions::parse(bytes.data(), bytes.size(), parsed);
+    assert(ok && parsed.fastopen_cookie == syn.fastopen_cookie && parsed.mss == 1460);
+    const uint8_t odd_cookie[] = {TCPOptions::KIND_FASTOPEN, 5, 1, 2, 3, TCPOptions::KIND_NOP,
+                                  TCPOptions::KIND_NOP, TCPOptions::KIND_NOP};
+    ok = TCPOptions::parse(odd_cookie, sizeof(odd_cookie), parsed);
+    assert(!ok);
+    
+    // Cookies are bound to the client address and survive one key rotation
+    uint32_t client = NetworkUtils::ip_string_to_network("10.0.0.2");
+    uint32_t other = NetworkUtils::ip_string_to_network("10.0.0.3");
+    FastOpenCookieGenerator generator;
+    auto cookie = generator.generate(client);
+    assert(cookie.size() == FastOpenCookieGenerator::COOKIE_LENGTH);
+    assert(generator.validate(client, cookie) && !generator.validate(other, cookie));
+    generator.rotate_key();
+    assert(generator.validate(client, cookie) && generator.generate(client) != cookie);
+    generator.rotate_key();
+    assert(!generator.validate(client, cookie));
+    
+    // Client cache evicts the least recently used server
+    FastOpenCookieCache cache(2);
+    FastOpenCookieCache::Entry entry;
+    cache.store(1, {1, 1, 1, 1}, 1460);
+    cache.store(2, {2, 2, 2, 2}, 1400);
+    [[maybe_unused]] bool found = cache.lookup(1, entry);
+    assert(found && entry.mss == 1460);
+    cache.store(3, {3, 3, 3, 3}, 536);
+    assert(cache.size() == 2);
+    found = cache.lookup(2, entry);
+    assert(!found);
+    found = cache.lookup(1, entry);
+    assert(found);
+    cache.remove(1);
+    found = cache.lookup(1, entry);
+    assert(!found);
+    found = cache.lookup(3, entry);
+    assert(found && entry.cookie[0] == 3);
+    
+    // Listener: a request gets a cookie; the cookie lets the next SYN's
+    // data straight through to accept()
+    TCPConnectionManager manager;
+    IPHeader ip = make_test_ip();
+    TCPConnectionConfig config;
+    config.fastopen = true;
+    config.fastopen_max_pending = 1;
+    manager.listen(ip.dst_ip, 8080, config);
+    
+    TCPOptions request;
+    request.has_fastopen = true;
+    manager.process_incoming_segment(ip, make_segment(ip, 40090, 8080, 1000, 0, TCPHeader::SYN, {}, request));
+    auto first = manager.find_connection(ip.dst_ip, 8080, ip.src_ip, 40090);
+    assert(first->fastopen_cookie.size() == FastOpenCookieGenerator::COOKIE_LENGTH);
+    assert(!first->fastopen_accepted && first->local_ack == 1001);
+    
+    TCPOptions with_cookie;
+    with_cookie.has_fastopen = true;
+    with_cookie.fastopen_cookie = first->fastopen_cookie;
+    std::vector<uint8_t> rpc = {'G', 'E', 'T', ' ', '/'};
+    manager.process_incoming_segment(ip, make_segment(ip, 40091, 8080, 5000, 0, TCPHeader::SYN, rpc, with_cookie));
+    auto fast = manager.find_connection(ip.dst_ip, 8080, ip.src_ip, 40091);
+    assert(fast->fastopen_accepted && fast->local_ack == 5001 + rpc.size());
+    assert(fast->fastopen_cookie.empty());     // Valid cookie: nothing new to issue
+    assert(fast->pending_data == rpc);
+    auto accepted = manager.accept_connection();
+    assert(accepted == fast);
+    accepted = manager.accept_connection();
+    assert(accepted == nullptr);
+    auto listener = manager.find_listener(ip.dst_ip, 8080);
+    assert(listener->fastopen_pending == 1);
+    
+    // Past the pending limit, or with a bad cookie, only the SYN is taken
+    manager.process_incoming_segment(ip, make_segment(ip, 40092, 8080, 7000, 0, TCPHeader::SYN, rpc, with_cookie));
+    auto limited = manager.find_connection(ip.dst_ip, 8080, ip.src_ip, 40092);
+    assert(!limited->fastopen_accepted && limited->local_ack == 7001 && limited->pending_data.empty());
+    TCPOptions forged = with_cookie;
+    forged.fastopen_cookie[0] ^= 0xFF;
+    IPHeader elsewhere = ip;
+    elsewhere.src_ip = other;
+    manager.process_incoming_segment(elsewhere, make_segment(elsewhere, 40093, 8080, 9000, 0, TCPHeader::SYN, rpc, forged));
+    auto rejected = manager.find_connection(ip.dst_ip, 8080, other, 40093);
+    assert(!rejected->fastopen_accepted && rejected->local_ack == 9001);
+    assert(rejected->fastopen_cookie.size() == FastOpenCookieGenerator::COOKIE_LENGTH);
+    
+    // The handshake completes as usual; the data is already in sequence
+    manager.process_incoming_segment(ip, make_segment(ip, 40091, 8080, 5001 + rpc.size(), fast->local_seq,
+                                                      TCPHeader::ACK));
+    assert(fast->state_machine.is_established());
+    assert(listener->fastopen_pending == 0);
+    
+    // That freed the slot for the next cookie holder
+    manager.process_incoming_segment(ip, make_segment(ip, 40094, 8080, 11000, 0, TCPHeader::SYN, rpc, with_cookie));
+    auto next = manager.find_connection(ip.dst_ip, 8080, ip.src_ip, 40094);
+    assert(next->fastopen_accepted && listener->fastopen_pending == 1);
+    assert(manager.has_pending_accept(listener));
+    
+    // Reset before accept(): it leaves the accept queue as well
+    manager.process_incoming_segment(ip, make_segment(ip, 40094, 8080, 11001 + rpc.size(), 0, TCPHeader::RST));
+    assert(listener->fastopen_pending == 0);
+    assert(!manager.has_pending_accept(listener) && listener->accept_queue.empty());
+    accepted = manager.accept_connection(listener);
+    assert(accepted == nullptr);
+    
+    std::cout << "TCP Fast Open tests passed!" << std::endl;
+}
+
+void test_receive_ring() {
+    std::cout << "Testing SPSC Receive Ring..." << std::endl;
+    
+    // Capacity rounds up to a power of two; writes stop when full and
+    // reads wrap around the end of the buffer
+    SPSCByteRing ring(100);
+    assert(ring.capacity() == 128 && ring.empty());
+    std::vector<uint8_t> in(200);
+    for (size_t i = 0; i < in.size(); ++i) {
+        in[i] = static_cast<uint8_t>(i);
+    }
+    [[maybe_unused]] size_t moved = ring.write(in.data(), 100);
+    assert(moved == 100);
+    moved = ring.write(in.data() + 100, 100);
+    assert(moved == 28 && ring.free_space() == 0);
+    std::vector<uint8_t> out(200);
+    moved = ring.read(out.data(), 90);
+    assert(moved == 90);
+    moved = ring.write(in.data() + 128, 72);
+    assert(moved == 72);    // Wraps
+    moved = ring.read(out.data() + 90, 200);
+    assert(moved == 110 && ring.empty());
+    assert(std::equal(out.begin(), out.end(), in.begin()));
+    moved = ring.read(out.data(), 1);
+    assert(moved == 0);
+    
+    // Notifier: a wait times out, a notification is consumed once
+    EventNotifier notifier;
+    assert(notifier.is_valid());
+    [[maybe_unused]] bool woken = notifier.wait(std::chrono::milliseconds(1));
+    assert(!woken);
+    notifier.notify();
+    notifier.notify();
+    woken = notifier.wait(std::chrono::milliseconds(0));
+    assert(woken);
+    woken = notifier.consume();
+    assert(!woken);
+    
+    // One producer and one consumer thread moving a counting pattern
+    // through a small ring, in odd-sized pieces
+    SPSCByteRing shared(256);
+    const size_t total = 1 << 20;
+    std::thread producer([&] {
+        uint8_t chunk[97];
+        size_t sent = 0;
+        while (sent < total) {
+            size_t length = std::min(sizeof(chunk), total - sent);
+            for (size_t i = 0; i < length; ++i) {
+                chunk[i] = static_cast<uint8_t>((sent + i) * 7);
+            }
+            size_t offset = 0;
+            while (offset < length) {
+                size_t written = shared.write(chunk + offset, length - offset);
+                if (written == 0) {
+                    std::this_thread::yield();
+                }
+                offset += written;
+            }
+            sent += length;
+        }
+    });
+    size_t received = 0;
+    bool in_order = true;
+    uint8_t chunk[61];
+    while (received < total) {
+        size_t length = shared.read(chunk, sizeof(chunk));
+        if (length == 0) {
+            std::this_thread::yield();
+        }
+        for (size_t i = 0; i < length; ++i) {
+            in_order = in_order && chunk[i] == static_cast<uint8_t>((received + i) * 7);
+        }
+        received += length;
+    }
+    producer.join();
+    assert(in_order && shared.empty());
+    
+    std::cout << "SPSC receive ring tests passed!" << std::endl;
+}
+
+void test_event_poller() {
+    std::cout << "Testing Event Poller..." << std::endl;
+    
+    EventPoller poller;
+    assert(poller.get_fd() >= 0 && poller.size() == 0);
+    PollEvent events[4];
+    
+    // Nothing ready: a zero timeout returns at once, a timeout expires
+    TCPSocket idle;
+    assert(idle.poll_events() == 0);
+    [[maybe_unused]] bool ok = poller.add(idle, EventPoller::READABLE | EventPoller::WRITABLE, 7);
+    assert(ok);
+    ok = poller.add(idle, EventPoller::READABLE);
+    assert(!ok);
+    [[maybe_unused]] int ready = poller.wait(events, 4, std::chrono::milliseconds(0));
+    assert(ready == 0);
+    [[maybe_unused]] auto start = std::chrono::steady_clock::now();
+    ready = poller.wait(events, 4, std::chrono::milliseconds(20));
+    assert(ready == 0);
+    assert(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20));
+    ok = poller.modify(idle, EventPoller::READABLE | EventPoller::EDGE_TRIGGERED, 8);
+    assert(ok);
+    
+    // A listener with nothing to accept is not ready
+    TCPSocket listener;
+    ok = listener.bind("127.0.0.1", 8095) && listener.listen();
+    assert(ok);
+    assert(listener.poll_events() == 0);
+    ok = poller.add(listener, EventPoller::ACCEPT, 9);
+    assert(ok && poller.size() == 2);
+    ready = poller.wait(events, 4, std::chrono::milliseconds(0));
+    assert(ready == 0);
+    
+    // The poller nests in an application's epoll through its eventfd,
+    // which stays quiet while nothing is ready
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    assert(epfd >= 0);
+    struct epoll_event watch = {};
+    watch.events = EPOLLIN;
+    [[maybe_unused]] int result = epoll_ctl(epfd, EPOLL_CTL_ADD, poller.get_fd(), &watch);
+    assert(result == 0);
+    struct epoll_event fired;
+    result = epoll_wait(epfd, &fired, 1, 0);
+    assert(result == 0);
+    ::close(epfd);
+    
+    // Sockets leave the poller when removed or destroyed
+    ok = poller.remove(listener);
+    assert(ok);
+    ok = poller.remove(listener);
+    assert(!ok);
+    {
+        TCPSocket scoped;
+        ok = poller.add(scoped, EventPoller::READABLE);
+        assert(ok && poller.size() == 2);
+    }
+    assert(poller.size() == 1);
+    listener.close();
+    
+    // A moved listener keeps its registrations and its accept events
+    TCPSocket original;
+    ok = original.bind("127.0.0.1", 8096) && original.listen();
+    assert(ok);
+    ok = poller.add(original, EventPoller::ACCEPT, 10);
+    assert(ok);
+    TCPSocket moved(std::move(original));
+    ok = poller.add(moved, EventPoller::ACCEPT);
+    assert(!ok);
+    ok = poller.modify(moved, EventPoller::ACCEPT, 11);
+    assert(ok);
+    IPHeader ip;
+    std::memset(&ip, 0, sizeof(ip));
+    ip.src_ip = NetworkUtils::ip_string_to_network("127.0.0.2");
+    ip.dst_ip = NetworkUtils::ip_string_to_network("127.0.0.1");
+    auto manager = Stack::default_stack().get_connection_manager();
+    manager->process_incoming_segment(ip, make_segment(ip, 40100, 8096, 1000, 0, TCPHeader::SYN));
+    auto conn = manager->find_connection(ip.dst_ip, 8096, ip.src_ip, 40100);
+    assert(conn);
+    manager->process_incoming_segment(ip, make_segment(ip, 40100, 8096, 1001, conn->local_seq,
+                                                       TCPHeader::ACK));
+    ready = poller.wait(events, 4, std::chrono::milliseconds(100));
+    assert(ready == 1 && events[0].data == 11 && events[0].events == EventPoller::ACCEPT);
+    auto accepted = moved.accept();
+    assert(accepted != nullptr);
+    ok = poller.remove(moved);
+    assert(ok && poller.size() == 1);
+    
+    std::cout << "Event poller tests passed!" << std::endl;
+}
+
+void test_busy_poll() {
+    std::cout << "Testing Busy-Poll Engine..." << std::endl;
+    
+    // Work for the first passes, then none: the engine spins through its
+    // budget, then blocks, halving the spin window down to 1/16
+    std::atomic<int> work_left(1000);
+    std::atomic<int> blocked(0);
+    std::vector<std::chrono::microseconds> windows;     // Spin window at each block
+    BusyPollEngine* self = nullptr;
+    BusyPollEngine engine(
+        [&] {
+            if (work_left.load() > 0) {
+                work_left--;
+                return true;
+            }
+            return false;
+        },
+        [&](std::chrono::microseconds timeout) {
+            windows.push_back(self->get_stats().spin_window);
+            blocked++;
+            std::this_thread::sleep_for(timeout);
+        });
+    self = &engine;
+    BusyPollConfig config;
+    config.spin_budget = std::chrono::microseconds(200);
+    config.max_block = std::chrono::microseconds(500);
+    [[maybe_unused]] bool started = engine.start(config);
+    assert(started && engine.is_running());
+    started = engine.start(config);
+    assert(!started);
+    while (blocked.load() < 6) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    BusyPollStats stats = engine.get_stats();
+    assert(stats.polls > 1000 && stats.empty_polls > 0 && stats.blocks >= 6);
+    assert(stats.spin_window == std::chrono::microseconds(12));
+    
+    // Traffic again restores the full budget for the next idle spell
+    int before = blocked.load();
+    work_left = 10;
+    while (work_left.load() > 0 || blocked.load() < before + 3) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    engine.stop();
+    assert(!engine.is_running());
+    stats = engine.get_stats();
+    assert(stats.polls - stats.empty_polls == 1010);
+    assert(std::find(windows.begin() + before, windows.end(), config.spin_budget) != windows.end());
+    
+    // The manager's engine takes over polling; with no link it finds
+    // nothing and blocks
+    TCPConnectionManager manager;
+    assert(!manager.is_busy_polling());
+    config.spin_budget = std::chrono::microseconds(50);
+    config.max_block = std::chrono::microseconds(200);
+    config.cpu = 0;
+    started = manager.start_busy_poll(config);
+    assert(started && manager.is_busy_polling());
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    manager.stop_busy_poll();
+    assert(!manager.is_busy_polling());
+    stats = manager.get_busy_poll_stats();
+    assert(stats.blocks > 0 && stats.polls > 0 && stats.empty_polls == stats.polls);
+    
+    std::cout << "Busy-poll engine test passed!" << std::endl;
+}
+
+void test_concurrent_manager() {
+    std::cout << "Testing Concurrent Connection Manager..." << std::endl;
+    
+    // A node retired while a reader is pinned outlives the reader
+    std::atomic<bool> pinned(false), release(false), freed(false);
+    std::thread reader([&] {
+        EpochGuard guard;
+        pinned = true;
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+    });
+    while (!pinned.load()) {
+        std::this_thread::yield();
+    }
+    EpochReclaimer& reclaimer = EpochReclaimer::instance();
+    reclaimer.retire([&] { freed = true; });
+    for (int i = 0; i < 5; ++i) {
+        reclaimer.reclaim();
+    }
+    assert(!freed.load());
+    release = true;
+    reader.join();
+    for (int i = 0; i < 3 && !freed.load(); ++i) {
+        reclaimer.reclaim();
+    }
+    assert(freed.load());
+    
+    // Writers open, feed and reset connections on their own port ranges
+    // while readers look them up and accept them
+    TCPConnectionManager manager;
+    IPHeader ip = make_test_ip();
+    [[maybe_unused]] bool listening = manager.listen(ip.dst_ip, 8080, TCPConnectionConfig());
+    assert(listening);
+    listening = manager.listen(ip.dst_ip, 8080, TCPConnectionConfig());
+    assert(!listening);
+    auto listener = manager.find_listener(ip.dst_ip, 8080);
+    
+    const int writers = 4, readers = 2, per_writer = 100;
+    std::atomic<int> writers_done(0);
+    std::vector<std::thread> threads;
+    for (int w = 0; w < writers; ++w) {
+        threads.emplace_back([&, w] {
+            std::vector<uint8_t> payload(100, 0x5a);
+            for (int i = 0; i < per_writer; ++i) {
+                uint16_t port = static_cast<uint16_t>(20000 + w * 1000 + i);
+                manager.process_incoming_segment(ip, make_segment(ip, port, 8080, 1000, 0,
+                                                                  TCPHeader::SYN));
+                auto conn = manager.find_connection(ip.dst_ip, 8080, ip.src_ip, port);
+                assert(conn);
+                uint32_t isn;
+                {
+                    std::lock_guard<std::recursive_mutex> lock(conn->mutex);
+                    isn = conn->local_seq - 1;
+                }
+                
+                // A retransmitted SYN finds the connection already there and
+                // gets the same SYN-ACK; the peer still ACKs ISN + 1
+                manager.process_incoming_segment(ip, make_segment(ip, port, 8080, 1000, 0,
+                                                                  TCPHeader::SYN));
+                uint32_t ack = isn + 1;
+                manager.process_incoming_segment(ip, make_segment(ip, port, 8080, 1001, ack,
+                                                                  TCPHeader::ACK));
+                {
+                    std::lock_guard<std::recursive_mutex> lock(conn->mutex);
+                    assert(conn->state_machine.is_established());
+                    assert(conn->local_seq == ack);     // First data byte goes out at ISN + 1
+                    manager.send_segment(conn, {0x01}, TCPHeader::PSH | TCPHeader::ACK);
+                    assert(conn->local_seq == ack + 1);
+                }
+                ack += 1;
+                manager.process_incoming_segment(ip, make_segment(ip, port, 8080, 1001, ack,
+                                                                  TCPHeader::ACK, payload));
+                if (i % 2 == 1) {
+                    manager.process_incoming_segment(ip, make_segment(ip, port, 8080, 1101, ack,
+                                                                      TCPHeader::RST));
+                    assert(!manager.find_connection(ip.dst_ip, 8080, ip.src_ip, port));
+                }
+            }
+            writers_done++;
+        });
+    }
+    
+    std::vector<std::vector<std::shared_ptr<TCPConnection>>> accepted(readers + 1);
+    for (int r = 0; r < readers; ++r) {
+        threads.emplace_back([&, r] {
+            uint16_t port = 20000;
+            while (writers_done.load() < writers) {
+                manager.find_connection(ip.dst_ip, 8080, ip.src_ip, port);
+                port = port == 23099 ? 20000 : port + 1;
+                manager.has_pending_accept(listener);
+                if (auto conn = manager.accept_connection(listener)) {
+                    accepted[r].push_back(conn);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    // Half were reset; the rest are each handed out exactly once
+    assert(manager.get_connection_count() == static_cast<size_t>(writers * per_writer / 2));
+    while (auto conn = manager.accept_connection(listener)) {
+        accepted[readers].push_back(conn);
+    }
+    assert(!manager.has_pending_accept(listener));
+    std::set<TCPConnection*> unique;
+    for (const auto& list : accepted) {
+        for (const auto& conn : list) {
+            [[maybe_unused]] bool first_time = unique.insert(conn.get()).second;
+            assert(first_time);
+        }
+    }
+    for (int w = 0; w < writers; ++w) {
+        for (int i = 0; i < per_writer; i += 2) {
+            auto conn = manager.find_connection(ip.dst_ip, 8080, ip.src_ip,
+                                                static_cast<uint16_t>(20000 + w * 1000 + i));
+            assert(conn && conn->accepted.load() && unique.count(conn.get()) == 1);
+            assert(conn->pending_data.size() == 100);
+        }
+    }
+    
+    std::cout << "Concurrent connection manager test passed!" << std::endl;
+}
+
+void test_independent_stacks() {
+    std::cout << "Testing Independent Stacks..." << std::endl;
+    
+    assert(&Stack::default_stack() == &Stack::default_stack());
+    
+    // Two stacks listen on the same address, each with its own table
+    Stack first, second;
+    auto first_manager = first.get_connection_manager();
+    auto second_manager = second.get_connection_manager();
+    assert(first_manager != second_manager);
+    
+    TCPSocket first_listener(first), second_listener(second);
+    [[maybe_unused]] bool listening = first_listener.bind("10.0.0.1", 9090) && first_listener.listen();
+    assert(listening);
+    listening = second_listener.bind("10.0.0.1", 9090) && second_listener.listen();
+    assert(listening);
+    
+    IPHeader ip = make_test_ip();
+    first_manager->process_incoming_segment(ip, make_segment(ip, 41000, 9090, 1000, 0,
+                                                             TCPHeader::SYN));
+    assert(first_manager->find_connection(ip.dst_ip, 9090, ip.src_ip, 41000));
+    assert(!second_manager->find_connection(ip.dst_ip, 9090, ip.src_ip, 41000));
+    assert(second_manager->get_connection_count() == 0);
+    
+    // Busy polling is per stack
+    BusyPollConfig config;
+    config.max_block = std::chrono::microseconds(200);
+    [[maybe_unused]] bool polling = first.enable_busy_poll(config);
+    assert(polling && first.is_busy_polling() && !second.is_busy_polling());
+    assert(!Stack::default_stack().is_busy_polling());
+    first.disable_busy_poll();
+    assert(!first.is_busy_polling());
+    
+    first_listener.close();
+    second_listener.close();
+    
+    std::cout << "Independent stacks test passed!" << std::endl;
+}
+
+void test_stack_placement() {
+    std::cout << "Testing Stack CPU and NUMA Placement..." << std::endl;
+    
+    // sysfs lists and topology lookups
+    std::vector<int> cpus = NumaUtils::node_cpus(0);
+    if (NumaUtils::node_count() > 0) {
+        assert(!cpus.empty() && NumaUtils::cpu_node(cpus.front()) == 0);
+    }
+    assert(NumaUtils::node_cpus(-1).empty() && NumaUtils::cpu_node(-1) == -1);
+    int cpu = -1, node = -1;
+    [[maybe_unused]] bool located = NumaUtils::current_location(cpu, node);
+    assert(located && cpu >= 0 && node >= 0);
+    
+    // Node memory is zeroed and page-rounded whether or not the host can
+    // bind it
+    NodeMemory memory(1000, 0, false);
+    assert(memory.size() >= 1000 && !memory.is_huge());
+    assert(static_cast<const uint8_t*>(memory.data())[999] == 0);
+    
+    // An unplaced stack reports nothing and pins nothing
+    Stack plain;
+    StackStats stats = plain.get_stats();
+    assert(stats.placement.numa_node == -1 && stats.placement.cpus.empty());
+    assert(stats.placement.pool_buffers == 0 && !stats.placement.table_on_node);
+    
+    // A stack on the current CPU: its table and pool come from that CPU's
+    // node and its threads run there. Building it leaves the caller's own
+    // memory policy as it was.
+    NumaUtils::prefer_node(node);
+    NumaUtils::MemoryPolicy before, after;
+    [[maybe_unused]] bool saved = NumaUtils::save_policy(before);
+    PlacementConfig placement;
+    placement.numa_node = node;
+    placement.cpus = {cpu};
+    Stack placed(placement);
+    saved = saved && NumaUtils::save_policy(after);
+    assert(!saved || (before.mode == after.mode &&
+                      std::memcmp(before.nodes, after.nodes, sizeof(before.nodes)) == 0));
+    NumaUtils::prefer_node(-1);
+    stats = placed.get_stats();
+    assert(stats.placement.numa_node == node && stats.placement.cpus == std::vector<int>{cpu});
+    assert(stats.placement.pool_buffers == PacketBufferPool::DEFAULT_MAX_CACHED);
+    
+    TCPSocket listener(placed);
+    [[maybe_unused]] bool listening = listener.bind("10.0.0.1", 9191) && listener.listen();
+    assert(listening);
+    BusyPollConfig config;
+    config.max_block = std::chrono::microseconds(200);
+    [[maybe_unused]] bool polling = placed.enable_busy_poll(config);
+    assert(polling);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    stats = placed.get_stats();
+    placed.disable_busy_poll();
+    listener.close();
+    assert(stats.busy_poll.cpu == cpu && stats.busy_poll.numa_node == node);
+    assert(stats.placement.threads_placed + stats.placement.placement_failures >= 1);
+    
+    std::cout << "Table on node: " << (stats.placement.table_on_node ? "yes" : "no")
+              << ", threads placed: " << stats.placement.threads_placed << std::endl;
+    std::cout << "Stack placement test passed!" << std::endl;
+}
+
+void test_logger() {
+    std::cout << "Testing Asynchronous Logger..." << std::endl;
+    
+    Logger& logger = Logger::instance();
+    std::mutex captured_mutex;
+    std::string captured;
+    logger.flush();
+    logger.set_sink([&](std::string_view text) {
+        std::lock_guard<std::mutex> lock(captured_mutex);
+        captured.append(text);
+    });
+    auto take = [&]() {
+        logger.flush();
+        std::lock_guard<std::mutex> lock(captured_mutex);
+        return std::exchange(captured, std::string());
+    };
+    
+    // Fields keep their types; strings are copied and quoted
+    assert(Logger::get_level() == LogLevel::LEVEL_WARN);
+    std::string ip = "10.0.0.1";
+    TCP_LOG_WARN("Bind failed", "ip", ip, "port", uint16_t(80), "delta", -3, "ok", true,
+                 "ratio", 0.5, "error", "Address \"in\" use");
+    std::string line = take();
+    assert(line.find(" WARN  [") != std::string::npos);
+    assert(line.find("] Bind failed ip=\"10.0.0.1\" port=80 delta=-3 ok=true ratio=0.5 "
+                     "error=\"Address \\\"in\\\" use\"\n") != std::string::npos);
+    
+    // Below the runtime level nothing is evaluated, let alone written
+    int evaluated = 0;
+    auto count = [&evaluated]() { return ++evaluated; };
+    TCP_LOG_INFO("Hidden", "n", count());
+    line = take();
+    assert(evaluated == 0 && line.empty());
+    Logger::set_level(LogLevel::LEVEL_INFO);
+    TCP_LOG_INFO("Shown", "n", count());
+    line = take();
+    assert(evaluated == 1 && line.find("INFO  [") != std::string::npos);
+    
+    // Below the compiled-in level not even the runtime check is left
+    Logger::set_level(LogLevel::LEVEL_TRACE);
+    TCP_LOG_TRACE("Compiled out", "n", count());
+    assert(evaluated == (TCP_STACK_LOG_LEVEL > 0 ? 1 : 2));
+    take();
+    
+    // The library's own messages go through it too
+    TCPStateMachine::set_transition_hook(TCPStateMachine::log_transition);
+    TCPStateMachine sm;
+    sm.process_event(TCPEvent::ACTIVE_OPEN);
+    TCPStateMachine::set_transition_hook(nullptr);
+    line = take();
+    assert(TCP_STACK_LOG_LEVEL > 1 || line.find("from=\"CLOSED\" to=\"SYN_SENT\"") != std::string::npos);
+    
+    // Every thread has its own ring; all records come out once, or are
+    // counted as dropped if a ring filled up before the drain
+    LoggerStats before = logger.get_stats();
+    const int threads = 4;
+    const int per_thread = 500;
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threads; ++t) {
+        writers.emplace_back([t]() {
+            for (int i = 0; i < per_thread; ++i) {
+                TCP_LOG_WARN("Record", "thread", t, "i", i);
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    std::string text = take();
+    LoggerStats after = logger.get_stats();
+    uint64_t written = 0;
+    for (size_t at = text.find("] Record thread="); at != std::string::npos;
+         at = text.find("] Record thread=", at + 1)) {
+        ++written;
+    }
+    uint64_t dropped = after.records_dropped - before.records_dropped;
+    assert(written + dropped == static_cast<uint64_t>(threads * per_thread));
+    assert(after.records_written - before.records_written >= written);
+    assert(text.find("Record thread=3 i=499") != std::string::npos || dropped > 0);
+    
+    logger.set_sink(nullptr);
+    Logger::set_level(LogLevel::LEVEL_WARN);
+    
+    std::cout << "Records written: " << written << ", dropped: " << dropped << std::endl;
+    std::cout << "Logger test passed!" << std::endl;
+}
+
 void test_socket_creation() {
     std::cout << "Testing Socket Creation..." << std::endl;
     
@@ -67,6 +1887,28 @@ int main() {
     try {
         test_state_machine();
         test_network_utils();
+        test_rtt_estimator();
+        test_fast_retransmit();
+        test_sack();
+        test_rack_tlp();
+        test_delayed_ack();
+        test_mss_and_path_mtu();
+        test_nagle_and_cork();
+        test_segmentation_offload();
+        test_receive_coalescing();
+        test_header_prediction();
+        test_pacing();
+        test_transmit_scheduler();
+        test_receive_autotuning();
+        test_ecn();
+        test_fast_open();
+        test_receive_ring();
+        test_event_poller();
+        test_busy_poll();
+        test_concurrent_manager();
+        test_independent_stacks();
+        test_stack_placement();
+        test_logger();
         test_socket_creation();
         
         std::cout << "===========================================" << std::endl;